@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 8
+
+struct ArenaChunk {
+    ArenaChunk* next;
+    size_t size;
+    size_t used;
+    // Dados logo após o cabeçalho; o tamanho do cabeçalho é múltiplo de 8.
+};
+
+static char* chunk_data(ArenaChunk* c) {
+    return (char*)c + sizeof(ArenaChunk);
+}
+
+void arena_init(Arena* a, const char* name, size_t chunk_size) {
+    memset(a, 0, sizeof(Arena));
+    a->name = name;
+    a->chunk_size = chunk_size;
+}
+
+static ArenaChunk* new_chunk(Arena* a, size_t size) {
+    ArenaChunk* c = malloc(sizeof(ArenaChunk) + size);
+    if (!c) {
+        perror("Failed to allocate Arena chunk");
+        exit(EXIT_FAILURE);
+    }
+    c->size = size;
+    c->used = 0;
+    a->reserved += size;
+    return c;
+}
+
+void* arena_alloc(Arena* a, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaChunk* c = a->chunks;
+    if (!c || c->size - c->used < size) {
+        if (size > a->chunk_size / 4) {
+            // Alocações grandes ganham um bloco próprio, encaixado depois do
+            // atual para não desperdiçar o espaço que sobra nele.
+            ArenaChunk* big = new_chunk(a, size);
+            big->used = size;
+            if (c) {
+                big->next = c->next;
+                c->next = big;
+            } else {
+                big->next = NULL;
+                a->chunks = big;
+            }
+            a->used += size;
+            a->allocations++;
+            return chunk_data(big);
+        }
+        c = new_chunk(a, a->chunk_size);
+        c->next = a->chunks;
+        a->chunks = c;
+    }
+    void* p = chunk_data(c) + c->used;
+    c->used += size;
+    a->used += size;
+    a->allocations++;
+    return p;
+}
+
+char* arena_strndup(Arena* a, const char* s, size_t n) {
+    char* dst = arena_alloc(a, n + 1);
+    memcpy(dst, s, n);
+    dst[n] = '\0';
+    return dst;
+}
+
+char* arena_strdup(Arena* a, const char* s) {
+    return arena_strndup(a, s, strlen(s));
+}
+
+void arena_reset(Arena* a) {
+    if (a->used > a->peak) a->peak = a->used;
+    ArenaChunk* keep = NULL;
+    ArenaChunk* c = a->chunks;
+    while (c) {
+        ArenaChunk* next = c->next;
+        if (!keep && c->size == a->chunk_size) {
+            keep = c;
+        } else {
+            a->reserved -= c->size;
+            free(c);
+        }
+        c = next;
+    }
+    if (keep) {
+        keep->used = 0;
+        keep->next = NULL;
+    }
+    a->chunks = keep;
+    a->used = 0;
+}
+
+void arena_release(Arena* a) {
+    if (a->used > a->peak) a->peak = a->used;
+    ArenaChunk* c = a->chunks;
+    while (c) {
+        ArenaChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    a->chunks = NULL;
+    a->used = 0;
+    a->reserved = 0;
+}
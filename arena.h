@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Alocador por incremento (bump) em blocos grandes. Nada é liberado
+// individualmente: arena_reset devolve tudo de uma vez mantendo o primeiro
+// bloco para reuso, e arena_release devolve a memória ao sistema.
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    const char* name;
+    ArenaChunk* chunks;
+    size_t chunk_size;
+    size_t used;        // bytes entregues
+    size_t reserved;    // bytes em blocos obtidos do sistema
+    size_t peak;        // maior valor de used; resets não o zeram
+    long allocations;   // acumulado, inclusive entre resets
+    long nodes;         // nós da AST alocados aqui (contados por ast_new_node)
+} Arena;
+
+void arena_init(Arena* a, const char* name, size_t chunk_size);
+void* arena_alloc(Arena* a, size_t size);
+char* arena_strndup(Arena* a, const char* s, size_t n);
+char* arena_strdup(Arena* a, const char* s);
+void arena_reset(Arena* a);
+void arena_release(Arena* a);
+
+#endif
@@ -2,6 +2,7 @@
 #define AST_H
 
 #include "lexer_v2.h"
+#include "arena.h"
 #include <stddef.h>
 
 // Enumeração dos tipos de nós da AST
@@ -29,10 +30,22 @@ typedef enum {
     AST_BOOL_LITERAL,
     AST_IDENTIFIER,
     AST_CALL_EXPR,
-    AST_GROUPING_EXPR
+    AST_GROUPING_EXPR,
+    AST_INLINE_EXPR
 } ASTNodeType;
 
-// Estrutura base para todos os nós da AST
+// Tipos de valor inferidos por types.h. Nós que não passaram pela
+// inferência ficam com TYPE_INT, o zero, que era o tipo de tudo antes dela.
+typedef enum {
+    TYPE_INT,
+    TYPE_BOOL,
+    TYPE_STRING
+} ValueType;
+
+// Estrutura base para todos os nós da AST. Nós, literais, listas de
+// parâmetros e de argumentos vivem na Arena passada aos construtores e são
+// liberados junto com ela; não existe liberação por nó. Nomes são ids da
+// tabela de símbolos compartilhada (ver CompileContext), comparáveis com ==.
 typedef struct ASTNode {
     ASTNodeType type;
     int line;
@@ -42,16 +55,24 @@ typedef struct ASTNode {
 
 typedef struct {
     ASTNode base;
-    char* name;
+    int name;
     struct ASTNode* initializer;
+    int slot;                   // preenchido por resolve.h; -1 antes
+    ValueType value_type;       // preenchido por types.h
 } ASTVarDecl;
 
 typedef struct {
     ASTNode base;
-    char* name;
-    char** params;
+    int name;
+    int* params;
     int param_count;
     struct ASTNode* body;
+    int index;                  // preenchidos por resolve.h; -1 e 0 antes
+    int frame_size;
+    ValueType* param_types;     // preenchidos por types.h; NULL é tudo int
+    ValueType return_type;
+    int memo;                   // anotada com @memo no source
+    int memoized;               // preenchido por memo.h: ganha cache
 } ASTFnDecl;
 
 typedef struct {
@@ -85,29 +106,34 @@ typedef struct {
     struct ASTNode* expression;
 } ASTReturnStmt;
 
+// Também usado por input, isnumber, isstring, exit e abs.
 typedef struct {
     ASTNode base;
     struct ASTNode* expression;
+    ValueType value_type;       // tipo de expression, preenchido por types.h
 } ASTPrintStmt;
 
 typedef struct {
     ASTNode base;
-    char* name;
+    int name;
     struct ASTNode* value;
     TokenType op_type;
+    int slot;
 } ASTAssignStmt;
 
 typedef struct {
     ASTNode base;
-    char* name;
+    int name;
     struct ASTNode** args;
     int arg_count;
+    int fn_index;
 } ASTCallStmt;
 
 typedef struct {
     ASTNode base;
     struct ASTNode* left;
     TokenType operator;
+    ValueType operand_type;     // preenchido por types.h
     struct ASTNode* right;
 } ASTBinaryExpr;
 
@@ -134,14 +160,17 @@ typedef struct {
 
 typedef struct {
     ASTNode base;
-    char* name;
+    int name;
+    int slot;
 } ASTIdentifier;
 
 typedef struct {
     ASTNode base;
-    char* name;
+    int name;
     struct ASTNode** args;
     int arg_count;
+    int fn_index;
+    ValueType value_type;       // tipo do resultado, preenchido por types.h
 } ASTCallExpr;
 
 typedef struct {
@@ -149,37 +178,46 @@ typedef struct {
     struct ASTNode* expression;
 } ASTGroupingExpr;
 
+// Corpo de função expandido no lugar de uma chamada (inline.h): os
+// comandos rodam em ordem, num escopo próprio, e o valor é o de result.
+// Não aparece no source; vira uma expressão-comando do GNU C.
+typedef struct {
+    ASTNode base;
+    struct ASTNode* statements;
+    struct ASTNode* result;
+} ASTInlineExpr;
+
 typedef struct {
     ASTNode base;
     struct ASTNode* declarations;
+    int frame_size;             // slots do main
 } ASTProgram;
 
-ASTNode* ast_new_node(ASTNodeType type, size_t size, int line, int column);
-ASTProgram* ast_new_program();
-ASTVarDecl* ast_new_var_decl(char* name, ASTNode* initializer, int line, int column);
-ASTFnDecl* ast_new_fn_decl(char* name, char** params, int param_count, ASTNode* body, int line, int column);
-ASTBlock* ast_new_block(ASTNode* statements, int line, int column);
-ASTIfStmt* ast_new_if_stmt(ASTNode* condition, ASTNode* then_branch, ASTNode* else_branch, int line, int column);
-ASTWhileStmt* ast_new_while_stmt(ASTNode* condition, ASTNode* body, int line, int column);
-ASTForStmt* ast_new_for_stmt(ASTNode* initializer, ASTNode* condition, ASTNode* increment, ASTNode* body, int line, int column);
-ASTReturnStmt* ast_new_return_stmt(ASTNode* expression, int line, int column);
-ASTPrintStmt* ast_new_print_stmt(ASTNode* expression, int line, int column);
-ASTNode* ast_new_input_expr(ASTNode* prompt, int line, int column);
-ASTNode* ast_new_isnumber_expr(ASTNode* expression, int line, int column);
-ASTNode* ast_new_isstring_expr(ASTNode* expression, int line, int column);
-ASTNode* ast_new_exit_stmt(ASTNode* code, int line, int column);
-ASTNode* ast_new_abs_expr(ASTNode* expression, int line, int column);
-ASTAssignStmt* ast_new_assign_stmt(char* name, ASTNode* value, TokenType op_type, int line, int column);
-ASTCallStmt* ast_new_call_stmt(char* name, ASTNode** args, int arg_count, int line, int column);
-ASTBinaryExpr* ast_new_binary_expr(ASTNode* left, TokenType operator, ASTNode* right, int line, int column);
-ASTUnaryExpr* ast_new_unary_expr(TokenType operator, ASTNode* right, int line, int column);
-ASTIntLiteral* ast_new_int_literal(int value, int line, int column);
-ASTStringLiteral* ast_new_string_literal(char* value, int line, int column);
-ASTBoolLiteral* ast_new_bool_literal(int value, int line, int column);
-ASTIdentifier* ast_new_identifier(char* name, int line, int column);
-ASTCallExpr* ast_new_call_expr(char* name, ASTNode** args, int arg_count, int line, int column);
-ASTGroupingExpr* ast_new_grouping_expr(ASTNode* expression, int line, int column);
-
-void ast_free(ASTNode* node);
+ASTNode* ast_new_node(Arena* arena, ASTNodeType type, size_t size, int line, int column);
+ASTProgram* ast_new_program(Arena* arena);
+ASTVarDecl* ast_new_var_decl(Arena* arena, int name, ASTNode* initializer, int line, int column);
+ASTFnDecl* ast_new_fn_decl(Arena* arena, int name, int* params, int param_count, ASTNode* body, int line, int column);
+ASTBlock* ast_new_block(Arena* arena, ASTNode* statements, int line, int column);
+ASTIfStmt* ast_new_if_stmt(Arena* arena, ASTNode* condition, ASTNode* then_branch, ASTNode* else_branch, int line, int column);
+ASTWhileStmt* ast_new_while_stmt(Arena* arena, ASTNode* condition, ASTNode* body, int line, int column);
+ASTForStmt* ast_new_for_stmt(Arena* arena, ASTNode* initializer, ASTNode* condition, ASTNode* increment, ASTNode* body, int line, int column);
+ASTReturnStmt* ast_new_return_stmt(Arena* arena, ASTNode* expression, int line, int column);
+ASTPrintStmt* ast_new_print_stmt(Arena* arena, ASTNode* expression, int line, int column);
+ASTNode* ast_new_input_expr(Arena* arena, ASTNode* prompt, int line, int column);
+ASTNode* ast_new_isnumber_expr(Arena* arena, ASTNode* expression, int line, int column);
+ASTNode* ast_new_isstring_expr(Arena* arena, ASTNode* expression, int line, int column);
+ASTNode* ast_new_exit_stmt(Arena* arena, ASTNode* code, int line, int column);
+ASTNode* ast_new_abs_expr(Arena* arena, ASTNode* expression, int line, int column);
+ASTAssignStmt* ast_new_assign_stmt(Arena* arena, int name, ASTNode* value, TokenType op_type, int line, int column);
+ASTCallStmt* ast_new_call_stmt(Arena* arena, int name, ASTNode** args, int arg_count, int line, int column);
+ASTBinaryExpr* ast_new_binary_expr(Arena* arena, ASTNode* left, TokenType operator, ASTNode* right, int line, int column);
+ASTUnaryExpr* ast_new_unary_expr(Arena* arena, TokenType operator, ASTNode* right, int line, int column);
+ASTIntLiteral* ast_new_int_literal(Arena* arena, int value, int line, int column);
+ASTStringLiteral* ast_new_string_literal(Arena* arena, const char* value, int length, int line, int column);
+ASTBoolLiteral* ast_new_bool_literal(Arena* arena, int value, int line, int column);
+ASTIdentifier* ast_new_identifier(Arena* arena, int name, int line, int column);
+ASTCallExpr* ast_new_call_expr(Arena* arena, int name, ASTNode** args, int arg_count, int line, int column);
+ASTGroupingExpr* ast_new_grouping_expr(Arena* arena, ASTNode* expression, int line, int column);
+ASTInlineExpr* ast_new_inline_expr(Arena* arena, ASTNode* statements, ASTNode* result, int line, int column);
 
 #endif
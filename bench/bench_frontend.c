@@ -0,0 +1,282 @@
+// Benchmark do front-end: mede lexer, parser e geração de C separadamente.
+//
+// Uso: bench_frontend <arquivo.lamo> [repetições] [threads]
+//
+// Imprime uma linha JSON por arquivo com tempo e vazão de cada fase e o pico
+// de memória residente do processo. Com threads > 1 o lexer e o parser rodam
+// juntos pelo front-end paralelo, e só o total (frontend_s) é medido.
+// A mesma AST é convertida para a forma compacta (compact_ast.h), com
+// conversão, percurso e geração de C medidos à parte. O percurso também é
+// medido pelo gerenciador de passes (pass.h), com um passe e com quatro
+// passes fundidos numa travessia.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "../lexer_v2.h"
+#include "../parser_v2.h"
+#include "../ast.h"
+#include "../codegen.h"
+#include "../source.h"
+#include "../parallel.h"
+#include "../context.h"
+#include "../compact_ast.h"
+#include "../pass.h"
+#include "../resolve.h"
+#include "../types.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long count_nodes(ASTNode* node);
+
+static long count_list(ASTNode* node) {
+    long n = 0;
+    for (; node; node = node->next) n += count_nodes(node);
+    return n;
+}
+
+// Conta o nó e seus filhos; listas ligadas por next são percorridas em laço.
+static long count_nodes(ASTNode* node) {
+    if (!node) return 0;
+    long n = 1;
+    switch (node->type) {
+        case AST_PROGRAM: n += count_list(((ASTProgram*)node)->declarations); break;
+        case AST_VAR_DECL: n += count_nodes(((ASTVarDecl*)node)->initializer); break;
+        case AST_FN_DECL: n += count_nodes(((ASTFnDecl*)node)->body); break;
+        case AST_BLOCK: n += count_list(((ASTBlock*)node)->statements); break;
+        case AST_IF_STMT:
+            n += count_nodes(((ASTIfStmt*)node)->condition);
+            n += count_nodes(((ASTIfStmt*)node)->then_branch);
+            n += count_nodes(((ASTIfStmt*)node)->else_branch);
+            break;
+        case AST_WHILE_STMT:
+            n += count_nodes(((ASTWhileStmt*)node)->condition);
+            n += count_nodes(((ASTWhileStmt*)node)->body);
+            break;
+        case AST_FOR_STMT:
+            n += count_nodes(((ASTForStmt*)node)->initializer);
+            n += count_nodes(((ASTForStmt*)node)->condition);
+            n += count_nodes(((ASTForStmt*)node)->increment);
+            n += count_nodes(((ASTForStmt*)node)->body);
+            break;
+        case AST_RETURN_STMT:
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+            n += count_nodes(((ASTReturnStmt*)node)->expression);
+            break;
+        case AST_ASSIGN_STMT: n += count_nodes(((ASTAssignStmt*)node)->value); break;
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR:
+            for (int i = 0; i < ((ASTCallStmt*)node)->arg_count; i++) {
+                n += count_nodes(((ASTCallStmt*)node)->args[i]);
+            }
+            break;
+        case AST_BINARY_EXPR:
+            n += count_nodes(((ASTBinaryExpr*)node)->left);
+            n += count_nodes(((ASTBinaryExpr*)node)->right);
+            break;
+        case AST_UNARY_EXPR: n += count_nodes(((ASTUnaryExpr*)node)->right); break;
+        case AST_GROUPING_EXPR: n += count_nodes(((ASTGroupingExpr*)node)->expression); break;
+        default: break;
+    }
+    return n;
+}
+
+// Mesma contagem sobre a AST compacta, pela interface genérica de filhos.
+static void count_enter(ASTNode* node, void* state) {
+    (void)node;
+    (*(long*)state)++;
+}
+
+static long count_compact(const CompactAST* ast, NodeRef node) {
+    if (node == COMPACT_NONE) return 0;
+    long n = 1;
+    int children = compact_child_count(ast, node);
+    for (int i = 0; i < children; i++) n += count_compact(ast, compact_child(ast, node, i));
+    return n;
+}
+
+static long peak_rss_kb(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo.lamo> [repetições] [threads]\n", argv[0]);
+        return 1;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 1;
+    if (reps < 1) reps = 1;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    if (threads < 1) threads = 1;
+
+    SourceFile* src = source_open(argv[1]);
+    if (!src) {
+        perror(argv[1]);
+        return 1;
+    }
+    long lines = 0;
+    for (size_t i = 0; i < src->length; i++) lines += src->data[i] == '\n';
+
+    FILE* sink = fopen("/dev/null", "w");
+    if (!sink) {
+        perror("/dev/null");
+        return 1;
+    }
+
+    // Cada fase fica com o melhor tempo entre as repetições.
+    double lex_s = 1e30, parse_s = 1e30, frontend_s = 1e30, codegen_s = 1e30;
+    double walk_s = 1e30, pass_walk_s = 1e30, fused_walk_s = 1e30;
+    double compact_s = 1e30, compact_walk_s = 1e30, compact_codegen_s = 1e30;
+    long tokens = 0, nodes = 0;
+    size_t arena_bytes = 0, compact_size = 0;
+    int arith_ops = 0, safe_ops = 0;
+    for (int r = 0; r < reps; r++) {
+        ASTProgram* program;
+        CompileContext* ctx = context_new();
+        double t0 = now(), t1, t2;
+        if (threads > 1) {
+            program = parse_program_parallel(ctx, src->data, (int)src->length, threads);
+            t1 = t2 = now();
+        } else {
+            Lexer* lexer = lexer_init_symbols(src->data, (int)src->length, ctx->symbols);
+            t0 = now();
+            TokenBuffer* tb = token_buffer_build(lexer);
+            t1 = now();
+            Parser* parser = parser_init_tokens(lexer, tb, context_new_arena(ctx, "ast"));
+            program = parse_program_v2(parser);
+            t2 = now();
+            tokens = tb->count;
+            parser_free(parser);
+            token_buffer_free(tb);
+            lexer_free(lexer);
+        }
+        // A geração de C parte da AST resolvida e tipada, fora da medição.
+        PassManager* semantic = pass_manager_new();
+        Resolver* resolver = resolver_new(ctx->symbols);
+        Typer* typer = typer_new(context_new_arena(ctx, "types"));
+        Pass resolve = resolver_pass(resolver);
+        Pass type = typer_pass(typer);
+        pass_manager_add(semantic, &resolve);
+        pass_manager_add(semantic, &type);
+        pass_manager_run(semantic, program);
+        pass_manager_free(semantic);
+        double tg = now();
+        generate_c_code((ASTNode*)program, ctx->symbols, sink);
+        fflush(sink);
+        double t3 = now();
+
+        if (t1 - t0 < lex_s) lex_s = t1 - t0;
+        if (t2 - t1 < parse_s) parse_s = t2 - t1;
+        if (t2 - t0 < frontend_s) frontend_s = t2 - t0;
+        if (t3 - tg < codegen_s) codegen_s = t3 - tg;
+        nodes = count_nodes((ASTNode*)program);
+        double t4 = now();
+
+        // O mesmo percurso pelo gerenciador de passes: um passe sozinho e
+        // quatro fundidos numa única travessia.
+        long counts[4] = {0, 0, 0, 0};
+        PassManager* pm = pass_manager_new();
+        Pass pass = { "count", &counts[0], NULL, count_enter, NULL, NULL };
+        pass_manager_add(pm, &pass);
+        double tp0 = now();
+        pass_manager_run(pm, program);
+        double tp1 = now();
+        for (int i = 1; i < 4; i++) {
+            pass.state = &counts[i];
+            pass_manager_add(pm, &pass);
+        }
+        counts[0] = 0;
+        pass_manager_run(pm, program);
+        double tp2 = now();
+        pass_manager_free(pm);
+        for (int i = 0; i < 4; i++) {
+            if (counts[i] != nodes) {
+                fprintf(stderr, "Passe contou %ld nós, esperado %ld\n", counts[i], nodes);
+                return 1;
+            }
+        }
+        if (tp1 - tp0 < pass_walk_s) pass_walk_s = tp1 - tp0;
+        if (tp2 - tp1 < fused_walk_s) fused_walk_s = tp2 - tp1;
+
+        // A forma compacta é medida a partir da mesma AST: conversão,
+        // percurso completo e geração de C pelo adaptador.
+        double tc = now();
+        CompactAST* cast = compact_from_program(program, ctx->symbols);
+        double t5 = now();
+        long compact_nodes = 0;
+        for (uint32_t i = 0; i < cast->decl_count; i++) {
+            compact_nodes += count_compact(cast, cast->decls[i]);
+        }
+        double t6 = now();
+        compact_generate_c_code(cast, sink);
+        fflush(sink);
+        double t7 = now();
+        if (compact_nodes + 1 != nodes) {
+            fprintf(stderr, "AST compacta com %ld nós, esperado %ld\n", compact_nodes + 1, nodes);
+            return 1;
+        }
+
+        if (t4 - t3 < walk_s) walk_s = t4 - t3;
+        if (t5 - tc < compact_s) compact_s = t5 - tc;
+        if (t6 - t5 < compact_walk_s) compact_walk_s = t6 - t5;
+        if (t7 - t6 < compact_codegen_s) compact_codegen_s = t7 - t6;
+        compact_size = compact_bytes(cast);
+        compact_free(cast);
+
+        // Fração da aritmética que range.h prova sem estouro, fora da
+        // medição.
+        if (r == reps - 1) {
+            codegen_set_range_options(0, 0, 1);
+            generate_c_code((ASTNode*)program, ctx->symbols, sink);
+            arith_ops = codegen_range_stats()->arithmetic;
+            safe_ops = codegen_range_stats()->safe;
+            codegen_set_range_options(0, 0, 0);
+        }
+        typer_free(typer);
+        resolver_free(resolver);
+
+        arena_bytes = 0;
+        for (int i = 0; i < ctx->arena_count; i++) arena_bytes += ctx->arenas[i]->used;
+        context_free(ctx);
+    }
+    fclose(sink);
+
+    double mb = src->length / 1e6;
+    printf("{\"file\":\"%s\",\"threads\":%d,\"lines\":%ld,\"bytes\":%lu,\"nodes\":%ld,",
+           src->name, threads, lines, (unsigned long)src->length, nodes);
+    // Os tokens de cada pedaço paralelo não sobrevivem ao parse.
+    if (threads == 1) {
+        printf("\"tokens\":%ld,", tokens);
+        printf("\"lex_s\":%.6f,\"lex_mb_s\":%.1f,\"lex_tokens_s\":%.0f,"
+               "\"parse_s\":%.6f,\"parse_mb_s\":%.1f,\"parse_nodes_s\":%.0f,",
+               lex_s, mb / lex_s, tokens / lex_s,
+               parse_s, mb / parse_s, nodes / parse_s);
+    }
+    printf("\"frontend_s\":%.6f,\"frontend_mb_s\":%.1f,"
+           "\"codegen_s\":%.6f,\"codegen_mb_s\":%.1f,\"codegen_nodes_s\":%.0f,"
+           "\"walk_s\":%.6f,\"pass_walk_s\":%.6f,\"fused_walk_s\":%.6f,\"arena_kb\":%lu,"
+           "\"compact_s\":%.6f,\"compact_walk_s\":%.6f,\"compact_codegen_s\":%.6f,"
+           "\"compact_kb\":%lu,\"arith_ops\":%d,\"safe_ops\":%d,\"safe_fraction\":%.3f,"
+           "\"peak_rss_kb\":%ld}\n",
+           frontend_s, mb / frontend_s,
+           codegen_s, mb / codegen_s, nodes / codegen_s,
+           walk_s, pass_walk_s, fused_walk_s, (unsigned long)(arena_bytes / 1024),
+           compact_s, compact_walk_s, compact_codegen_s,
+           (unsigned long)(compact_size / 1024), arith_ops, safe_ops,
+           arith_ops ? (double)safe_ops / arith_ops : 1.0, peak_rss_kb());
+
+    source_close(src);
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Gerador determinístico de programas Lamo para os benchmarks do front-end.
+//
+// Uso: gen_lamo <linhas> [semente]
+//
+// O programa gerado mistura muitas funções pequenas, aninhamento profundo,
+// cadeias longas de expressões e literais de string grandes. A mesma
+// semente sempre produz o mesmo texto.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+static uint32_t rng_state = 2463534242u;
+static long lines = 0;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int rnd_range(int n) {
+    return (int)(rnd() % (uint32_t)n);
+}
+
+static void indent(int depth) {
+    for (int i = 0; i < depth; i++) fputs("    ", stdout);
+}
+
+static void newline(void) {
+    putchar('\n');
+    lines++;
+}
+
+static const char* const params[] = { "a", "b", "c" };
+
+static void operand(int locals) {
+    int r = rnd_range(4);
+    if (r == 0 || locals == 0) {
+        printf("%d", rnd_range(1000));
+    } else if (r == 1) {
+        printf("v%d", rnd_range(locals));
+    } else {
+        fputs(params[rnd_range(3)], stdout);
+    }
+}
+
+static void expression(int terms, int locals) {
+    static const char* const ops[] = { " + ", " - ", " * ", " < ", " == " };
+    operand(locals);
+    for (int i = 1; i < terms; i++) {
+        fputs(ops[rnd_range(3)], stdout);
+        if (rnd_range(6) == 0) {
+            putchar('(');
+            operand(locals);
+            fputs(ops[rnd_range(5)], stdout);
+            operand(locals);
+            putchar(')');
+        } else {
+            operand(locals);
+        }
+    }
+}
+
+static void string_literal(int length) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+    putchar('"');
+    for (int i = 0; i < length; i++) {
+        putchar(alphabet[rnd_range((int)sizeof(alphabet) - 1)]);
+    }
+    putchar('"');
+}
+
+// Corpo com blocos aninhados até max_depth; devolve o número de locais.
+static int body(int depth, int max_depth, int locals, int fn_index) {
+    int stmts = 2 + rnd_range(4);
+    for (int i = 0; i < stmts; i++) {
+        int r = rnd_range(10);
+        indent(depth);
+        if (r < 3) {
+            printf("let v%d = ", locals);
+            expression(1 + rnd_range(6), locals);
+            putchar(';');
+            locals++;
+        } else if (r < 5 && locals > 0) {
+            printf("v%d += ", rnd_range(locals));
+            expression(1 + rnd_range(3), locals);
+            putchar(';');
+        } else if (r < 6 && fn_index > 0) {
+            printf("print(f%d(", rnd_range(fn_index));
+            operand(locals); fputs(", ", stdout);
+            operand(locals); fputs(", ", stdout);
+            operand(locals);
+            fputs("));", stdout);
+        } else if (r < 7) {
+            fputs("// comentario ", stdout);
+            string_literal(20 + rnd_range(40));
+        } else if (depth < max_depth) {
+            int kind = rnd_range(3);
+            if (kind == 0) {
+                fputs("if (", stdout);
+                expression(2, locals);
+                fputs(") {", stdout);
+            } else if (kind == 1) {
+                fputs("while (", stdout);
+                expression(2, locals);
+                fputs(") {", stdout);
+            } else {
+                fputs("for (let i = 0; i < ", stdout);
+                operand(locals);
+                fputs("; i++) {", stdout);
+            }
+            newline();
+            body(depth + 1, max_depth, locals, fn_index);
+            indent(depth);
+            putchar('}');
+            if (kind == 0 && rnd_range(2)) {
+                fputs(" else {", stdout);
+                newline();
+                body(depth + 1, max_depth, locals, fn_index);
+                indent(depth);
+                putchar('}');
+            }
+        } else {
+            fputs("print(", stdout);
+            expression(2 + rnd_range(4), locals);
+            fputs(");", stdout);
+        }
+        newline();
+    }
+    return locals;
+}
+
+static void function(int index) {
+    printf("fn f%d(a, b, c) {", index);
+    newline();
+    int kind = rnd_range(20);
+    int locals = 0;
+    if (kind == 0) {
+        // Aninhamento profundo.
+        locals = body(1, 24, 0, index);
+    } else if (kind == 1) {
+        // Cadeia longa de expressão.
+        fputs("    let v0 = ", stdout);
+        expression(200 + rnd_range(300), 0);
+        putchar(';');
+        newline();
+        locals = 1;
+    } else if (kind == 2) {
+        // Literal de string grande.
+        fputs("    print(", stdout);
+        string_literal(2048 + rnd_range(6144));
+        fputs(");", stdout);
+        newline();
+    } else {
+        locals = body(1, 4, 0, index);
+    }
+    fputs("    return ", stdout);
+    expression(1 + rnd_range(4), locals);
+    putchar(';');
+    newline();
+    putchar('}');
+    newline();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <linhas> [semente]\n", argv[0]);
+        return 1;
+    }
+    long target = atol(argv[1]);
+    if (argc > 2) rng_state = (uint32_t)strtoul(argv[2], NULL, 10) | 1u;
+
+    int fn_count = 0;
+    while (lines < target) {
+        if (rnd_range(4) == 0) {
+            printf("let m%ld = ", lines);
+            expression(1 + rnd_range(5), 0);
+            putchar(';');
+            newline();
+            if (fn_count > 0) {
+                printf("print(f%d(1, 2, 3));", rnd_range(fn_count));
+                newline();
+            }
+        } else {
+            function(fn_count++);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,304 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define LAMOC_MAGIC "LAMOC\0\0\0"
+#define LAMOC_BYTE_ORDER 0x01020304u
+#define LAMOC_ALIGN 8
+
+enum {
+    SEC_KINDS, SEC_OPS, SEC_A, SEC_B, SEC_C, SEC_POSITIONS,
+    SEC_EXTRA, SEC_STRINGS, SEC_DECLS, SEC_NAME_LENGTHS, SEC_NAMES,
+    SEC_COUNT
+};
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+} CacheSection;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t source_hash;
+    uint64_t source_length;
+    uint64_t config;            // passes que produziram a AST
+    uint32_t node_count;
+    uint32_t extra_count;
+    uint32_t strings_length;
+    uint32_t decl_count;
+    uint32_t symbol_count;
+    uint32_t kind_count;        // detecta mudanças em ASTNodeType
+    CacheSection sections[SEC_COUNT];
+} CacheHeader;
+
+// FNV-1a aplicado a palavras de 8 bytes em vez de bytes: oito vezes menos
+// multiplicações, o que importa porque o hash roda a cada execução.
+uint64_t cache_hash(const char* data, size_t length) {
+    uint64_t h = 0xcbf29ce484222325ull ^ (uint64_t)length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    if (i < length) {
+        uint64_t w = 0;
+        memcpy(&w, data + i, length - i);
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+char* cache_path(const SourceFile* src, uint64_t hash) {
+    const char* dir = getenv("LAMO_CACHE_DIR");
+    char* path;
+    if (dir && *dir) {
+        size_t n = strlen(dir) + 32;
+        path = malloc(n);
+        if (!path) return NULL;
+        snprintf(path, n, "%s/%016llx.lamoc", dir, (unsigned long long)hash);
+        return path;
+    }
+    if (strcmp(src->name, "<stdin>") == 0) return NULL;
+
+    size_t len = strlen(src->name);
+    path = malloc(len + 8);
+    if (!path) return NULL;
+    memcpy(path, src->name, len + 1);
+    if (len >= 5 && strcmp(path + len - 5, ".lamo") == 0) {
+        strcat(path, "c");
+    } else {
+        strcat(path, ".lamoc");
+    }
+    return path;
+}
+
+static int write_section(FILE* f, CacheHeader* h, int sec, const void* data, uint64_t size) {
+    static const char zeros[LAMOC_ALIGN] = { 0 };
+    long pos = ftell(f);
+    if (pos < 0) return -1;
+    long pad = (LAMOC_ALIGN - pos % LAMOC_ALIGN) % LAMOC_ALIGN;
+    if (pad && fwrite(zeros, 1, (size_t)pad, f) != (size_t)pad) return -1;
+    h->sections[sec].offset = (uint64_t)(pos + pad);
+    h->sections[sec].size = size;
+    if (size && fwrite(data, 1, (size_t)size, f) != size) return -1;
+    return 0;
+}
+
+int cache_save(const CompactAST* ast, uint64_t hash, uint64_t source_length, uint64_t config, const char* path) {
+    size_t tmp_len = strlen(path) + 32;
+    char* tmp = malloc(tmp_len);
+    if (!tmp) return -1;
+#ifndef _WIN32
+    snprintf(tmp, tmp_len, "%s.%ld.tmp", path, (long)getpid());
+#else
+    snprintf(tmp, tmp_len, "%s.tmp", path);
+#endif
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        free(tmp);
+        return -1;
+    }
+
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, LAMOC_MAGIC, sizeof(h.magic));
+    h.version = LAMOC_VERSION;
+    h.byte_order = LAMOC_BYTE_ORDER;
+    h.source_hash = hash;
+    h.source_length = source_length;
+    h.config = config;
+    h.node_count = ast->count;
+    h.extra_count = ast->extra_count;
+    h.strings_length = ast->strings_length;
+    h.decl_count = ast->decl_count;
+    h.symbol_count = (uint32_t)symtab_count(ast->names);
+    h.kind_count = AST_INLINE_EXPR + 1;
+
+    // Nomes: tamanhos num array e textos concatenados, cada um com '\0'.
+    uint32_t* lengths = malloc(sizeof(uint32_t) * (h.symbol_count ? h.symbol_count : 1));
+    if (!lengths) {
+        fclose(f);
+        free(tmp);
+        return -1;
+    }
+    uint64_t names_size = 0;
+    for (uint32_t i = 0; i < h.symbol_count; i++) {
+        lengths[i] = (uint32_t)symtab_length(ast->names, (int)i);
+        names_size += lengths[i] + 1;
+    }
+
+    uint32_t n = ast->count;
+    int rc = fwrite(&h, sizeof(h), 1, f) == 1 ? 0 : -1;
+    if (rc == 0) rc = write_section(f, &h, SEC_KINDS, ast->kinds, n);
+    if (rc == 0) rc = write_section(f, &h, SEC_OPS, ast->ops, n);
+    if (rc == 0) rc = write_section(f, &h, SEC_A, ast->a, sizeof(uint32_t) * (uint64_t)n);
+    if (rc == 0) rc = write_section(f, &h, SEC_B, ast->b, sizeof(uint32_t) * (uint64_t)n);
+    if (rc == 0) rc = write_section(f, &h, SEC_C, ast->c, sizeof(uint32_t) * (uint64_t)n);
+    if (rc == 0) rc = write_section(f, &h, SEC_POSITIONS, ast->positions, sizeof(CompactPos) * (uint64_t)n);
+    if (rc == 0) rc = write_section(f, &h, SEC_EXTRA, ast->extra, sizeof(uint32_t) * (uint64_t)ast->extra_count);
+    if (rc == 0) rc = write_section(f, &h, SEC_STRINGS, ast->strings, ast->strings_length);
+    if (rc == 0) rc = write_section(f, &h, SEC_DECLS, ast->decls, sizeof(NodeRef) * (uint64_t)ast->decl_count);
+    if (rc == 0) rc = write_section(f, &h, SEC_NAME_LENGTHS, lengths, sizeof(uint32_t) * (uint64_t)h.symbol_count);
+    if (rc == 0) {
+        rc = write_section(f, &h, SEC_NAMES, NULL, 0);
+        for (uint32_t i = 0; rc == 0 && i < h.symbol_count; i++) {
+            if (fwrite(symtab_name(ast->names, (int)i), 1, lengths[i] + 1, f) != lengths[i] + 1) rc = -1;
+        }
+        h.sections[SEC_NAMES].size = names_size;
+    }
+    // O cabeçalho é reescrito no fim, já com os offsets.
+    if (rc == 0 && (fseek(f, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, f) != 1)) rc = -1;
+    if (fclose(f) != 0) rc = -1;
+    free(lengths);
+
+    if (rc == 0 && rename(tmp, path) != 0) rc = -1;
+    if (rc != 0) remove(tmp);
+    free(tmp);
+    return rc;
+}
+
+static void release_heap(void* image, size_t size) {
+    (void)size;
+    free(image);
+}
+
+#ifndef _WIN32
+static void release_map(void* image, size_t size) {
+    munmap(image, size);
+}
+#endif
+
+// Lê o arquivo inteiro: mmap quando possível, senão um buffer no heap.
+static void* load_image(const char* path, size_t* size, void (**release)(void*, size_t)) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            close(fd);
+            *size = (size_t)st.st_size;
+            *release = release_map;
+            return p;
+        }
+    }
+    close(fd);
+#endif
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    void* buf = NULL;
+    long len;
+    if (fseek(f, 0, SEEK_END) == 0 && (len = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        buf = malloc((size_t)len);
+        if (buf && fread(buf, 1, (size_t)len, f) != (size_t)len) {
+            free(buf);
+            buf = NULL;
+        }
+        *size = (size_t)len;
+    }
+    fclose(f);
+    *release = release_heap;
+    return buf;
+}
+
+static const void* section(const char* base, size_t file_size, const CacheSection* s, uint64_t expected) {
+    if (s->size != expected || s->offset % LAMOC_ALIGN != 0) return NULL;
+    if (s->offset > file_size || s->size > file_size - s->offset) return NULL;
+    return base + s->offset;
+}
+
+CompactAST* cache_load(const char* path, uint64_t hash, uint64_t source_length, uint64_t config,
+                       SymbolTable* names) {
+    size_t size = 0;
+    void (*release)(void*, size_t) = NULL;
+    char* base = load_image(path, &size, &release);
+    if (!base) return NULL;
+
+    const CacheHeader* h = (const CacheHeader*)base;
+    if (size < sizeof(CacheHeader) || memcmp(h->magic, LAMOC_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != LAMOC_VERSION || h->byte_order != LAMOC_BYTE_ORDER ||
+        h->kind_count != AST_INLINE_EXPR + 1 ||
+        h->source_hash != hash || h->source_length != source_length || h->config != config) {
+        release(base, size);
+        return NULL;
+    }
+
+    uint64_t n = h->node_count;
+    const void* s[SEC_COUNT];
+    s[SEC_KINDS] = section(base, size, &h->sections[SEC_KINDS], n);
+    s[SEC_OPS] = section(base, size, &h->sections[SEC_OPS], n);
+    s[SEC_A] = section(base, size, &h->sections[SEC_A], 4 * n);
+    s[SEC_B] = section(base, size, &h->sections[SEC_B], 4 * n);
+    s[SEC_C] = section(base, size, &h->sections[SEC_C], 4 * n);
+    s[SEC_POSITIONS] = section(base, size, &h->sections[SEC_POSITIONS], sizeof(CompactPos) * n);
+    s[SEC_EXTRA] = section(base, size, &h->sections[SEC_EXTRA], 4 * (uint64_t)h->extra_count);
+    s[SEC_STRINGS] = section(base, size, &h->sections[SEC_STRINGS], h->strings_length);
+    s[SEC_DECLS] = section(base, size, &h->sections[SEC_DECLS], 4 * (uint64_t)h->decl_count);
+    s[SEC_NAME_LENGTHS] = section(base, size, &h->sections[SEC_NAME_LENGTHS], 4 * (uint64_t)h->symbol_count);
+    s[SEC_NAMES] = section(base, size, &h->sections[SEC_NAMES], h->sections[SEC_NAMES].size);
+    for (int i = 0; i < SEC_COUNT; i++) {
+        if (!s[i]) {
+            release(base, size);
+            return NULL;
+        }
+    }
+
+    // A única correção na carga: reinternar os nomes. Numa tabela nova os
+    // ids saem na mesma ordem em que foram gravados.
+    const uint32_t* lengths = s[SEC_NAME_LENGTHS];
+    const char* text = s[SEC_NAMES];
+    uint64_t remaining = h->sections[SEC_NAMES].size;
+    for (uint32_t i = 0; i < h->symbol_count; i++) {
+        if ((uint64_t)lengths[i] + 1 > remaining || text[lengths[i]] != '\0' ||
+            symtab_intern(names, text, (int)lengths[i]) != (int)i) {
+            release(base, size);
+            return NULL;
+        }
+        text += lengths[i] + 1;
+        remaining -= lengths[i] + 1;
+    }
+
+    CompactAST* ast = calloc(1, sizeof(CompactAST));
+    if (!ast) {
+        perror("Failed to allocate CompactAST");
+        exit(EXIT_FAILURE);
+    }
+    ast->count = ast->capacity = h->node_count;
+    ast->kinds = (uint8_t*)s[SEC_KINDS];
+    ast->ops = (uint8_t*)s[SEC_OPS];
+    ast->a = (uint32_t*)s[SEC_A];
+    ast->b = (uint32_t*)s[SEC_B];
+    ast->c = (uint32_t*)s[SEC_C];
+    ast->positions = (CompactPos*)s[SEC_POSITIONS];
+    ast->extra = (uint32_t*)s[SEC_EXTRA];
+    ast->extra_count = ast->extra_capacity = h->extra_count;
+    ast->strings = (char*)s[SEC_STRINGS];
+    ast->strings_length = ast->strings_capacity = h->strings_length;
+    ast->decls = (NodeRef*)s[SEC_DECLS];
+    ast->decl_count = ast->decl_capacity = h->decl_count;
+    ast->names = names;
+    ast->image = base;
+    ast->image_size = size;
+    ast->release = release;
+
+    if (!compact_validate(ast)) {
+        compact_free(ast);
+        return NULL;
+    }
+    return ast;
+}
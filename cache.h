@@ -0,0 +1,38 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "compact_ast.h"
+#include "source.h"
+
+// Cache binário da AST compacta (.lamoc). O arquivo é uma imagem dos arrays
+// de CompactAST com offsets relativos ao início, então é carregado com um
+// único mmap e usado no lugar, sem corrigir ponteiros. Só os nomes são
+// reinternados na tabela de símbolos. O cabeçalho guarda versão, ordem de
+// bytes, tamanho e hash do source e a configuração dos passes: qualquer
+// divergência invalida o cache.
+#define LAMOC_VERSION 5
+
+uint64_t cache_hash(const char* data, size_t length);
+
+// Caminho do cache para o source: $LAMO_CACHE_DIR/<hash>.lamoc quando a
+// variável existe, senão ao lado do arquivo (prog.lamo -> prog.lamoc).
+// Devolve NULL quando não há onde guardar (stdin sem LAMO_CACHE_DIR). O
+// resultado deve ser liberado com free.
+char* cache_path(const SourceFile* src, uint64_t hash);
+
+// A AST guardada é a de depois dos passes; config identifica quais rodaram
+// e com que parâmetros (o chamador a calcula, por exemplo com cache_hash
+// sobre uma descrição das opções).
+//
+// 0 em sucesso. A escrita vai para um arquivo temporário renomeado no fim,
+// então leitores concorrentes nunca veem um cache pela metade.
+int cache_save(const CompactAST* ast, uint64_t hash, uint64_t source_length, uint64_t config, const char* path);
+
+// NULL se o cache não existe, é de outra versão, de outro conteúdo ou de
+// outra configuração dos passes, ou está corrompido. names deve ser uma
+// tabela nova (lexer_new_symbols).
+CompactAST* cache_load(const char* path, uint64_t hash, uint64_t source_length, uint64_t config,
+                       SymbolTable* names);
+
+#endif
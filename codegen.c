@@ -1,18 +1,71 @@
 #include "codegen.h"
+#include "lower.h"
+#include "memo.h"
+#include "range.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
-static int indent_level = 0;
+// O C é gerado a partir da IR (ir.h): cada função e cada fragmento do main
+// é traduzido por lower.h e emitido bloco a bloco. Valores viram variáveis
+// vN declaradas no início; parâmetros são pN e variáveis do main que
+// atravessam fragmentos, mN. Os blocos saem em pós-ordem reversa, com goto
+// só onde o sucessor não é o próximo, e os phis viram cópias nas arestas.
 
-static void print_indent(FILE* out) {
-    for (int i = 0; i < indent_level; i++) {
-        fprintf(out, "    ");
-    }
+static const SymbolTable* symbols = NULL;
+static FILE* ir_dump = NULL;
+static int ir_check = 0;
+static int ir_errors = 0;
+static MainMemory* memory = NULL;
+
+// Com check, a aritmética que range.h não prova segura sai verificada;
+// com narrow, variáveis de intervalo pequeno ficam em signed char ou short.
+static int range_check = 0;
+static int range_narrow = 0;
+static int range_report = 0;
+static RangeStats range_stats;
+
+static int memo_entries = MEMO_ENTRIES;
+static int memo_report = 0;
+// Nomes das funções com cache já emitidas, para o relatório do main.
+static int* memo_names = NULL;
+static int memo_count = 0;
+static int memo_capacity = 0;
+
+// Rótulos e temporários das cópias são únicos no arquivo inteiro: os
+// fragmentos do main dividem a mesma função C.
+static int label_counter = 0;
+static int temp_counter = 0;
+
+void codegen_set_ir_options(FILE* dump, int verify) {
+    ir_dump = dump;
+    ir_check = verify;
 }
 
-static void generate_statement_code(ASTNode* node, FILE* out);
-static void generate_expression_code(ASTNode* node, FILE* out);
+int codegen_ir_errors(void) {
+    return ir_errors;
+}
+
+void codegen_set_memo_options(int entries, int report) {
+    memo_entries = entries;
+    memo_report = report;
+}
+
+void codegen_set_range_options(int check, int narrow, int report) {
+    range_check = check;
+    range_narrow = narrow;
+    range_report = report;
+}
+
+const RangeStats* codegen_range_stats(void) {
+    return &range_stats;
+}
+
+// Texto de um id de nome da AST.
+static const char* sym(int id) {
+    return symtab_name(symbols, id);
+}
 
 static const char* op_to_str(TokenType type) {
     switch (type) {
@@ -20,284 +73,741 @@ static const char* op_to_str(TokenType type) {
         case TOKEN_MINUS: return "-";
         case TOKEN_STAR: return "*";
         case TOKEN_SLASH: return "/";
-        case TOKEN_PERCENT: return "%%";
+        case TOKEN_PERCENT: return "%";
         case TOKEN_EQ_EQ: return "==";
         case TOKEN_BANG_EQ: return "!=";
         case TOKEN_LT: return "<";
         case TOKEN_GT: return ">";
         case TOKEN_LT_EQ: return "<=";
         case TOKEN_GT_EQ: return ">=";
-        case TOKEN_AND_AND: return "&&";
-        case TOKEN_OR_OR: return "||";
-        case TOKEN_BANG: return "!";
-        case TOKEN_EQUALS: return "=";
-        case TOKEN_PLUS_EQ: return "+=";
-        case TOKEN_MINUS_EQ: return "-=";
         default: return "??";
     }
 }
 
-void generate_c_code(ASTNode* node, FILE* out) {
-    if (!node) return;
+// Tipo C de um valor Lamo: bool vira int, como sempre foi.
+static const char* c_type(ValueType type) {
+    return type == TYPE_STRING ? "const char*" : "int";
+}
 
-    fprintf(out, "// Código gerado por Lamo v2 (via AST)\n");
-    fprintf(out, "#include <stdio.h>\n");
-    fprintf(out, "#include <stdlib.h>\n");
-    fprintf(out, "#include <string.h>\n\n");
+static const char* param_type(const ASTFnDecl* fn, int i) {
+    return c_type(fn->param_types ? fn->param_types[i] : TYPE_INT);
+}
 
-    // Protótipos de funções primeiro
-    ASTNode* current = ((ASTProgram*)node)->declarations;
-    while (current) {
-        if (current->type == AST_FN_DECL) {
-            ASTFnDecl* fn_decl = (ASTFnDecl*)current;
-            fprintf(out, "int %s(", fn_decl->name);
-            for (int i = 0; i < fn_decl->param_count; i++) {
-                if (i > 0) fprintf(out, ", ");
-                fprintf(out, "int %s", fn_decl->params[i]);
+static void* xcalloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Failed to allocate Emitter");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+typedef struct {
+    const IRFunction* f;
+    FILE* out;
+    const char* indent;
+    int* uses;              // usos por valores vivos e terminadores
+    int* use_block;         // bloco do (último) uso
+    unsigned char* live;
+    unsigned char* inlined; // vira expressão dentro do único uso
+    unsigned char* labeled; // alvo de goto
+    int* temp;              // cópia salva num temporário, ou -1
+    RangeInfo* ranges;      // NULL sem as opções de range.h
+    int label_base;
+    int end_label;          // fim do fragmento do main, ou -1
+} Emitter;
+
+static int is_root(const IRValue* v) {
+    switch (v->op) {
+        case IR_STORE:
+        case IR_CALL:
+        case IR_PRINT:
+        case IR_INPUT:
+            return 1;
+        case IR_BINARY:
+            // Divisão pode falhar: roda mesmo sem uso, como no source.
+            return v->binop == TOKEN_SLASH || v->binop == TOKEN_PERCENT;
+        default:
+            return 0;
+    }
+}
+
+static int is_pure(const IRValue* v) {
+    return v->op == IR_NEG || v->op == IR_NOT || v->op == IR_ABS ||
+           (v->op == IR_BINARY && !is_root(v));
+}
+
+static void add_use(Emitter* e, int value, int block, int* stack, int* top) {
+    e->uses[value]++;
+    e->use_block[value] = block;
+    if (!e->live[value]) {
+        e->live[value] = 1;
+        stack[(*top)++] = value;
+    }
+}
+
+// Marca o que é vivo a partir dos efeitos e terminadores, conta os usos e
+// escolhe os valores puros que podem ser escritos no lugar do uso: os de
+// um único uso no mesmo bloco, onde nenhuma atribuição entre a definição e
+// o uso muda o que leem.
+static void analyze(Emitter* e) {
+    const IRFunction* f = e->f;
+    int n = f->value_count;
+    int* stack = xcalloc(n, sizeof(int));
+    int top = 0;
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        const IRBlock* block = &f->blocks[b];
+        for (int k = 0; k < block->count; k++) {
+            int id = block->values[k];
+            if (is_root(&f->values[id]) && !e->live[id]) {
+                e->live[id] = 1;
+                stack[top++] = id;
             }
-            fprintf(out, ");\n");
         }
-        current = current->next;
+        if (block->term_value != IR_NONE) add_use(e, block->term_value, b, stack, &top);
     }
-    fprintf(out, "\n");
-
-    // Definições de funções
-    current = ((ASTProgram*)node)->declarations;
-    while (current) {
-        if (current->type == AST_FN_DECL) {
-            generate_statement_code(current, out);
-            fprintf(out, "\n");
+    while (top > 0) {
+        const IRValue* v = &f->values[stack[--top]];
+        for (int a = 0; a < v->arg_count; a++) {
+            // O operando de um phi é lido no fim do predecessor.
+            int where = v->op == IR_PHI ? f->blocks[v->block].preds[a] : v->block;
+            add_use(e, v->args[a], where, stack, &top);
         }
-        current = current->next;
     }
+    free(stack);
 
-    fprintf(out, "int main() {\n");
-    indent_level++;
-
-    current = ((ASTProgram*)node)->declarations;
-    while (current) {
-        if (current->type != AST_FN_DECL) {
-            generate_statement_code(current, out);
+    for (int id = 0; id < n; id++) {
+        const IRValue* v = &f->values[id];
+        if (!e->live[id]) continue;
+        if (v->op == IR_CONST || v->op == IR_STRING || v->op == IR_PARAM) {
+            e->inlined[id] = 1;
+        } else if (is_pure(v) && e->uses[id] == 1 && e->use_block[id] == v->block) {
+            e->inlined[id] = 1;
         }
-        current = current->next;
     }
+}
 
-    indent_level--;
-    fprintf(out, "    return 0;\n}\n");
+static void emit_value(Emitter* e, int id);
+
+static void emit_args(Emitter* e, const IRValue* v) {
+    for (int i = 0; i < v->arg_count; i++) {
+        if (i > 0) fprintf(e->out, ", ");
+        emit_value(e, v->args[i]);
+    }
 }
 
-static void generate_statement_code(ASTNode* node, FILE* out) {
-    if (!node) return;
+static int checked(const Emitter* e, int id) {
+    return range_check && e->ranges && range_is_arithmetic(&e->f->values[id]) && !e->ranges->safe[id];
+}
 
-    if (node->type != AST_BLOCK) print_indent(out);
+// Operação que pode estourar, pelas funções lamo_* do cabeçalho.
+static void emit_checked(Emitter* e, const IRValue* v) {
+    const char* name = "lamo_abs";
+    if (v->op == IR_NEG) name = "lamo_neg";
+    else if (v->op == IR_BINARY) {
+        switch (v->binop) {
+            case TOKEN_PLUS: name = "lamo_add"; break;
+            case TOKEN_MINUS: name = "lamo_sub"; break;
+            case TOKEN_STAR: name = "lamo_mul"; break;
+            case TOKEN_SLASH: name = "lamo_div"; break;
+            default: name = "lamo_mod"; break;
+        }
+    }
+    fprintf(e->out, "%s(", name);
+    emit_args(e, v);
+    fprintf(e->out, ")");
+}
 
-    switch (node->type) {
-        case AST_VAR_DECL: {
-            ASTVarDecl* var_decl = (ASTVarDecl*)node;
-            fprintf(out, "int %s = ", var_decl->name);
-            generate_expression_code(var_decl->initializer, out);
-            fprintf(out, ";\n");
+// Um valor como expressão C: o nome da variável ou, se for escrito no
+// lugar, a própria operação entre parênteses.
+static void emit_value(Emitter* e, int id) {
+    const IRValue* v = &e->f->values[id];
+    if (e->temp[id] >= 0) {
+        fprintf(e->out, "t%d", e->temp[id]);
+        return;
+    }
+    if (!e->inlined[id]) {
+        fprintf(e->out, "v%d", id);
+        return;
+    }
+    switch (v->op) {
+        case IR_CONST:
+            // -2147483648 em C é a negação de um long, não um int.
+            if (v->imm == INT_MIN) fprintf(e->out, "(-2147483647 - 1)");
+            else if (v->imm < 0) fprintf(e->out, "(%d)", v->imm);
+            else fprintf(e->out, "%d", v->imm);
             break;
-        }
-        case AST_FN_DECL: {
-            ASTFnDecl* fn_decl = (ASTFnDecl*)node;
-            fprintf(out, "int %s(", fn_decl->name);
-            for (int i = 0; i < fn_decl->param_count; i++) {
-                if (i > 0) fprintf(out, ", ");
-                fprintf(out, "int %s", fn_decl->params[i]);
-            }
-            fprintf(out, ") ");
-            generate_statement_code(fn_decl->body, out);
+        case IR_STRING:
+            fprintf(e->out, "\"%s\"", v->text);
             break;
-        }
-        case AST_BLOCK: {
-            ASTBlock* block = (ASTBlock*)node;
-            fprintf(out, "{\n");
-            indent_level++;
-            ASTNode* current = block->statements;
-            while (current) {
-                generate_statement_code(current, out);
-                current = current->next;
-            }
-            indent_level--;
-            print_indent(out);
-            fprintf(out, "}\n");
+        case IR_PARAM:
+            fprintf(e->out, "p%d", v->imm);
             break;
-        }
-        case AST_IF_STMT: {
-            ASTIfStmt* if_stmt = (ASTIfStmt*)node;
-            fprintf(out, "if (");
-            generate_expression_code(if_stmt->condition, out);
-            fprintf(out, ") ");
-            generate_statement_code(if_stmt->then_branch, out);
-            if (if_stmt->else_branch) {
-                print_indent(out);
-                fprintf(out, "else ");
-                generate_statement_code(if_stmt->else_branch, out);
+        default: {
+            // Expressão sem parênteses por fora: quem chama decide.
+            fprintf(e->out, "(");
+            if (checked(e, id)) {
+                emit_checked(e, v);
+                fprintf(e->out, ")");
+                break;
             }
+            switch (v->op) {
+                case IR_BINARY:
+                    if (v->operand_type == TYPE_STRING) {
+                        // Strings comparam pelo conteúdo, não pelo ponteiro.
+                        fprintf(e->out, "strcmp(");
+                        emit_value(e, v->args[0]);
+                        fprintf(e->out, ", ");
+                        emit_value(e, v->args[1]);
+                        fprintf(e->out, ") %s 0", op_to_str(v->binop));
+                    } else {
+                        emit_value(e, v->args[0]);
+                        fprintf(e->out, " %s ", op_to_str(v->binop));
+                        emit_value(e, v->args[1]);
+                    }
+                    break;
+                case IR_NEG:
+                    fprintf(e->out, "-");
+                    emit_value(e, v->args[0]);
+                    break;
+                case IR_NOT:
+                    fprintf(e->out, "!");
+                    emit_value(e, v->args[0]);
+                    break;
+                case IR_ABS:
+                    fprintf(e->out, "abs(");
+                    emit_value(e, v->args[0]);
+                    fprintf(e->out, ")");
+                    break;
+                default:
+                    break;
+            }
+            fprintf(e->out, ")");
             break;
         }
-        case AST_WHILE_STMT: {
-            ASTWhileStmt* while_stmt = (ASTWhileStmt*)node;
-            fprintf(out, "while (");
-            generate_expression_code(while_stmt->condition, out);
-            fprintf(out, ") ");
-            generate_statement_code(while_stmt->body, out);
-            break;
+    }
+}
+
+// A operação de um valor não escrito no lugar, para o lado direito da
+// atribuição.
+static void emit_operation(Emitter* e, int id) {
+    unsigned char saved = e->inlined[id];
+    e->inlined[id] = 1;
+    emit_value(e, id);
+    e->inlined[id] = saved;
+}
+
+// Se a expressão do valor lê a variável target.
+static int reads(const Emitter* e, int id, int target) {
+    if (e->temp[id] >= 0) return 0;
+    if (!e->inlined[id]) return id == target;
+    const IRValue* v = &e->f->values[id];
+    for (int a = 0; a < v->arg_count; a++) {
+        if (reads(e, v->args[a], target)) return 1;
+    }
+    return 0;
+}
+
+static int has_variable(const Emitter* e, int id) {
+    const IRValue* v = &e->f->values[id];
+    if (!e->live[id] || e->inlined[id]) return 0;
+    switch (v->op) {
+        case IR_STORE:
+        case IR_PRINT:
+            return 0;
+        case IR_CALL:
+        case IR_BINARY:
+            return e->uses[id] > 0;
+        default:
+            return 1;
+    }
+}
+
+// Tipo C da variável de um valor inteiro: com narrow, o menor que contém o
+// intervalo dele.
+static const char* storage_type(const Emitter* e, int id) {
+    if (!range_narrow || !e->ranges) return "int";
+    Range r = e->ranges->ranges[id];
+    if (r.lo >= -128 && r.hi <= 127) return "signed char";
+    if (r.lo >= -32768 && r.hi <= 32767) return "short";
+    return "int";
+}
+
+// Strings uma por linha; inteiros agrupados por tipo, até oito nomes por
+// linha.
+static void emit_declarations(Emitter* e) {
+    static const char* const int_types[] = { "int", "short", "signed char" };
+    const IRFunction* f = e->f;
+    for (int i = 0; i < f->order_count; i++) {
+        const IRBlock* block = &f->blocks[f->order[i]];
+        for (int k = 0; k < block->phi_count + block->count; k++) {
+            int id = k < block->phi_count ? block->phis[k] : block->values[k - block->phi_count];
+            if (!has_variable(e, id)) continue;
+            if (f->values[id].type == TYPE_STRING) fprintf(e->out, "%sconst char* v%d;\n", e->indent, id);
         }
-        case AST_FOR_STMT: {
-            ASTForStmt* for_stmt = (ASTForStmt*)node;
-            fprintf(out, "for (");
-            if (for_stmt->initializer) {
-                if (for_stmt->initializer->type == AST_VAR_DECL) {
-                    ASTVarDecl* vd = (ASTVarDecl*)for_stmt->initializer;
-                    fprintf(out, "int %s = ", vd->name);
-                    generate_expression_code(vd->initializer, out);
-                } else if (for_stmt->initializer->type == AST_ASSIGN_STMT) {
-                    ASTAssignStmt* as = (ASTAssignStmt*)for_stmt->initializer;
-                    fprintf(out, "%s %s ", as->name, op_to_str(as->op_type));
-                    generate_expression_code(as->value, out);
+    }
+    for (int t = 0; t < 3; t++) {
+        int column = 0;
+        for (int i = 0; i < f->order_count; i++) {
+            const IRBlock* block = &f->blocks[f->order[i]];
+            for (int k = 0; k < block->phi_count + block->count; k++) {
+                int id = k < block->phi_count ? block->phis[k] : block->values[k - block->phi_count];
+                if (!has_variable(e, id) || f->values[id].type == TYPE_STRING) continue;
+                if (strcmp(storage_type(e, id), int_types[t]) != 0) continue;
+                if (t > 0) range_stats.narrowed++;
+                if (column == 0) fprintf(e->out, "%s%s v%d", e->indent, int_types[t], id);
+                else fprintf(e->out, ", v%d", id);
+                if (++column == 8) {
+                    fprintf(e->out, ";\n");
+                    column = 0;
                 }
             }
-            fprintf(out, "; ");
-            if (for_stmt->condition) generate_expression_code(for_stmt->condition, out);
-            fprintf(out, "; ");
-            if (for_stmt->increment) {
-                ASTAssignStmt* as = (ASTAssignStmt*)for_stmt->increment;
-                fprintf(out, "%s %s ", as->name, op_to_str(as->op_type));
-                generate_expression_code(as->value, out);
-            }
-            fprintf(out, ") ");
-            generate_statement_code(for_stmt->body, out);
-            break;
         }
-        case AST_RETURN_STMT: {
-            ASTReturnStmt* ret_stmt = (ASTReturnStmt*)node;
-            fprintf(out, "return ");
-            generate_expression_code(ret_stmt->expression, out);
-            fprintf(out, ";\n");
+        if (column > 0) fprintf(e->out, ";\n");
+    }
+}
+
+static void emit_statement(Emitter* e, int id) {
+    const IRValue* v = &e->f->values[id];
+    FILE* out = e->out;
+    if (!e->live[id] || e->inlined[id]) return;
+    switch (v->op) {
+        case IR_PHI:
             break;
-        }
-        case AST_PRINT_STMT: {
-            ASTPrintStmt* print_stmt = (ASTPrintStmt*)node;
-            if (print_stmt->expression->type == AST_STRING_LITERAL) {
-                fprintf(out, "printf(\"%%s\\n\", ");
-            } else {
-                fprintf(out, "printf(\"%%d\\n\", ");
-            }
-            generate_expression_code(print_stmt->expression, out);
-            fprintf(out, ");\n");
+        case IR_LOAD:
+            fprintf(out, "%sv%d = m%d;\n", e->indent, id, v->imm);
             break;
-        }
-        case AST_ASSIGN_STMT: {
-            ASTAssignStmt* assign_stmt = (ASTAssignStmt*)node;
-            fprintf(out, "%s %s ", assign_stmt->name, op_to_str(assign_stmt->op_type));
-            generate_expression_code(assign_stmt->value, out);
+        case IR_STORE:
+            fprintf(out, "%sm%d = ", e->indent, v->imm);
+            emit_value(e, v->args[0]);
             fprintf(out, ";\n");
             break;
-        }
-        case AST_CALL_STMT: {
-            ASTCallStmt* call_stmt = (ASTCallStmt*)node;
-            fprintf(out, "%s(", call_stmt->name);
-            for (int i = 0; i < call_stmt->arg_count; i++) {
-                if (i > 0) fprintf(out, ", ");
-                generate_expression_code(call_stmt->args[i], out);
+        case IR_PRINT:
+            fprintf(out, "%sprintf(\"%s\\n\", ", e->indent, v->operand_type == TYPE_STRING ? "%s" : "%d");
+            emit_value(e, v->args[0]);
+            fprintf(out, ");\n");
+            break;
+        case IR_INPUT:
+            if (v->arg_count == 1) {
+                fprintf(out, "%sprintf(\"%s\", ", e->indent, v->operand_type == TYPE_STRING ? "%s" : "%d");
+                emit_value(e, v->args[0]);
+                fprintf(out, ");\n");
             }
+            fprintf(out, "%sscanf(\"%%d\", &v%d);\n", e->indent, id);
+            break;
+        case IR_CALL:
+            if (e->uses[id] > 0) fprintf(out, "%sv%d = fn_%s(", e->indent, id, sym(v->name));
+            else fprintf(out, "%sfn_%s(", e->indent, sym(v->name));
+            emit_args(e, v);
             fprintf(out, ");\n");
             break;
-        }
-        default: break;
+        default:
+            if (e->uses[id] > 0) {
+                fprintf(out, "%sv%d = ", e->indent, id);
+                emit_operation(e, id);
+            } else {
+                fprintf(out, "%s(void)", e->indent);
+                emit_operation(e, id);
+            }
+            fprintf(out, ";\n");
+            break;
     }
 }
 
-static void generate_expression_code(ASTNode* node, FILE* out) {
-    if (!node) return;
+// Índice do predecessor pred em to; nth conta arestas repetidas (branch
+// com os dois lados no mesmo bloco).
+static int pred_index(const IRFunction* f, int to, int pred, int nth) {
+    const IRBlock* block = &f->blocks[to];
+    for (int i = 0; i < block->pred_count; i++) {
+        if (block->preds[i] == pred && nth-- == 0) return i;
+    }
+    return -1;
+}
 
-    switch (node->type) {
-        case AST_INT_LITERAL:
-            fprintf(out, "%d", ((ASTIntLiteral*)node)->value);
-            break;
-        case AST_STRING_LITERAL:
-            fprintf(out, "\"%s\"", ((ASTStringLiteral*)node)->value);
-            break;
-        case AST_BOOL_LITERAL:
-            fprintf(out, "%d", ((ASTBoolLiteral*)node)->value);
-            break;
-        case AST_IDENTIFIER:
-            fprintf(out, "%s", ((ASTIdentifier*)node)->name);
-            break;
-        case AST_BINARY_EXPR: {
-            ASTBinaryExpr* expr = (ASTBinaryExpr*)node;
-            generate_expression_code(expr->left, out);
-            fprintf(out, " %s ", op_to_str(expr->operator));
-            generate_expression_code(expr->right, out);
-            break;
+static int has_copies(const Emitter* e, int from, int to, int nth) {
+    const IRBlock* block = &e->f->blocks[to];
+    int index = pred_index(e->f, to, from, nth);
+    for (int p = 0; p < block->phi_count; p++) {
+        int phi = block->phis[p];
+        if (e->live[phi] && e->f->values[phi].args[index] != phi) return 1;
+    }
+    return 0;
+}
+
+// Os phis de to recebem, ao mesmo tempo, os operandos vindos de from. Uma
+// cópia só pode ser feita quando nenhuma das pendentes ainda lê o destino
+// dela; num ciclo (a, b = b, a), um destino é salvo num temporário antes.
+static void emit_copies(Emitter* e, int from, int to, int nth, const char* indent) {
+    const IRFunction* f = e->f;
+    const IRBlock* block = &f->blocks[to];
+    int index = pred_index(f, to, from, nth);
+    int* pending = xcalloc(block->phi_count, sizeof(int));
+    int n = 0;
+    for (int p = 0; p < block->phi_count; p++) {
+        int phi = block->phis[p];
+        if (e->live[phi] && f->values[phi].args[index] != phi) pending[n++] = phi;
+    }
+    int* saved = xcalloc(n, sizeof(int));
+    int saved_count = 0;
+    while (n > 0) {
+        int pick = -1;
+        for (int i = 0; i < n && pick < 0; i++) {
+            int blocked = 0;
+            for (int j = 0; j < n && !blocked; j++) {
+                if (j != i && reads(e, f->values[pending[j]].args[index], pending[i])) blocked = 1;
+            }
+            if (!blocked) pick = i;
         }
-        case AST_UNARY_EXPR: {
-            ASTUnaryExpr* expr = (ASTUnaryExpr*)node;
-            fprintf(out, "%s", op_to_str(expr->operator));
-            generate_expression_code(expr->right, out);
-            break;
+        if (pick < 0) {
+            int phi = pending[0];
+            fprintf(e->out, "%s%s t%d = v%d;\n", indent, c_type(f->values[phi].type), temp_counter, phi);
+            e->temp[phi] = temp_counter++;
+            saved[saved_count++] = phi;
+            continue;
         }
-        case AST_CALL_EXPR: {
-            ASTCallExpr* call_expr = (ASTCallExpr*)node;
-            fprintf(out, "%s(", call_expr->name);
-            for (int i = 0; i < call_expr->arg_count; i++) {
-                if (i > 0) fprintf(out, ", ");
-                generate_expression_code(call_expr->args[i], out);
+        int phi = pending[pick];
+        fprintf(e->out, "%sv%d = ", indent, phi);
+        emit_value(e, f->values[phi].args[index]);
+        fprintf(e->out, ";\n");
+        pending[pick] = pending[--n];
+    }
+    for (int i = 0; i < saved_count; i++) e->temp[saved[i]] = -1;
+    free(saved);
+    free(pending);
+}
+
+static void emit_goto(Emitter* e, int target, const char* indent) {
+    fprintf(e->out, "%sgoto L%d;\n", indent, e->label_base + target);
+}
+
+// Emite o terminador de b; next é o bloco seguinte na ordem (-1 no fim).
+// Com dry, só marca os blocos que precisarão de rótulo.
+static void emit_terminator(Emitter* e, int b, int next, int dry) {
+    const IRFunction* f = e->f;
+    const IRBlock* block = &f->blocks[b];
+    FILE* out = e->out;
+    switch (block->term) {
+        case IR_JUMP: {
+            int target = block->succs[0];
+            if (!dry) emit_copies(e, b, target, 0, e->indent);
+            if (target != next) {
+                if (dry) e->labeled[target] = 1;
+                else emit_goto(e, target, e->indent);
             }
-            fprintf(out, ")");
             break;
         }
-        case AST_GROUPING_EXPR:
-            fprintf(out, "(");
-            generate_expression_code(((ASTGroupingExpr*)node)->expression, out);
-            fprintf(out, ")");
-            break;
-        case AST_INPUT_EXPR: {
-            ASTPrintStmt* input_expr = (ASTPrintStmt*)node;
-            fprintf(out, "({ ");
-            if (input_expr->expression) {
-                if (input_expr->expression->type == AST_STRING_LITERAL) {
-                    fprintf(out, "printf(\"%%s\", ");
-                } else {
-                    fprintf(out, "printf(\"%%d\", ");
+        case IR_BRANCH: {
+            int t = block->succs[0];
+            int fl = block->succs[1];
+            int nth = t == fl ? 1 : 0;
+            if (t == next && t != fl && !has_copies(e, b, t, 0)) {
+                // Cai no lado verdadeiro; só o falso precisa de goto.
+                if (dry) {
+                    e->labeled[fl] = 1;
+                    break;
                 }
-                generate_expression_code(input_expr->expression, out);
-                fprintf(out, "); ");
+                fprintf(out, "%sif (!", e->indent);
+                emit_value(e, block->term_value);
+                fprintf(out, ") {\n");
+                char inner[64];
+                snprintf(inner, sizeof(inner), "%s    ", e->indent);
+                emit_copies(e, b, fl, 0, inner);
+                emit_goto(e, fl, inner);
+                fprintf(out, "%s}\n", e->indent);
+                break;
             }
-            fprintf(out, "int _val; scanf(\"%%d\", &_val); _val; })");
-            break;
-        }
-        case AST_ISNUMBER_EXPR: {
-            // For now, in this simple language, everything is an int
-            fprintf(out, "1"); 
+            if (dry) {
+                e->labeled[t] = 1;
+                if (fl != next) e->labeled[fl] = 1;
+                break;
+            }
+            fprintf(out, "%sif (", e->indent);
+            emit_value(e, block->term_value);
+            fprintf(out, ") {\n");
+            char inner[64];
+            snprintf(inner, sizeof(inner), "%s    ", e->indent);
+            emit_copies(e, b, t, 0, inner);
+            emit_goto(e, t, inner);
+            fprintf(out, "%s}\n", e->indent);
+            emit_copies(e, b, fl, nth, e->indent);
+            if (fl != next) emit_goto(e, fl, e->indent);
             break;
         }
-        case AST_ISSTRING_EXPR: {
-            // For now, literals are known, but variables are int
-            ASTPrintStmt* is_str = (ASTPrintStmt*)node;
-            if (is_str->expression->type == AST_STRING_LITERAL) {
-                fprintf(out, "1");
+        case IR_RETURN:
+            if (dry) break;
+            if (block->term_value == IR_NONE) {
+                fprintf(out, "%sreturn 0;\n", e->indent);
             } else {
-                fprintf(out, "0");
+                fprintf(out, "%sreturn ", e->indent);
+                emit_value(e, block->term_value);
+                fprintf(out, ";\n");
             }
             break;
-        }
-        case AST_EXIT_STMT: {
-            ASTPrintStmt* exit_stmt = (ASTPrintStmt*)node;
-            fprintf(out, "exit(");
-            generate_expression_code(exit_stmt->expression, out);
-            fprintf(out, ")");
+        case IR_EXIT:
+            if (dry) break;
+            fprintf(out, "%sexit(", e->indent);
+            emit_value(e, block->term_value);
+            fprintf(out, ");\n");
             break;
-        }
-        case AST_ABS_EXPR: {
-            ASTPrintStmt* abs_expr = (ASTPrintStmt*)node;
-            fprintf(out, "abs(");
-            generate_expression_code(abs_expr->expression, out);
-            fprintf(out, ")");
+        case IR_END:
+            if (next < 0) break;
+            if (dry) e->end_label = 1;
+            else fprintf(out, "%sgoto L%d;\n", e->indent, e->label_base + f->block_count);
+            break;
+        default:
             break;
+    }
+}
+
+// Corpo de uma função ou fragmento: declarações e blocos.
+static void emit_body(const IRFunction* f, const char* indent, FILE* out) {
+    if (ir_dump) ir_print(f, symbols, ir_dump);
+    if (ir_check) ir_errors += ir_verify(f, stderr);
+
+    Emitter e;
+    int n = f->value_count;
+    e.f = f;
+    e.out = out;
+    e.indent = indent;
+    e.uses = xcalloc(n, sizeof(int));
+    e.use_block = xcalloc(n, sizeof(int));
+    e.live = xcalloc(n, 1);
+    e.inlined = xcalloc(n, 1);
+    e.labeled = xcalloc(f->block_count, 1);
+    e.temp = xcalloc(n, sizeof(int));
+    for (int i = 0; i < n; i++) e.temp[i] = -1;
+    e.label_base = label_counter;
+    e.end_label = 0;
+    label_counter += f->block_count + 1;
+
+    e.ranges = range_check || range_narrow || range_report ? range_analyze(f) : NULL;
+
+    analyze(&e);
+    if (e.ranges) {
+        for (int id = 0; id < n; id++) {
+            if (!e.live[id] || !range_is_arithmetic(&f->values[id])) continue;
+            range_stats.arithmetic++;
+            range_stats.safe += e.ranges->safe[id];
+        }
+    }
+    emit_declarations(&e);
+    for (int i = 0; i < f->order_count; i++) {
+        int next = i + 1 < f->order_count ? f->order[i + 1] : -1;
+        emit_terminator(&e, f->order[i], next, 1);
+    }
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        const IRBlock* block = &f->blocks[b];
+        if (e.labeled[b]) fprintf(out, "L%d: ;\n", e.label_base + b);
+        for (int k = 0; k < block->count; k++) emit_statement(&e, block->values[k]);
+        emit_terminator(&e, b, i + 1 < f->order_count ? f->order[i + 1] : -1, 0);
+    }
+    if (e.end_label) fprintf(out, "L%d: ;\n", e.label_base + f->block_count);
+
+    free(e.uses);
+    free(e.use_block);
+    free(e.live);
+    free(e.inlined);
+    free(e.labeled);
+    free(e.temp);
+    range_free(e.ranges);
+}
+
+// Aritmética verificada: estouro encerra o programa com erro em vez de dar
+// a volta. Divisão por zero continua falhando como no C.
+static void emit_checked_helpers(FILE* out) {
+    fprintf(out, "static inline void lamo_overflow(void) {\n");
+    fprintf(out, "    fflush(stdout);\n");
+    fprintf(out, "    fprintf(stderr, \"Erro: estouro de inteiro\\n\");\n");
+    fprintf(out, "    exit(1);\n");
+    fprintf(out, "}\n");
+    static const char* const builtins[] = { "add", "sub", "mul" };
+    for (int i = 0; i < 3; i++) {
+        fprintf(out, "static inline int lamo_%s(int a, int b) {\n", builtins[i]);
+        fprintf(out, "    int r;\n");
+        fprintf(out, "    if (__builtin_%s_overflow(a, b, &r)) lamo_overflow();\n", builtins[i]);
+        fprintf(out, "    return r;\n");
+        fprintf(out, "}\n");
+    }
+    fprintf(out, "static inline int lamo_div(int a, int b) {\n");
+    fprintf(out, "    if (b == -1 && a == -2147483647 - 1) lamo_overflow();\n");
+    fprintf(out, "    return a / b;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "static inline int lamo_mod(int a, int b) {\n");
+    fprintf(out, "    if (b == -1 && a == -2147483647 - 1) lamo_overflow();\n");
+    fprintf(out, "    return a %% b;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "static inline int lamo_neg(int a) {\n");
+    fprintf(out, "    if (a == -2147483647 - 1) lamo_overflow();\n");
+    fprintf(out, "    return -a;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "static inline int lamo_abs(int a) {\n");
+    fprintf(out, "    if (a == -2147483647 - 1) lamo_overflow();\n");
+    fprintf(out, "    return abs(a);\n");
+    fprintf(out, "}\n\n");
+}
+
+// As seções do arquivo gerado podem ser emitidas separadamente; o modo
+// streaming usa isso para gerar cada declaração assim que é parseada.
+void codegen_emit_header(FILE* out) {
+    // Um arquivo novo: as variáveis do main começam do zero.
+    main_memory_free(memory);
+    memory = main_memory_new();
+    label_counter = 0;
+    temp_counter = 0;
+    memo_count = 0;
+    memset(&range_stats, 0, sizeof(range_stats));
+    lower_reset_stats();
+    fprintf(out, "// Código gerado por Lamo v2 (via IR)\n");
+    fprintf(out, "#include <stdio.h>\n");
+    fprintf(out, "#include <stdlib.h>\n");
+    fprintf(out, "#include <string.h>\n\n");
+    if (range_check) emit_checked_helpers(out);
+}
+
+// T prefixo_nome(T p0, ...)
+static void emit_signature(const ASTFnDecl* fn, const char* prefix, FILE* out) {
+    fprintf(out, "%s %s%s(", c_type(fn->return_type), prefix, sym(fn->name));
+    for (int i = 0; i < fn->param_count; i++) {
+        if (i > 0) fprintf(out, ", ");
+        fprintf(out, "%s p%d", param_type(fn, i), i);
+    }
+    fprintf(out, ")");
+}
+
+void codegen_emit_prototype(ASTNode* node, const SymbolTable* names, FILE* out) {
+    symbols = names;
+    emit_signature((ASTFnDecl*)node, "fn_", out);
+    fprintf(out, ";\n");
+}
+
+// fn_nome consulta a tabela e só chama body_nome, o corpo original, numa
+// falta; a entrada da posição é sobrescrita, então a tabela nunca cresce.
+// Os parâmetros de uma função com cache nunca são strings.
+static void emit_memo_wrapper(const ASTFnDecl* fn, FILE* out) {
+    const char* name = sym(fn->name);
+    int n = fn->param_count;
+    fprintf(out, "static struct { int used; int key[%d]; %s value; } cache_%s[%d];\n",
+            n > 0 ? n : 1, c_type(fn->return_type), name, memo_entries);
+    fprintf(out, "static long hits_%s, misses_%s;\n", name, name);
+    fprintf(out, "static ");
+    emit_signature(fn, "body_", out);
+    fprintf(out, ";\n\n");
+
+    emit_signature(fn, "fn_", out);
+    fprintf(out, " {\n");
+    fprintf(out, "    unsigned h = 0;\n");
+    for (int i = 0; i < n; i++) fprintf(out, "    h = (h ^ (unsigned)p%d) * 2654435761u;\n", i);
+    fprintf(out, "    h = (h ^ (h >> 15)) & %du;\n", memo_entries - 1);
+    fprintf(out, "    if (cache_%s[h].used", name);
+    for (int i = 0; i < n; i++) fprintf(out, " && cache_%s[h].key[%d] == p%d", name, i, i);
+    fprintf(out, ") {\n");
+    fprintf(out, "        hits_%s++;\n", name);
+    fprintf(out, "        return cache_%s[h].value;\n", name);
+    fprintf(out, "    }\n");
+    fprintf(out, "    misses_%s++;\n", name);
+    fprintf(out, "    %s r = body_%s(", c_type(fn->return_type), name);
+    for (int i = 0; i < n; i++) fprintf(out, "%sp%d", i > 0 ? ", " : "", i);
+    fprintf(out, ");\n");
+    fprintf(out, "    cache_%s[h].used = 1;\n", name);
+    for (int i = 0; i < n; i++) fprintf(out, "    cache_%s[h].key[%d] = p%d;\n", name, i, i);
+    fprintf(out, "    cache_%s[h].value = r;\n", name);
+    fprintf(out, "    return r;\n");
+    fprintf(out, "}\n\n");
+
+    if (memo_count == memo_capacity) {
+        memo_capacity = memo_capacity ? memo_capacity * 2 : 16;
+        memo_names = realloc(memo_names, sizeof(int) * memo_capacity);
+        if (!memo_names) {
+            perror("Failed to grow memo list");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memo_names[memo_count++] = fn->name;
+}
+
+void codegen_emit_function(ASTNode* node, const SymbolTable* names, FILE* out) {
+    symbols = names;
+    ASTFnDecl* fn_decl = (ASTFnDecl*)node;
+    if (fn_decl->memoized) {
+        emit_memo_wrapper(fn_decl, out);
+        fprintf(out, "static ");
+        emit_signature(fn_decl, "body_", out);
+    } else {
+        emit_signature(fn_decl, "fn_", out);
+    }
+    fprintf(out, " {\n");
+    IRFunction* f = lower_function(fn_decl, names);
+    emit_body(f, "    ", out);
+    ir_free(f);
+    fprintf(out, "}\n\n");
+}
+
+void codegen_emit_main_begin(FILE* out) {
+    if (memo_report && memo_count > 0) {
+        fprintf(out, "static void memo_report(void) {\n");
+        for (int i = 0; i < memo_count; i++) {
+            const char* name = sym(memo_names[i]);
+            fprintf(out, "    fprintf(stderr, \"cache de %s: %%ld acertos, %%ld faltas\\n\", hits_%s, misses_%s);\n",
+                    name, name, name);
+        }
+        fprintf(out, "}\n\n");
+    }
+    fprintf(out, "int main() {\n");
+    // atexit: exit() no meio do programa também imprime o relatório.
+    if (memo_report && memo_count > 0) fprintf(out, "    atexit(memo_report);\n");
+}
+
+// Um comando de nível superior vira um fragmento entre chaves; um let
+// declara antes dele a variável em memória que os próximos vão ler.
+void codegen_emit_main_statement(ASTNode* node, const SymbolTable* names, FILE* out) {
+    symbols = names;
+    if (!memory) memory = main_memory_new();
+    int slot;
+    ValueType type;
+    IRFunction* f = lower_main_statement(node, memory, &slot, &type);
+    // Sem leitura num fragmento seguinte, a variável só seria escrita.
+    if (slot >= 0) fprintf(out, "    %s m%d __attribute__((unused));\n", c_type(type), slot);
+    fprintf(out, "    {\n");
+    emit_body(f, "        ", out);
+    fprintf(out, "    }\n");
+    ir_free(f);
+}
+
+void codegen_emit_main_end(FILE* out) {
+    fprintf(out, "    return 0;\n}\n");
+}
+
+void generate_c_code(ASTNode* node, const SymbolTable* names, FILE* out) {
+    if (!node) return;
+
+    symbols = names;
+    codegen_emit_header(out);
+
+    // Protótipos de funções primeiro
+    ASTNode* current = ((ASTProgram*)node)->declarations;
+    while (current) {
+        if (current->type == AST_FN_DECL) {
+            codegen_emit_prototype(current, names, out);
+        }
+        current = current->next;
+    }
+    fprintf(out, "\n");
+
+    // Definições de funções
+    current = ((ASTProgram*)node)->declarations;
+    while (current) {
+        if (current->type == AST_FN_DECL) {
+            codegen_emit_function(current, names, out);
         }
-        default: break;
+        current = current->next;
     }
+
+    // O main inteiro é um só grafo: nada precisa ficar em memória.
+    codegen_emit_main_begin(out);
+    IRFunction* f = lower_main(((ASTProgram*)node)->declarations);
+    emit_body(f, "    ", out);
+    ir_free(f);
+    codegen_emit_main_end(out);
 }
@@ -2,9 +2,39 @@
 #define CODEGEN_H
 
 #include "ast.h"
+#include "range.h"
 #include <stdio.h>
 
-// Função principal para gerar código C a partir da AST
-void generate_c_code(ASTNode* node, FILE* out);
+// Função principal para gerar código C a partir da AST; names é a tabela
+// onde vivem os ids de nome dos nós.
+void generate_c_code(ASTNode* node, const SymbolTable* names, FILE* out);
+
+// Seções individuais, na ordem em que aparecem no arquivo gerado
+void codegen_emit_header(FILE* out);
+void codegen_emit_prototype(ASTNode* fn_decl, const SymbolTable* names, FILE* out);
+void codegen_emit_function(ASTNode* fn_decl, const SymbolTable* names, FILE* out);
+void codegen_emit_main_begin(FILE* out);
+void codegen_emit_main_statement(ASTNode* stmt, const SymbolTable* names, FILE* out);
+void codegen_emit_main_end(FILE* out);
+
+// A IR (ir.h) de cada função e fragmento do main é impressa em dump, se não
+// for NULL, e conferida por ir_verify se verify for diferente de zero; os
+// problemas vão para stderr e codegen_ir_errors devolve quantos foram.
+void codegen_set_ir_options(FILE* dump, int verify);
+int codegen_ir_errors(void);
+
+// Funções com cache (memo.h) ganham uma tabela de entries entradas (potência
+// de 2). Com report, o programa gerado imprime em stderr, ao sair, os
+// acertos e faltas de cada cache.
+void codegen_set_memo_options(int entries, int report);
+
+// Análise de intervalos (range.h) da IR de cada função. Com check, as
+// operações que podem estourar saem verificadas e encerram o programa com
+// erro; com narrow, valores de intervalo pequeno são guardados em signed
+// char ou short. Com qualquer uma das três opções, codegen_range_stats
+// soma as operações aritméticas geradas, as provadas seguras e as
+// variáveis estreitadas desde o último cabeçalho.
+void codegen_set_range_options(int check, int narrow, int report);
+const RangeStats* codegen_range_stats(void);
 
 #endif // CODEGEN_H
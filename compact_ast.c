@@ -0,0 +1,663 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compact_ast.h"
+#include "codegen.h"
+
+#define COMPACT_INITIAL_NODES 1024
+#define EXPAND_ARENA_CHUNK 65536
+
+static void* grow(void* p, uint32_t* capacity, uint32_t need, size_t elem) {
+    if (need <= *capacity) return p;
+    uint32_t cap = *capacity ? *capacity : 64;
+    while (cap < need) cap *= 2;
+    p = realloc(p, elem * cap);
+    if (!p) {
+        perror("Failed to grow CompactAST");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = cap;
+    return p;
+}
+
+static void grow_nodes(CompactAST* ast, uint32_t need) {
+    if (need <= ast->capacity) return;
+    uint32_t cap = ast->capacity;
+    while (cap < need) cap *= 2;
+    ast->kinds = realloc(ast->kinds, cap);
+    ast->ops = realloc(ast->ops, cap);
+    ast->a = realloc(ast->a, sizeof(uint32_t) * cap);
+    ast->b = realloc(ast->b, sizeof(uint32_t) * cap);
+    ast->c = realloc(ast->c, sizeof(uint32_t) * cap);
+    ast->positions = realloc(ast->positions, sizeof(CompactPos) * cap);
+    if (!ast->kinds || !ast->ops || !ast->a || !ast->b || !ast->c || !ast->positions) {
+        perror("Failed to grow CompactAST");
+        exit(EXIT_FAILURE);
+    }
+    ast->capacity = cap;
+}
+
+CompactAST* compact_new(SymbolTable* names) {
+    CompactAST* ast = calloc(1, sizeof(CompactAST));
+    if (!ast) {
+        perror("Failed to allocate CompactAST");
+        exit(EXIT_FAILURE);
+    }
+    ast->capacity = 1;
+    grow_nodes(ast, COMPACT_INITIAL_NODES);
+    // Nó 0: sentinela para filhos ausentes.
+    ast->kinds[0] = AST_PROGRAM;
+    ast->ops[0] = 0;
+    ast->a[0] = ast->b[0] = ast->c[0] = 0;
+    ast->positions[0].line = ast->positions[0].column = 0;
+    ast->count = 1;
+    ast->names = names;
+    return ast;
+}
+
+void compact_free(CompactAST* ast) {
+    if (!ast) return;
+    if (ast->image) {
+        if (ast->release) ast->release(ast->image, ast->image_size);
+        free(ast);
+        return;
+    }
+    free(ast->kinds);
+    free(ast->ops);
+    free(ast->a);
+    free(ast->b);
+    free(ast->c);
+    free(ast->positions);
+    free(ast->extra);
+    free(ast->strings);
+    free(ast->decls);
+    free(ast);
+}
+
+size_t compact_bytes(const CompactAST* ast) {
+    size_t per_node = 2 + 3 * sizeof(uint32_t) + sizeof(CompactPos);
+    return sizeof(CompactAST) + per_node * ast->capacity +
+           sizeof(uint32_t) * ast->extra_capacity + ast->strings_capacity +
+           sizeof(NodeRef) * ast->decl_capacity;
+}
+
+// O nó recebe o índice antes dos filhos (pré-ordem), então uma subárvore
+// ocupa uma faixa contígua dos arrays.
+static NodeRef new_node(CompactAST* ast, const ASTNode* node) {
+    grow_nodes(ast, ast->count + 1);
+    NodeRef r = ast->count++;
+    ast->kinds[r] = (uint8_t)node->type;
+    ast->ops[r] = 0;
+    ast->a[r] = ast->b[r] = ast->c[r] = COMPACT_NONE;
+    ast->positions[r].line = (uint32_t)node->line;
+    ast->positions[r].column = (uint32_t)node->column;
+    return r;
+}
+
+static uint32_t reserve_extra(CompactAST* ast, uint32_t n) {
+    ast->extra = grow(ast->extra, &ast->extra_capacity, ast->extra_count + n, sizeof(uint32_t));
+    uint32_t first = ast->extra_count;
+    ast->extra_count += n;
+    return first;
+}
+
+static uint32_t add_string(CompactAST* ast, const char* s) {
+    uint32_t n = (uint32_t)strlen(s);
+    ast->strings = grow(ast->strings, &ast->strings_capacity, ast->strings_length + n + 1, 1);
+    uint32_t start = ast->strings_length;
+    memcpy(ast->strings + start, s, n + 1);
+    ast->strings_length += n + 1;
+    return start;
+}
+
+static NodeRef convert(CompactAST* ast, ASTNode* node);
+
+// Lista ligada por next -> faixa em extra[].
+static uint32_t convert_list(CompactAST* ast, ASTNode* head, uint32_t* count) {
+    uint32_t n = 0;
+    for (ASTNode* s = head; s; s = s->next) n++;
+    uint32_t first = reserve_extra(ast, n);
+    uint32_t i = 0;
+    for (ASTNode* s = head; s; s = s->next) {
+        NodeRef child = convert(ast, s);
+        ast->extra[first + i++] = child;
+    }
+    *count = n;
+    return first;
+}
+
+static uint32_t convert_args(CompactAST* ast, ASTNode** args, int arg_count) {
+    uint32_t first = reserve_extra(ast, (uint32_t)arg_count);
+    for (int i = 0; i < arg_count; i++) {
+        NodeRef child = convert(ast, args[i]);
+        ast->extra[first + i] = child;
+    }
+    return first;
+}
+
+static NodeRef convert(CompactAST* ast, ASTNode* node) {
+    if (!node) return COMPACT_NONE;
+    NodeRef r = new_node(ast, node);
+    // Os arrays podem ser realocados durante a conversão dos filhos, então
+    // os campos só são escritos depois, por índice.
+    uint32_t a = COMPACT_NONE, b = COMPACT_NONE, c = COMPACT_NONE;
+    uint8_t op = 0;
+
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = (ASTVarDecl*)node;
+            a = (uint32_t)n->name;
+            c = reserve_extra(ast, 2);
+            ast->extra[c] = (uint32_t)n->value_type;
+            ast->extra[c + 1] = (uint32_t)n->slot;
+            b = convert(ast, n->initializer);
+            break;
+        }
+        case AST_FN_DECL: {
+            ASTFnDecl* n = (ASTFnDecl*)node;
+            a = (uint32_t)n->name;
+            uint32_t count = (uint32_t)n->param_count;
+            c = reserve_extra(ast, 2 * count + 2);
+            ast->extra[c] = count;
+            for (uint32_t i = 0; i < count; i++) {
+                ast->extra[c + 1 + i] = (uint32_t)n->params[i];
+                ast->extra[c + 1 + count + i] = n->param_types ? (uint32_t)n->param_types[i] : TYPE_INT;
+            }
+            ast->extra[c + 1 + 2 * count] = (uint32_t)n->return_type;
+            op = (uint8_t)((n->memo ? COMPACT_FN_MEMO : 0) | (n->memoized ? COMPACT_FN_MEMOIZED : 0));
+            b = convert(ast, n->body);
+            break;
+        }
+        case AST_BLOCK:
+            b = convert_list(ast, ((ASTBlock*)node)->statements, &c);
+            break;
+        case AST_IF_STMT: {
+            ASTIfStmt* n = (ASTIfStmt*)node;
+            a = convert(ast, n->condition);
+            b = convert(ast, n->then_branch);
+            c = convert(ast, n->else_branch);
+            break;
+        }
+        case AST_WHILE_STMT: {
+            ASTWhileStmt* n = (ASTWhileStmt*)node;
+            a = convert(ast, n->condition);
+            b = convert(ast, n->body);
+            break;
+        }
+        case AST_FOR_STMT: {
+            ASTForStmt* n = (ASTForStmt*)node;
+            a = convert(ast, n->initializer);
+            b = convert(ast, n->condition);
+            c = reserve_extra(ast, 2);
+            NodeRef increment = convert(ast, n->increment);
+            NodeRef body = convert(ast, n->body);
+            ast->extra[c] = increment;
+            ast->extra[c + 1] = body;
+            break;
+        }
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+            a = convert(ast, ((ASTPrintStmt*)node)->expression);
+            b = (uint32_t)((ASTPrintStmt*)node)->value_type;
+            break;
+        case AST_RETURN_STMT:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+            a = convert(ast, ((ASTReturnStmt*)node)->expression);
+            break;
+        case AST_GROUPING_EXPR:
+            a = convert(ast, ((ASTGroupingExpr*)node)->expression);
+            break;
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* n = (ASTAssignStmt*)node;
+            a = (uint32_t)n->name;
+            b = convert(ast, n->value);
+            c = (uint32_t)n->slot;
+            op = (uint8_t)n->op_type;
+            break;
+        }
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR: {
+            ASTCallStmt* n = (ASTCallStmt*)node;
+            a = (uint32_t)n->name;
+            b = convert_args(ast, n->args, n->arg_count);
+            c = (uint32_t)n->arg_count;
+            if (node->type == AST_CALL_EXPR) op = (uint8_t)((ASTCallExpr*)node)->value_type;
+            break;
+        }
+        case AST_BINARY_EXPR: {
+            ASTBinaryExpr* n = (ASTBinaryExpr*)node;
+            a = convert(ast, n->left);
+            b = convert(ast, n->right);
+            c = (uint32_t)n->operand_type;
+            op = (uint8_t)n->operator;
+            break;
+        }
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* n = (ASTUnaryExpr*)node;
+            a = convert(ast, n->right);
+            op = (uint8_t)n->operator;
+            break;
+        }
+        case AST_INT_LITERAL:
+            a = (uint32_t)((ASTIntLiteral*)node)->value;
+            break;
+        case AST_BOOL_LITERAL:
+            a = (uint32_t)((ASTBoolLiteral*)node)->value;
+            break;
+        case AST_STRING_LITERAL: {
+            const char* s = ((ASTStringLiteral*)node)->value;
+            a = add_string(ast, s);
+            b = (uint32_t)strlen(s);
+            break;
+        }
+        case AST_IDENTIFIER:
+            a = (uint32_t)((ASTIdentifier*)node)->name;
+            b = (uint32_t)((ASTIdentifier*)node)->slot;
+            break;
+        case AST_INLINE_EXPR:
+            b = convert_list(ast, ((ASTInlineExpr*)node)->statements, &c);
+            a = convert(ast, ((ASTInlineExpr*)node)->result);
+            break;
+        case AST_PROGRAM:
+            break;
+    }
+
+    ast->a[r] = a;
+    ast->b[r] = b;
+    ast->c[r] = c;
+    ast->ops[r] = op;
+    return r;
+}
+
+NodeRef compact_append(CompactAST* ast, ASTNode* decl) {
+    NodeRef r = convert(ast, decl);
+    ast->decls = grow(ast->decls, &ast->decl_capacity, ast->decl_count + 1, sizeof(NodeRef));
+    ast->decls[ast->decl_count++] = r;
+    return r;
+}
+
+// Devolve a folga deixada pelo crescimento geométrico dos arrays.
+void compact_shrink(CompactAST* ast) {
+    uint32_t n = ast->count;
+    ast->kinds = realloc(ast->kinds, n);
+    ast->ops = realloc(ast->ops, n);
+    ast->a = realloc(ast->a, sizeof(uint32_t) * n);
+    ast->b = realloc(ast->b, sizeof(uint32_t) * n);
+    ast->c = realloc(ast->c, sizeof(uint32_t) * n);
+    ast->positions = realloc(ast->positions, sizeof(CompactPos) * n);
+    ast->capacity = n;
+    if (ast->extra_count) {
+        ast->extra = realloc(ast->extra, sizeof(uint32_t) * ast->extra_count);
+        ast->extra_capacity = ast->extra_count;
+    }
+    if (ast->strings_length) {
+        ast->strings = realloc(ast->strings, ast->strings_length);
+        ast->strings_capacity = ast->strings_length;
+    }
+    if (ast->decl_count) {
+        ast->decls = realloc(ast->decls, sizeof(NodeRef) * ast->decl_count);
+        ast->decl_capacity = ast->decl_count;
+    }
+}
+
+CompactAST* compact_from_program(ASTProgram* program, SymbolTable* names) {
+    CompactAST* ast = compact_new(names);
+    for (ASTNode* decl = program->declarations; decl; decl = decl->next) {
+        compact_append(ast, decl);
+    }
+    compact_shrink(ast);
+    return ast;
+}
+
+CompactAST* compact_parse_program(Parser* p, PassManager* passes) {
+    CompactAST* ast = compact_new(parser_symbols(p));
+    while (parser_peek(p, 0).type != TOKEN_EOF) {
+        ASTNode* stmt = parse_statement(p);
+        if (stmt && passes) pass_manager_run_list(passes, &stmt);
+        if (!stmt) continue;
+        compact_append(ast, stmt);
+        arena_reset(parser_arena(p));
+    }
+    compact_shrink(ast);
+    return ast;
+}
+
+static int valid_child(const CompactAST* ast, NodeRef parent, uint32_t child) {
+    return child == COMPACT_NONE || (child > parent && child < ast->count);
+}
+
+static int valid_range(const CompactAST* ast, uint32_t first, uint32_t n) {
+    return first <= ast->extra_count && n <= ast->extra_count - first;
+}
+
+// Confere uma AST que veio de fora (cache em disco): tipos, nomes e faixas
+// dentro dos limites, e filhos sempre depois do pai. Como os nós estão em
+// pré-ordem, isso também garante que não há ciclos. Devolve 1 se válida.
+int compact_validate(const CompactAST* ast) {
+    uint32_t names = (uint32_t)symtab_count(ast->names);
+    // Cada slot é de um let ou de um parâmetro (um nome distinto na função).
+    uint32_t slots = ast->count + names;
+    if (ast->count == 0) return 0;
+    for (uint32_t i = 0; i < ast->decl_count; i++) {
+        if (ast->decls[i] == COMPACT_NONE || ast->decls[i] >= ast->count) return 0;
+    }
+    for (NodeRef r = 1; r < ast->count; r++) {
+        uint32_t a = ast->a[r], b = ast->b[r], c = ast->c[r];
+        int ok;
+        if (ast->ops[r] > TOKEN_UNKNOWN) return 0;
+        switch ((ASTNodeType)ast->kinds[r]) {
+            case AST_VAR_DECL:
+                ok = a < names && valid_child(ast, r, b) && valid_range(ast, c, 2) &&
+                     ast->extra[c] <= TYPE_STRING && ast->extra[c + 1] < slots;
+                break;
+            case AST_ASSIGN_STMT:
+                ok = a < names && valid_child(ast, r, b) && c < slots;
+                break;
+            case AST_FN_DECL: {
+                ok = a < names && valid_child(ast, r, b) && valid_range(ast, c, 1) &&
+                     valid_range(ast, c + 1, ast->extra[c]);
+                uint32_t n = ok ? ast->extra[c] : 0;
+                ok = ok && valid_range(ast, c + 1 + n, n + 1);
+                for (uint32_t i = 0; ok && i < n; i++) {
+                    ok = ast->extra[c + 1 + i] < names && ast->extra[c + 1 + n + i] <= TYPE_STRING;
+                }
+                ok = ok && ast->extra[c + 1 + 2 * n] <= TYPE_STRING &&
+                     ast->ops[r] <= (COMPACT_FN_MEMO | COMPACT_FN_MEMOIZED);
+                break;
+            }
+            case AST_BLOCK:
+                ok = valid_range(ast, b, c);
+                for (uint32_t i = 0; ok && i < c; i++) ok = valid_child(ast, r, ast->extra[b + i]);
+                break;
+            case AST_IF_STMT:
+                ok = valid_child(ast, r, a) && valid_child(ast, r, b) && valid_child(ast, r, c);
+                break;
+            case AST_WHILE_STMT:
+                ok = valid_child(ast, r, a) && valid_child(ast, r, b);
+                break;
+            case AST_BINARY_EXPR:
+                ok = valid_child(ast, r, a) && valid_child(ast, r, b) && c <= TYPE_STRING;
+                break;
+            case AST_FOR_STMT:
+                ok = valid_child(ast, r, a) && valid_child(ast, r, b) && valid_range(ast, c, 2) &&
+                     valid_child(ast, r, ast->extra[c]) && valid_child(ast, r, ast->extra[c + 1]);
+                break;
+            case AST_PRINT_STMT:
+            case AST_INPUT_EXPR:
+            case AST_ISNUMBER_EXPR:
+            case AST_ISSTRING_EXPR:
+                ok = valid_child(ast, r, a) && b <= TYPE_STRING;
+                break;
+            case AST_RETURN_STMT:
+            case AST_EXIT_STMT:
+            case AST_ABS_EXPR:
+            case AST_GROUPING_EXPR:
+            case AST_UNARY_EXPR:
+                ok = valid_child(ast, r, a);
+                break;
+            case AST_CALL_STMT:
+            case AST_CALL_EXPR:
+                ok = a < names && valid_range(ast, b, c) && ast->ops[r] <= TYPE_STRING;
+                for (uint32_t i = 0; ok && i < c; i++) ok = valid_child(ast, r, ast->extra[b + i]);
+                break;
+            case AST_INLINE_EXPR:
+                ok = valid_child(ast, r, a) && valid_range(ast, b, c);
+                for (uint32_t i = 0; ok && i < c; i++) ok = valid_child(ast, r, ast->extra[b + i]);
+                break;
+            case AST_IDENTIFIER:
+                ok = a < names && b < slots;
+                break;
+            case AST_STRING_LITERAL:
+                ok = a < ast->strings_length && b < ast->strings_length - a &&
+                     ast->strings[a + b] == '\0';
+                break;
+            case AST_INT_LITERAL:
+            case AST_BOOL_LITERAL:
+                ok = 1;
+                break;
+            default:
+                ok = 0;
+                break;
+        }
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+int compact_child_count(const CompactAST* ast, NodeRef node) {
+    switch ((ASTNodeType)ast->kinds[node]) {
+        case AST_VAR_DECL: return 1;
+        case AST_FN_DECL: return 1;
+        case AST_BLOCK: return (int)ast->c[node];
+        case AST_IF_STMT: return 3;
+        case AST_WHILE_STMT: return 2;
+        case AST_FOR_STMT: return 4;
+        case AST_RETURN_STMT:
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+        case AST_GROUPING_EXPR:
+        case AST_UNARY_EXPR:
+            return 1;
+        case AST_ASSIGN_STMT: return 1;
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR:
+            return (int)ast->c[node];
+        case AST_BINARY_EXPR: return 2;
+        case AST_INLINE_EXPR: return (int)ast->c[node] + 1;
+        default: return 0;
+    }
+}
+
+// Filhos ausentes (else, inicialização do for...) aparecem como COMPACT_NONE.
+NodeRef compact_child(const CompactAST* ast, NodeRef node, int index) {
+    switch ((ASTNodeType)ast->kinds[node]) {
+        case AST_VAR_DECL:
+        case AST_FN_DECL:
+        case AST_ASSIGN_STMT:
+            return ast->b[node];
+        case AST_BLOCK:
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR:
+            return ast->extra[ast->b[node] + index];
+        case AST_IF_STMT:
+            return index == 0 ? ast->a[node] : index == 1 ? ast->b[node] : ast->c[node];
+        case AST_WHILE_STMT:
+        case AST_BINARY_EXPR:
+            return index == 0 ? ast->a[node] : ast->b[node];
+        case AST_FOR_STMT:
+            if (index < 2) return index == 0 ? ast->a[node] : ast->b[node];
+            return ast->extra[ast->c[node] + index - 2];
+        case AST_INLINE_EXPR:
+            return (uint32_t)index < ast->c[node] ? ast->extra[ast->b[node] + index] : ast->a[node];
+        default:
+            return ast->a[node];
+    }
+}
+
+const char* compact_name(const CompactAST* ast, uint32_t name) {
+    return symtab_name(ast->names, (int)name);
+}
+
+static ASTNode* expand(const CompactAST* ast, NodeRef r, Arena* arena);
+
+static ASTNode** expand_args(const CompactAST* ast, NodeRef r, Arena* arena) {
+    uint32_t n = ast->c[r];
+    if (n == 0) return NULL;
+    ASTNode** args = arena_alloc(arena, sizeof(ASTNode*) * n);
+    for (uint32_t i = 0; i < n; i++) {
+        args[i] = expand(ast, ast->extra[ast->b[r] + i], arena);
+    }
+    return args;
+}
+
+// Cabeçalho de uma função (nome, parâmetros e tipos) sobre o corpo dado.
+static ASTFnDecl* expand_fn(const CompactAST* ast, NodeRef r, ASTNode* body, Arena* arena) {
+    const uint32_t* list = ast->extra + ast->c[r];
+    int count = (int)list[0];
+    int* params = NULL;
+    ValueType* types = NULL;
+    if (count > 0) {
+        params = arena_alloc(arena, sizeof(int) * count);
+        types = arena_alloc(arena, sizeof(ValueType) * count);
+        for (int i = 0; i < count; i++) {
+            params[i] = (int)list[1 + i];
+            types[i] = (ValueType)list[1 + count + i];
+        }
+    }
+    ASTFnDecl* fn = ast_new_fn_decl(arena, (int)ast->a[r], params, count, body,
+                                    (int)ast->positions[r].line, (int)ast->positions[r].column);
+    fn->param_types = types;
+    fn->return_type = (ValueType)list[1 + 2 * count];
+    fn->memo = (ast->ops[r] & COMPACT_FN_MEMO) != 0;
+    fn->memoized = (ast->ops[r] & COMPACT_FN_MEMOIZED) != 0;
+    return fn;
+}
+
+static ASTNode* expand_list(const CompactAST* ast, uint32_t first, uint32_t n, Arena* arena) {
+    ASTNode* head = NULL;
+    ASTNode* tail = NULL;
+    for (uint32_t i = 0; i < n; i++) {
+        ASTNode* stmt = expand(ast, ast->extra[first + i], arena);
+        if (tail) tail->next = stmt; else head = stmt;
+        tail = stmt;
+    }
+    return head;
+}
+
+static ASTNode* expand(const CompactAST* ast, NodeRef r, Arena* arena) {
+    if (r == COMPACT_NONE) return NULL;
+    int line = (int)ast->positions[r].line;
+    int col = (int)ast->positions[r].column;
+    uint32_t a = ast->a[r], b = ast->b[r], c = ast->c[r];
+
+    switch ((ASTNodeType)ast->kinds[r]) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = ast_new_var_decl(arena, (int)a, expand(ast, b, arena), line, col);
+            n->value_type = (ValueType)ast->extra[c];
+            n->slot = (int)ast->extra[c + 1];
+            return (ASTNode*)n;
+        }
+        case AST_FN_DECL:
+            return (ASTNode*)expand_fn(ast, r, expand(ast, b, arena), arena);
+        case AST_BLOCK:
+            return (ASTNode*)ast_new_block(arena, expand_list(ast, b, c, arena), line, col);
+        case AST_IF_STMT:
+            return (ASTNode*)ast_new_if_stmt(arena, expand(ast, a, arena), expand(ast, b, arena),
+                                             expand(ast, c, arena), line, col);
+        case AST_WHILE_STMT:
+            return (ASTNode*)ast_new_while_stmt(arena, expand(ast, a, arena), expand(ast, b, arena), line, col);
+        case AST_FOR_STMT:
+            return (ASTNode*)ast_new_for_stmt(arena, expand(ast, a, arena), expand(ast, b, arena),
+                                              expand(ast, ast->extra[c], arena),
+                                              expand(ast, ast->extra[c + 1], arena), line, col);
+        case AST_RETURN_STMT:
+            return (ASTNode*)ast_new_return_stmt(arena, expand(ast, a, arena), line, col);
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR: {
+            ASTNode* operand = expand(ast, a, arena);
+            ASTPrintStmt* n;
+            switch ((ASTNodeType)ast->kinds[r]) {
+                case AST_PRINT_STMT: n = ast_new_print_stmt(arena, operand, line, col); break;
+                case AST_INPUT_EXPR: n = (ASTPrintStmt*)ast_new_input_expr(arena, operand, line, col); break;
+                case AST_ISNUMBER_EXPR: n = (ASTPrintStmt*)ast_new_isnumber_expr(arena, operand, line, col); break;
+                default: n = (ASTPrintStmt*)ast_new_isstring_expr(arena, operand, line, col); break;
+            }
+            n->value_type = (ValueType)b;
+            return (ASTNode*)n;
+        }
+        case AST_EXIT_STMT:
+            return ast_new_exit_stmt(arena, expand(ast, a, arena), line, col);
+        case AST_ABS_EXPR:
+            return ast_new_abs_expr(arena, expand(ast, a, arena), line, col);
+        case AST_GROUPING_EXPR:
+            return (ASTNode*)ast_new_grouping_expr(arena, expand(ast, a, arena), line, col);
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* n = ast_new_assign_stmt(arena, (int)a, expand(ast, b, arena),
+                                                   (TokenType)ast->ops[r], line, col);
+            n->slot = (int)c;
+            return (ASTNode*)n;
+        }
+        case AST_CALL_STMT:
+            return (ASTNode*)ast_new_call_stmt(arena, (int)a, expand_args(ast, r, arena),
+                                               (int)c, line, col);
+        case AST_CALL_EXPR: {
+            ASTCallExpr* n = ast_new_call_expr(arena, (int)a, expand_args(ast, r, arena), (int)c, line, col);
+            n->value_type = (ValueType)ast->ops[r];
+            return (ASTNode*)n;
+        }
+        case AST_BINARY_EXPR: {
+            ASTNode* left = expand(ast, a, arena);
+            ASTNode* right = expand(ast, b, arena);
+            ASTBinaryExpr* n = ast_new_binary_expr(arena, left, (TokenType)ast->ops[r], right, line, col);
+            n->operand_type = (ValueType)c;
+            return (ASTNode*)n;
+        }
+        case AST_UNARY_EXPR:
+            return (ASTNode*)ast_new_unary_expr(arena, (TokenType)ast->ops[r], expand(ast, a, arena), line, col);
+        case AST_INT_LITERAL:
+            return (ASTNode*)ast_new_int_literal(arena, (int)a, line, col);
+        case AST_BOOL_LITERAL:
+            return (ASTNode*)ast_new_bool_literal(arena, (int)a, line, col);
+        case AST_STRING_LITERAL:
+            return (ASTNode*)ast_new_string_literal(arena, ast->strings + a, (int)b, line, col);
+        case AST_IDENTIFIER: {
+            ASTIdentifier* n = ast_new_identifier(arena, (int)a, line, col);
+            n->slot = (int)b;
+            return (ASTNode*)n;
+        }
+        case AST_INLINE_EXPR: {
+            ASTNode* statements = expand_list(ast, b, c, arena);
+            return (ASTNode*)ast_new_inline_expr(arena, statements, expand(ast, a, arena), line, col);
+        }
+        case AST_PROGRAM:
+            break;
+    }
+    return NULL;
+}
+
+ASTNode* compact_expand(const CompactAST* ast, NodeRef node, Arena* arena) {
+    return expand(ast, node, arena);
+}
+
+void compact_generate_c_code(const CompactAST* ast, FILE* out) {
+    Arena scratch;
+    arena_init(&scratch, "expand", EXPAND_ARENA_CHUNK);
+
+    codegen_emit_header(out);
+
+    // Protótipos só precisam do cabeçalho da função, sem o corpo.
+    for (uint32_t i = 0; i < ast->decl_count; i++) {
+        NodeRef r = ast->decls[i];
+        if (ast->kinds[r] != AST_FN_DECL) continue;
+        codegen_emit_prototype((ASTNode*)expand_fn(ast, r, NULL, &scratch), ast->names, out);
+        arena_reset(&scratch);
+    }
+    fprintf(out, "\n");
+
+    for (uint32_t i = 0; i < ast->decl_count; i++) {
+        NodeRef r = ast->decls[i];
+        if (ast->kinds[r] != AST_FN_DECL) continue;
+        codegen_emit_function(expand(ast, r, &scratch), ast->names, out);
+        arena_reset(&scratch);
+    }
+
+    codegen_emit_main_begin(out);
+    for (uint32_t i = 0; i < ast->decl_count; i++) {
+        NodeRef r = ast->decls[i];
+        if (ast->kinds[r] == AST_FN_DECL) continue;
+        codegen_emit_main_statement(expand(ast, r, &scratch), ast->names, out);
+        arena_reset(&scratch);
+    }
+    codegen_emit_main_end(out);
+
+    arena_release(&scratch);
+}
@@ -0,0 +1,126 @@
+#ifndef COMPACT_AST_H
+#define COMPACT_AST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ast.h"
+#include "arena.h"
+#include "symbol.h"
+#include "parser_v2.h"
+#include "pass.h"
+
+// AST compacta: os nós ficam em arrays paralelos (struct of arrays) e se
+// referenciam por índices de 32 bits. Listas de filhos são faixas contíguas
+// em extra[], e as posições no source ficam numa tabela à parte, que só é
+// lida por quem precisa de diagnósticos.
+//
+// O índice 0 é reservado: COMPACT_NONE indica filho ausente.
+//
+// Campos a, b e c por tipo de nó ("faixa" = início em extra[] e tamanho):
+//   VAR_DECL        a = nome, b = inicializador, c = início em extra[] de
+//                   { tipo (ValueType), slot }
+//   FN_DECL         a = nome, b = corpo, c = início em extra[] de
+//                   { n, param_1 .. param_n (nomes), tipo_1 .. tipo_n,
+//                   tipo do retorno }, op = bits COMPACT_FN_*
+//   BLOCK           b, c = faixa de comandos
+//   IF_STMT         a = condição, b = then, c = else
+//   WHILE_STMT      a = condição, b = corpo
+//   FOR_STMT        a = inicialização, b = condição, c = início em extra[]
+//                   de { incremento, corpo }
+//   PRINT, INPUT, ISNUMBER, ISSTRING
+//                   a = expressão, b = tipo da expressão
+//   RETURN, EXIT, ABS, GROUPING
+//                   a = expressão
+//   ASSIGN_STMT     a = nome, b = valor, c = slot, op = operador de
+//                   atribuição
+//   CALL_STMT/EXPR  a = nome, b, c = faixa de argumentos, op = tipo do
+//                   resultado (só CALL_EXPR)
+//   BINARY_EXPR     a = esquerda, b = direita, c = tipo dos operandos,
+//                   op = operador
+//   UNARY_EXPR      a = operando, op = operador
+//   INT_LITERAL     a = valor (bits do int)
+//   BOOL_LITERAL    a = valor
+//   STRING_LITERAL  a = início em strings[], b = tamanho
+//   IDENTIFIER      a = nome, b = slot
+//   INLINE_EXPR     a = resultado, b, c = faixa de comandos
+// Nomes são os mesmos ids da AST de ponteiros, na tabela names (que não
+// pertence à AST compacta). O programa é a lista decls[], na ordem do
+// arquivo.
+#define COMPACT_NONE 0
+
+// ops de FN_DECL: @memo no source e cache decidido por memo.h.
+#define COMPACT_FN_MEMO 1
+#define COMPACT_FN_MEMOIZED 2
+
+typedef uint32_t NodeRef;
+
+typedef struct {
+    uint32_t line;
+    uint32_t column;
+} CompactPos;
+
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+    uint8_t* kinds;         // ASTNodeType
+    uint8_t* ops;           // TokenType; ValueType em CALL_EXPR, bits em FN_DECL
+    uint32_t* a;
+    uint32_t* b;
+    uint32_t* c;
+    CompactPos* positions;
+
+    uint32_t* extra;
+    uint32_t extra_count;
+    uint32_t extra_capacity;
+
+    char* strings;          // literais, cada um terminado em '\0'
+    uint32_t strings_length;
+    uint32_t strings_capacity;
+
+    NodeRef* decls;
+    uint32_t decl_count;
+    uint32_t decl_capacity;
+
+    SymbolTable* names;     // compartilhada, não é liberada por compact_free
+
+    // Quando image != NULL os arrays apontam para dentro de uma imagem
+    // externa (um .lamoc mapeado, por exemplo) e são somente leitura;
+    // compact_free chama release(image, image_size) em vez de free.
+    void* image;
+    size_t image_size;
+    void (*release)(void* image, size_t size);
+} CompactAST;
+
+CompactAST* compact_new(SymbolTable* names);
+void compact_free(CompactAST* ast);
+size_t compact_bytes(const CompactAST* ast);
+void compact_shrink(CompactAST* ast);
+int compact_validate(const CompactAST* ast);
+
+// Construção a partir da AST de ponteiros: uma declaração de nível superior
+// por vez, ou o programa inteiro. compact_shrink pode ser chamada ao final
+// de uma sequência de compact_append; as outras duas já a chamam.
+NodeRef compact_append(CompactAST* ast, ASTNode* decl);
+CompactAST* compact_from_program(ASTProgram* program, SymbolTable* names);
+
+// Parseia declaração a declaração, convertendo cada uma e reiniciando a
+// arena do parser; a AST de ponteiros nunca existe inteira na memória.
+// passes (opcional) roda sobre cada declaração antes da conversão; os que
+// precisam do programa inteiro (inline.h, consteval.h e a remoção de
+// funções de dce.h) não agem, então o C gerado difere do de -j.
+CompactAST* compact_parse_program(Parser* p, PassManager* passes);
+
+// Filhos de um nó na ordem do source (nomes e literais não contam).
+int compact_child_count(const CompactAST* ast, NodeRef node);
+NodeRef compact_child(const CompactAST* ast, NodeRef node, int index);
+const char* compact_name(const CompactAST* ast, uint32_t name);
+
+// Adaptador: reconstrói a subárvore de ponteiros de um nó na arena dada,
+// para que código escrito sobre ast.h rode sobre a forma compacta.
+ASTNode* compact_expand(const CompactAST* ast, NodeRef node, Arena* arena);
+
+// generate_c_code sobre a forma compacta, expandindo uma declaração de
+// nível superior por vez numa arena temporária.
+void compact_generate_c_code(const CompactAST* ast, FILE* out);
+
+#endif
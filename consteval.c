@@ -0,0 +1,537 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "consteval.h"
+
+// Resultado de um comando.
+typedef enum {
+    EXEC_NEXT,
+    EXEC_RETURN,
+    EXEC_FAIL
+} ExecResult;
+
+struct ConstEval {
+    int active;         // percorrendo um AST_PROGRAM
+
+    // Funções já percorridas por todos os passes, por id de nome; NULL
+    // também para nomes repetidos (erro do resolvedor).
+    ASTFnDecl** functions;
+    unsigned char* repeated;
+    int function_capacity;
+
+    // Chamadas a funções ainda não percorridas, avaliadas no end.
+    ASTNode** pending;
+    int pending_count;
+    int pending_capacity;
+
+    // Slots de todos os frames em execução; um frame começa em base.
+    int* stack;
+    int sp;
+    int stack_capacity;
+    int depth;
+
+    // Slots declarados dentro de uma expansão de inline.h.
+    unsigned char* declared;
+    int declared_capacity;
+    int frame;          // maior slot usado mais um
+
+    int fuel;           // por chamada avaliada
+    long left;          // passos restantes desta chamada
+    long budget;        // passos restantes no programa
+    int checked;        // --check-overflow: estouro falha a avaliação
+
+    ConstEvalStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow ConstEval");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+ConstEval* consteval_new(int fuel, int checked) {
+    ConstEval* c = calloc(1, sizeof(ConstEval));
+    if (!c) {
+        perror("Failed to allocate ConstEval");
+        exit(EXIT_FAILURE);
+    }
+    c->fuel = fuel;
+    c->checked = checked;
+    c->budget = CONSTEVAL_BUDGET;
+    return c;
+}
+
+void consteval_free(ConstEval* c) {
+    if (!c) return;
+    free(c->functions);
+    free(c->repeated);
+    free(c->pending);
+    free(c->stack);
+    free(c->declared);
+    free(c);
+}
+
+const ConstEvalStats* consteval_stats(const ConstEval* c) {
+    return &c->stats;
+}
+
+static int wrap(int64_t v) {
+    return (int)(uint32_t)(uint64_t)v;
+}
+
+// 1 se o resultado foi para *out. Com checked, um resultado fora do int
+// estouraria em tempo de execução: a chamada fica para lá.
+static int arith(const ConstEval* c, int64_t v, int* out) {
+    if (c->checked && (v < INT_MIN || v > INT_MAX)) return 0;
+    *out = wrap(v);
+    return 1;
+}
+
+static ASTFnDecl* function(const ConstEval* c, int name) {
+    return name >= 0 && name < c->function_capacity ? c->functions[name] : NULL;
+}
+
+static void add_function(ConstEval* c, ASTFnDecl* fn) {
+    int old = c->function_capacity;
+    c->functions = grow(c->functions, &c->function_capacity, fn->name + 1, sizeof(ASTFnDecl*));
+    int capacity = old;
+    c->repeated = grow(c->repeated, &capacity, fn->name + 1, 1);
+    for (int i = old; i < c->function_capacity; i++) {
+        c->functions[i] = NULL;
+        c->repeated[i] = 0;
+    }
+    if (c->functions[fn->name] || c->repeated[fn->name]) {
+        c->functions[fn->name] = NULL;
+        c->repeated[fn->name] = 1;
+        return;
+    }
+    c->functions[fn->name] = fn;
+}
+
+static int step(ConstEval* c) {
+    if (c->left == 0 || c->budget == 0) return 0;
+    c->left--;
+    c->budget--;
+    c->stats.steps++;
+    return 1;
+}
+
+// Slot de um frame; base -1 é o nível de uma chamada constante, sem
+// variáveis.
+static int* slot_ref(ConstEval* c, int base, int size, int slot) {
+    if (base < 0 || slot < 0 || slot >= size) return NULL;
+    return &c->stack[base + slot];
+}
+
+static int eval(ConstEval* c, ASTNode* node, int base, int size, int* out);
+static ExecResult exec_list(ConstEval* c, ASTNode* stmt, int base, int size, int* ret);
+
+// Os argumentos vão direto para os primeiros slots do frame novo, que fica
+// reservado enquanto são avaliados (podem chamar outras funções).
+static int call(ConstEval* c, ASTCallExpr* node, int base, int size, int* out) {
+    ASTFnDecl* fn = function(c, node->name);
+    if (!fn || fn->base.type != AST_FN_DECL || fn->param_count != node->arg_count ||
+        fn->frame_size < fn->param_count || c->depth == CONSTEVAL_DEPTH) {
+        return 0;
+    }
+    int frame = c->sp;
+    c->stack = grow(c->stack, &c->stack_capacity, frame + fn->frame_size, sizeof(int));
+    c->sp = frame + fn->frame_size;
+    memset(c->stack + frame, 0, sizeof(int) * (size_t)fn->frame_size);
+    int ok = 1;
+    for (int i = 0; ok && i < node->arg_count; i++) {
+        int value;
+        ok = eval(c, node->args[i], base, size, &value);
+        if (ok) c->stack[frame + i] = value;
+    }
+    int result = 0;
+    if (ok) {
+        c->depth++;
+        ExecResult r = exec_list(c, fn->body, frame, fn->frame_size, &result);
+        c->depth--;
+        ok = r != EXEC_FAIL;
+    }
+    c->sp = frame;
+    *out = result;
+    return ok;
+}
+
+static int eval_binary(ConstEval* c, ASTBinaryExpr* node, int base, int size, int* out) {
+    int a, b;
+    if (!eval(c, node->left, base, size, &a)) return 0;
+    if (node->operator == TOKEN_AND_AND || node->operator == TOKEN_OR_OR) {
+        int is_and = node->operator == TOKEN_AND_AND;
+        if (is_and ? !a : a) {
+            *out = !is_and;
+            return 1;
+        }
+        if (!eval(c, node->right, base, size, &b)) return 0;
+        *out = b != 0;
+        return 1;
+    }
+    if (!eval(c, node->right, base, size, &b)) return 0;
+    int64_t x = a, y = b;
+    switch (node->operator) {
+        case TOKEN_PLUS: return arith(c, x + y, out);
+        case TOKEN_MINUS: return arith(c, x - y, out);
+        case TOKEN_STAR: return arith(c, x * y, out);
+        case TOKEN_SLASH:
+        case TOKEN_PERCENT:
+            // Falha em tempo de execução: continua lá.
+            if (b == 0 || (a == INT_MIN && b == -1)) return 0;
+            *out = node->operator == TOKEN_SLASH ? a / b : a % b;
+            return 1;
+        case TOKEN_EQ_EQ: *out = a == b; return 1;
+        case TOKEN_BANG_EQ: *out = a != b; return 1;
+        case TOKEN_LT: *out = a < b; return 1;
+        case TOKEN_GT: *out = a > b; return 1;
+        case TOKEN_LT_EQ: *out = a <= b; return 1;
+        case TOKEN_GT_EQ: *out = a >= b; return 1;
+        default: return 0;
+    }
+}
+
+// 1 se a expressão tem valor inteiro em *out; strings e efeitos falham.
+static int eval(ConstEval* c, ASTNode* node, int base, int size, int* out) {
+    if (!node || !step(c)) return 0;
+    switch (node->type) {
+        case AST_INT_LITERAL:
+            *out = ((ASTIntLiteral*)node)->value;
+            return 1;
+        case AST_BOOL_LITERAL:
+            *out = ((ASTBoolLiteral*)node)->value;
+            return 1;
+        case AST_IDENTIFIER: {
+            int* ref = slot_ref(c, base, size, ((ASTIdentifier*)node)->slot);
+            if (!ref) return 0;
+            *out = *ref;
+            return 1;
+        }
+        case AST_GROUPING_EXPR:
+            return eval(c, ((ASTGroupingExpr*)node)->expression, base, size, out);
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* n = (ASTUnaryExpr*)node;
+            int v;
+            if (!eval(c, n->right, base, size, &v)) return 0;
+            if (n->operator == TOKEN_MINUS) return arith(c, -(int64_t)v, out);
+            if (n->operator != TOKEN_BANG) return 0;
+            *out = !v;
+            return 1;
+        }
+        case AST_BINARY_EXPR:
+            return eval_binary(c, (ASTBinaryExpr*)node, base, size, out);
+        case AST_ABS_EXPR: {
+            int v;
+            if (!eval(c, ((ASTPrintStmt*)node)->expression, base, size, &v)) return 0;
+            if (v == INT_MIN) return arith(c, -(int64_t)v, out);
+            *out = v < 0 ? -v : v;
+            return 1;
+        }
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR: {
+            // Todo valor que o interpretador alcança é um inteiro.
+            int v;
+            if (!eval(c, ((ASTPrintStmt*)node)->expression, base, size, &v)) return 0;
+            *out = node->type == AST_ISNUMBER_EXPR;
+            return 1;
+        }
+        case AST_CALL_EXPR:
+            return call(c, (ASTCallExpr*)node, base, size, out);
+        case AST_INLINE_EXPR: {
+            ASTInlineExpr* n = (ASTInlineExpr*)node;
+            int ignored;
+            if (exec_list(c, n->statements, base, size, &ignored) != EXEC_NEXT) return 0;
+            return eval(c, n->result, base, size, out);
+        }
+        default:
+            return 0;
+    }
+}
+
+static ExecResult exec(ConstEval* c, ASTNode* node, int base, int size, int* ret) {
+    if (!step(c)) return EXEC_FAIL;
+    int v;
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = (ASTVarDecl*)node;
+            int* ref = slot_ref(c, base, size, n->slot);
+            if (!ref || !eval(c, n->initializer, base, size, &v)) return EXEC_FAIL;
+            // A pilha pode ter crescido durante a avaliação.
+            c->stack[base + n->slot] = v;
+            return EXEC_NEXT;
+        }
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* n = (ASTAssignStmt*)node;
+            if (!slot_ref(c, base, size, n->slot) || !eval(c, n->value, base, size, &v)) return EXEC_FAIL;
+            int* ref = &c->stack[base + n->slot];
+            if (n->op_type == TOKEN_PLUS_EQ) return arith(c, (int64_t)*ref + v, ref) ? EXEC_NEXT : EXEC_FAIL;
+            if (n->op_type == TOKEN_MINUS_EQ) return arith(c, (int64_t)*ref - v, ref) ? EXEC_NEXT : EXEC_FAIL;
+            *ref = v;
+            return EXEC_NEXT;
+        }
+        case AST_BLOCK:
+            return exec_list(c, ((ASTBlock*)node)->statements, base, size, ret);
+        case AST_IF_STMT: {
+            ASTIfStmt* n = (ASTIfStmt*)node;
+            if (!eval(c, n->condition, base, size, &v)) return EXEC_FAIL;
+            ASTNode* branch = v ? n->then_branch : n->else_branch;
+            return branch ? exec(c, branch, base, size, ret) : EXEC_NEXT;
+        }
+        case AST_WHILE_STMT: {
+            ASTWhileStmt* n = (ASTWhileStmt*)node;
+            for (;;) {
+                if (!eval(c, n->condition, base, size, &v)) return EXEC_FAIL;
+                if (!v) return EXEC_NEXT;
+                ExecResult r = exec(c, n->body, base, size, ret);
+                if (r != EXEC_NEXT) return r;
+            }
+        }
+        case AST_FOR_STMT: {
+            ASTForStmt* n = (ASTForStmt*)node;
+            if (n->initializer && exec(c, n->initializer, base, size, ret) != EXEC_NEXT) return EXEC_FAIL;
+            for (;;) {
+                v = 1;
+                if (n->condition && !eval(c, n->condition, base, size, &v)) return EXEC_FAIL;
+                if (!v) return EXEC_NEXT;
+                ExecResult r = exec(c, n->body, base, size, ret);
+                if (r != EXEC_NEXT) return r;
+                if (n->increment && exec(c, n->increment, base, size, ret) != EXEC_NEXT) return EXEC_FAIL;
+            }
+        }
+        case AST_RETURN_STMT: {
+            ASTNode* e = ((ASTReturnStmt*)node)->expression;
+            v = 0;
+            if (e && !eval(c, e, base, size, &v)) return EXEC_FAIL;
+            *ret = v;
+            return EXEC_RETURN;
+        }
+        case AST_CALL_STMT:
+            return call(c, (ASTCallExpr*)node, base, size, &v) ? EXEC_NEXT : EXEC_FAIL;
+        default:
+            // print, exit e o que mais tiver efeito.
+            return EXEC_FAIL;
+    }
+}
+
+// Sem return, o corpo de uma função devolve 0, como no C gerado.
+static ExecResult exec_list(ConstEval* c, ASTNode* stmt, int base, int size, int* ret) {
+    for (; stmt; stmt = stmt->next) {
+        ExecResult r = exec(c, stmt, base, size, ret);
+        if (r != EXEC_NEXT) return r;
+    }
+    *ret = 0;
+    return EXEC_NEXT;
+}
+
+// Expressão sem variáveis nem efeitos fora das chamadas, que o
+// interpretador decide.
+static int constant(const ASTNode* node) {
+    switch (node->type) {
+        case AST_INT_LITERAL:
+        case AST_BOOL_LITERAL:
+            return 1;
+        case AST_GROUPING_EXPR:
+            return constant(((const ASTGroupingExpr*)node)->expression);
+        case AST_UNARY_EXPR:
+            return constant(((const ASTUnaryExpr*)node)->right);
+        case AST_BINARY_EXPR:
+            return constant(((const ASTBinaryExpr*)node)->left) && constant(((const ASTBinaryExpr*)node)->right);
+        case AST_ABS_EXPR:
+            return constant(((const ASTPrintStmt*)node)->expression);
+        case AST_CALL_EXPR: {
+            const ASTCallExpr* n = (const ASTCallExpr*)node;
+            for (int i = 0; i < n->arg_count; i++) {
+                if (!constant(n->args[i])) return 0;
+            }
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static void declare(ConstEval* c, int slot) {
+    if (slot < 0) return;
+    int old = c->declared_capacity;
+    c->declared = grow(c->declared, &c->declared_capacity, slot + 1, 1);
+    if (c->declared_capacity > old) memset(c->declared + old, 0, (size_t)(c->declared_capacity - old));
+    c->declared[slot] = 1;
+    if (slot >= c->frame) c->frame = slot + 1;
+}
+
+static int slots_list(ConstEval* c, ASTNode* node, int check);
+
+// Na primeira passada (check 0) marca os slots declarados; na segunda,
+// confere que todo slot lido ou escrito é um deles.
+static int slots(ConstEval* c, ASTNode* node, int check) {
+    if (!node) return 1;
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = (ASTVarDecl*)node;
+            if (!check) declare(c, n->slot);
+            return slots(c, n->initializer, check);
+        }
+        case AST_IDENTIFIER:
+        case AST_ASSIGN_STMT: {
+            int slot = node->type == AST_IDENTIFIER ? ((ASTIdentifier*)node)->slot : ((ASTAssignStmt*)node)->slot;
+            if (check && (slot < 0 || slot >= c->declared_capacity || !c->declared[slot])) return 0;
+            return node->type == AST_IDENTIFIER || slots(c, ((ASTAssignStmt*)node)->value, check);
+        }
+        case AST_BLOCK:
+            return slots_list(c, ((ASTBlock*)node)->statements, check);
+        case AST_IF_STMT: {
+            ASTIfStmt* n = (ASTIfStmt*)node;
+            return slots(c, n->condition, check) && slots(c, n->then_branch, check) && slots(c, n->else_branch, check);
+        }
+        case AST_WHILE_STMT:
+            return slots(c, ((ASTWhileStmt*)node)->condition, check) && slots(c, ((ASTWhileStmt*)node)->body, check);
+        case AST_FOR_STMT: {
+            ASTForStmt* n = (ASTForStmt*)node;
+            return slots(c, n->initializer, check) && slots(c, n->condition, check) &&
+                   slots(c, n->increment, check) && slots(c, n->body, check);
+        }
+        case AST_RETURN_STMT:
+            return slots(c, ((ASTReturnStmt*)node)->expression, check);
+        case AST_ABS_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+            return slots(c, ((ASTPrintStmt*)node)->expression, check);
+        case AST_CALL_EXPR:
+        case AST_CALL_STMT: {
+            ASTCallExpr* n = (ASTCallExpr*)node;
+            for (int i = 0; i < n->arg_count; i++) {
+                if (!slots(c, n->args[i], check)) return 0;
+            }
+            return 1;
+        }
+        case AST_BINARY_EXPR:
+            return slots(c, ((ASTBinaryExpr*)node)->left, check) && slots(c, ((ASTBinaryExpr*)node)->right, check);
+        case AST_UNARY_EXPR:
+            return slots(c, ((ASTUnaryExpr*)node)->right, check);
+        case AST_GROUPING_EXPR:
+            return slots(c, ((ASTGroupingExpr*)node)->expression, check);
+        case AST_INLINE_EXPR:
+            return slots_list(c, ((ASTInlineExpr*)node)->statements, check) &&
+                   slots(c, ((ASTInlineExpr*)node)->result, check);
+        case AST_INT_LITERAL:
+        case AST_BOOL_LITERAL:
+            return 1;
+        default:
+            // print, input, exit, strings: o interpretador recusaria.
+            return 0;
+    }
+}
+
+static int slots_list(ConstEval* c, ASTNode* node, int check) {
+    for (; node; node = node->next) {
+        if (!slots(c, node, check)) return 0;
+    }
+    return 1;
+}
+
+static void rewrite(ConstEval* c, ASTNode* node, ValueType type, int value) {
+    if (type == TYPE_BOOL) {
+        node->type = AST_BOOL_LITERAL;
+        ((ASTBoolLiteral*)node)->value = value;
+    } else {
+        node->type = AST_INT_LITERAL;
+        ((ASTIntLiteral*)node)->value = value;
+    }
+    c->stats.calls++;
+}
+
+// Avalia uma chamada de argumentos constantes, fora de qualquer frame, e a
+// reescreve no lugar como literal do tipo que o typer deu a ela.
+static void try_call(ConstEval* c, ASTNode* node) {
+    ASTCallExpr* call_expr = (ASTCallExpr*)node;
+    if (call_expr->value_type == TYPE_STRING || !constant(node)) return;
+    c->left = c->fuel;
+    c->sp = 0;
+    c->depth = 0;
+    int value;
+    if (!call(c, call_expr, -1, 0, &value) ||
+        (call_expr->value_type == TYPE_BOOL && value != 0 && value != 1)) {
+        c->stats.failed++;
+        return;
+    }
+    rewrite(c, node, call_expr->value_type, value);
+}
+
+// Uma chamada expandida por inline.h só enxerga os próprios slots (os
+// parâmetros viram let): se nada de fora é lido nem escrito, ela roda num
+// frame só dela, do tamanho do maior desses slots.
+static void try_inline(ConstEval* c, ASTNode* node) {
+    if (c->declared_capacity > 0) memset(c->declared, 0, (size_t)c->declared_capacity);
+    c->frame = 0;
+    slots(c, node, 0);
+    if (!slots(c, node, 1)) return;
+    c->left = c->fuel;
+    c->depth = 0;
+    c->stack = grow(c->stack, &c->stack_capacity, c->frame, sizeof(int));
+    c->sp = c->frame;
+    memset(c->stack, 0, sizeof(int) * (size_t)c->frame);
+    int value;
+    int ok = eval(c, node, 0, c->frame, &value);
+    c->sp = 0;
+    if (!ok) {
+        c->stats.failed++;
+        return;
+    }
+    rewrite(c, node, TYPE_INT, value);
+}
+
+static void enter(ASTNode* node, void* state) {
+    ConstEval* c = state;
+    if (node->type == AST_PROGRAM) c->active = 1;
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    ConstEval* c = state;
+    if (!c->active) return node;
+    if (node->type == AST_FN_DECL) {
+        add_function(c, (ASTFnDecl*)node);
+    } else if (node->type == AST_INLINE_EXPR) {
+        try_inline(c, node);
+    } else if (node->type == AST_CALL_EXPR) {
+        int name = ((ASTCallExpr*)node)->name;
+        if (function(c, name)) {
+            try_call(c, node);
+        } else if (name < 0 || name >= c->function_capacity || !c->repeated[name]) {
+            c->pending = grow(c->pending, &c->pending_capacity, c->pending_count + 1, sizeof(ASTNode*));
+            c->pending[c->pending_count++] = node;
+        }
+    }
+    return node;
+}
+
+static void end(void* state) {
+    ConstEval* c = state;
+    for (int i = 0; i < c->pending_count; i++) {
+        ASTNode* node = c->pending[i];
+        if (node->type == AST_CALL_EXPR && function(c, ((ASTCallExpr*)node)->name)) try_call(c, node);
+    }
+    c->pending_count = 0;
+    c->active = 0;
+    memset(c->functions, 0, sizeof(ASTFnDecl*) * (size_t)c->function_capacity);
+    if (c->function_capacity > 0) memset(c->repeated, 0, (size_t)c->function_capacity);
+}
+
+Pass consteval_pass(ConstEval* c) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "consteval";
+    pass.state = c;
+    pass.enter = enter;
+    pass.leave = leave;
+    pass.end = end;
+    return pass;
+}
@@ -0,0 +1,48 @@
+#ifndef CONSTEVAL_H
+#define CONSTEVAL_H
+
+#include "ast.h"
+#include "pass.h"
+
+// Passos (nós visitados) por chamada avaliada, no programa inteiro, e
+// chamadas aninhadas.
+#define CONSTEVAL_FUEL 1000000
+#define CONSTEVAL_BUDGET 50000000
+#define CONSTEVAL_DEPTH 256
+
+// Avaliação de chamadas em tempo de compilação, como o constexpr do C++.
+//
+// Uma chamada cujos argumentos são todos constantes (expressões sem
+// variáveis) é executada por um interpretador do subconjunto puro da
+// linguagem, sobre a AST resolvida: variáveis são slots de um frame por
+// chamada. Se a execução termina com um inteiro, a chamada é reescrita no
+// lugar como um ASTIntLiteral, e os passes seguintes (e a dobra, nos nós
+// de cima) a tratam como qualquer literal. A chamada fica como está quando
+// a execução encontra print, input, exit, uma string, uma divisão que
+// falharia em tempo de execução, ou passa de fuel passos ou de
+// CONSTEVAL_DEPTH chamadas aninhadas; o orçamento do programa inteiro
+// (CONSTEVAL_BUDGET) limita o tempo de compilação. A aritmética é a do int
+// de 32 bits do C gerado, como em fold.h; com checked (--check-overflow),
+// um estouro também deixa a chamada para o tempo de execução.
+//
+// Chamadas a funções já percorridas são avaliadas no leave, logo depois da
+// dobra dos argumentos; as demais (a função vem depois no arquivo ou é a
+// própria), no end. Depende dos slots do resolvedor e da dobra, então o
+// passe é registrado depois deles e antes da eliminação de código morto,
+// que remove as funções que deixaram de ser chamadas. Como inline.h, só
+// age sobre o programa inteiro: nos modos streaming e compacto as funções
+// já geradas não estão mais na memória.
+typedef struct {
+    int calls;          // chamadas trocadas por literais
+    int failed;         // chamadas com argumentos constantes não avaliadas
+    long steps;         // passos do interpretador
+} ConstEvalStats;
+
+typedef struct ConstEval ConstEval;
+
+ConstEval* consteval_new(int fuel, int checked);
+void consteval_free(ConstEval* c);
+Pass consteval_pass(ConstEval* c);
+const ConstEvalStats* consteval_stats(const ConstEval* c);
+
+#endif
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "context.h"
+#include "lexer_v2.h"
+
+#define AST_ARENA_CHUNK (1u << 20)
+
+CompileContext* context_new(void) {
+    CompileContext* ctx = calloc(1, sizeof(CompileContext));
+    if (!ctx) {
+        perror("Failed to allocate CompileContext");
+        exit(EXIT_FAILURE);
+    }
+    ctx->symbols = lexer_new_symbols();
+    return ctx;
+}
+
+Arena* context_new_arena(CompileContext* ctx, const char* name) {
+    if (ctx->arena_count == ctx->arena_capacity) {
+        ctx->arena_capacity = ctx->arena_capacity ? ctx->arena_capacity * 2 : 4;
+        ctx->arenas = realloc(ctx->arenas, sizeof(Arena*) * ctx->arena_capacity);
+        if (!ctx->arenas) {
+            perror("Failed to grow CompileContext");
+            exit(EXIT_FAILURE);
+        }
+    }
+    Arena* a = malloc(sizeof(Arena));
+    if (!a) {
+        perror("Failed to allocate Arena");
+        exit(EXIT_FAILURE);
+    }
+    arena_init(a, name, AST_ARENA_CHUNK);
+    ctx->arenas[ctx->arena_count++] = a;
+    return a;
+}
+
+// Uma linha por arena. "pico" difere de "usado" só em arenas que foram
+// reiniciadas durante a compilação (modo streaming).
+void context_report(const CompileContext* ctx, FILE* out) {
+    long nodes = 0, allocations = 0;
+    size_t used = 0, peak = 0, reserved = 0;
+    fprintf(out, "%-3s %-10s %10s %11s %12s %12s %12s\n",
+            "#", "arena", "nós", "alocações", "usado", "pico", "reservado");
+    for (int i = 0; i < ctx->arena_count; i++) {
+        const Arena* a = ctx->arenas[i];
+        size_t a_peak = a->used > a->peak ? a->used : a->peak;
+        fprintf(out, "%-3d %-10s %10ld %11ld %12zu %12zu %12zu\n",
+                i, a->name, a->nodes, a->allocations, a->used, a_peak, a->reserved);
+        nodes += a->nodes;
+        allocations += a->allocations;
+        used += a->used;
+        peak += a_peak;
+        reserved += a->reserved;
+    }
+    fprintf(out, "%-3s %-10s %10ld %11ld %12zu %12zu %12zu\n",
+            "", "total", nodes, allocations, used, peak, reserved);
+    fprintf(out, "símbolos: %d nomes, %zu bytes\n",
+            symtab_count(ctx->symbols), symtab_bytes(ctx->symbols));
+}
+
+void context_free(CompileContext* ctx) {
+    if (!ctx) return;
+    for (int i = 0; i < ctx->arena_count; i++) {
+        arena_release(ctx->arenas[i]);
+        free(ctx->arenas[i]);
+    }
+    free(ctx->arenas);
+    symtab_free(ctx->symbols);
+    free(ctx);
+}
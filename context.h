@@ -0,0 +1,23 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdio.h>
+#include "arena.h"
+#include "symbol.h"
+
+// Estado de uma compilação. Toda a AST vive nas arenas do contexto, então
+// liberar o contexto libera a árvore inteira de uma vez. symbols é a tabela
+// única de nomes: lexer, parser, AST e codegen usam os mesmos ids.
+typedef struct {
+    SymbolTable* symbols;
+    Arena** arenas;
+    int arena_count;
+    int arena_capacity;
+} CompileContext;
+
+CompileContext* context_new(void);
+Arena* context_new_arena(CompileContext* ctx, const char* name);
+void context_report(const CompileContext* ctx, FILE* out);
+void context_free(CompileContext* ctx);
+
+#endif
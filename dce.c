@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "dce.h"
+
+struct DeadCode {
+    // Comandos já visitados que nunca terminam normalmente (tabela de
+    // ponteiros com endereçamento aberto). Só interessam dentro de uma
+    // função ou do main, então a tabela é limpa ao fim de cada função.
+    ASTNode** terminal;
+    int terminal_count;
+    int terminal_capacity;
+
+    // Grafo de chamadas, montado no leave do programa: funções por índice
+    // do resolvedor, as já alcançadas e as que falta percorrer.
+    ASTFnDecl** functions;
+    unsigned char* reached;
+    int function_capacity;
+    int* worklist;
+    int work_count;
+    int work_capacity;
+    // Alguma chamada ficou sem fn_index: nenhuma função é removida.
+    int unresolved;
+
+    // Percorre os corpos alcançados atrás de chamadas.
+    PassManager* scanner;
+
+    DceStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow DeadCode");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static size_t hash_node(const ASTNode* node, int capacity) {
+    uint64_t h = (uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h >> 32) & (size_t)(capacity - 1);
+}
+
+static int is_terminal(const DeadCode* d, const ASTNode* node) {
+    if (!node || d->terminal_count == 0) return 0;
+    size_t i = hash_node(node, d->terminal_capacity);
+    while (d->terminal[i]) {
+        if (d->terminal[i] == node) return 1;
+        i = (i + 1) & (size_t)(d->terminal_capacity - 1);
+    }
+    return 0;
+}
+
+static void insert_terminal(ASTNode** table, int capacity, ASTNode* node) {
+    size_t i = hash_node(node, capacity);
+    while (table[i]) {
+        if (table[i] == node) return;
+        i = (i + 1) & (size_t)(capacity - 1);
+    }
+    table[i] = node;
+}
+
+static void mark_terminal(DeadCode* d, ASTNode* node) {
+    if ((d->terminal_count + 1) * 2 > d->terminal_capacity) {
+        int capacity = d->terminal_capacity ? d->terminal_capacity * 2 : 64;
+        ASTNode** table = calloc((size_t)capacity, sizeof(ASTNode*));
+        if (!table) {
+            perror("Failed to grow DeadCode");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < d->terminal_capacity; i++) {
+            if (d->terminal[i]) insert_terminal(table, capacity, d->terminal[i]);
+        }
+        free(d->terminal);
+        d->terminal = table;
+        d->terminal_capacity = capacity;
+    }
+    insert_terminal(d->terminal, d->terminal_capacity, node);
+    d->terminal_count++;
+}
+
+static void clear_terminal(DeadCode* d) {
+    if (d->terminal_count == 0) return;
+    memset(d->terminal, 0, sizeof(ASTNode*) * d->terminal_capacity);
+    d->terminal_count = 0;
+}
+
+static void reach(DeadCode* d, int index) {
+    if (index < 0) {
+        d->unresolved = 1;
+        return;
+    }
+    if (index >= d->function_capacity || d->reached[index]) return;
+    d->reached[index] = 1;
+    d->worklist = grow(d->worklist, &d->work_capacity, d->work_count + 1, sizeof(int));
+    d->worklist[d->work_count++] = index;
+}
+
+static void scan_enter(ASTNode* node, void* state) {
+    if (node->type == AST_CALL_STMT || node->type == AST_CALL_EXPR) {
+        reach(state, ((ASTCallStmt*)node)->fn_index);
+    }
+}
+
+DeadCode* dce_new(void) {
+    DeadCode* d = calloc(1, sizeof(DeadCode));
+    if (!d) {
+        perror("Failed to allocate DeadCode");
+        exit(EXIT_FAILURE);
+    }
+    d->scanner = pass_manager_new();
+    Pass scan;
+    memset(&scan, 0, sizeof(scan));
+    scan.name = "dce/calls";
+    scan.state = d;
+    scan.enter = scan_enter;
+    pass_manager_add(d->scanner, &scan);
+    return d;
+}
+
+void dce_free(DeadCode* d) {
+    if (!d) return;
+    free(d->terminal);
+    free(d->functions);
+    free(d->reached);
+    free(d->worklist);
+    pass_manager_free(d->scanner);
+    free(d);
+}
+
+const DceStats* dce_stats(const DeadCode* d) {
+    return &d->stats;
+}
+
+static int literal_value(const ASTNode* node, int* value) {
+    if (node && node->type == AST_INT_LITERAL) {
+        *value = ((const ASTIntLiteral*)node)->value;
+        return 1;
+    }
+    if (node && node->type == AST_BOOL_LITERAL) {
+        *value = ((const ASTBoolLiteral*)node)->value;
+        return 1;
+    }
+    return 0;
+}
+
+// Corta o bloco depois do primeiro comando que não termina.
+static void prune_block(DeadCode* d, ASTBlock* block) {
+    for (ASTNode* stmt = block->statements; stmt; stmt = stmt->next) {
+        if (!is_terminal(d, stmt)) continue;
+        for (ASTNode* dead = stmt->next; dead; dead = dead->next) d->stats.statements++;
+        stmt->next = NULL;
+        mark_terminal(d, (ASTNode*)block);
+        return;
+    }
+}
+
+// Remove as funções que nenhuma instrução do nível superior alcança.
+static void prune_functions(DeadCode* d, ASTProgram* program) {
+    int count = 0;
+    for (ASTNode* decl = program->declarations; decl; decl = decl->next) {
+        if (decl->type == AST_FN_DECL && ((ASTFnDecl*)decl)->index >= count) {
+            count = ((ASTFnDecl*)decl)->index + 1;
+        }
+    }
+    if (count == 0) return;
+    int capacity = d->function_capacity;
+    d->functions = grow(d->functions, &capacity, count, sizeof(ASTFnDecl*));
+    capacity = d->function_capacity;
+    d->reached = grow(d->reached, &capacity, count, 1);
+    d->function_capacity = capacity;
+    memset(d->functions, 0, sizeof(ASTFnDecl*) * capacity);
+    memset(d->reached, 0, capacity);
+    d->work_count = 0;
+    d->unresolved = 0;
+
+    for (ASTNode* decl = program->declarations; decl; decl = decl->next) {
+        if (decl->type == AST_FN_DECL) {
+            ASTFnDecl* fn = (ASTFnDecl*)decl;
+            if (fn->index < 0) return;
+            d->functions[fn->index] = fn;
+        } else {
+            ASTNode* root = decl;
+            pass_manager_run_node(d->scanner, &root);
+        }
+    }
+    while (d->work_count > 0 && !d->unresolved) {
+        ASTFnDecl* fn = d->functions[d->worklist[--d->work_count]];
+        if (fn) pass_manager_run_node(d->scanner, &fn->body);
+    }
+    if (d->unresolved) return;
+
+    ASTNode** link = &program->declarations;
+    while (*link) {
+        ASTNode* decl = *link;
+        if (decl->type == AST_FN_DECL && !d->reached[((ASTFnDecl*)decl)->index]) {
+            *link = decl->next;
+            d->stats.functions++;
+        } else {
+            link = &decl->next;
+        }
+    }
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    DeadCode* d = state;
+    int v;
+    switch (node->type) {
+        case AST_RETURN_STMT:
+            mark_terminal(d, node);
+            return node;
+        case AST_BLOCK:
+            prune_block(d, (ASTBlock*)node);
+            return node;
+        case AST_IF_STMT: {
+            ASTIfStmt* stmt = (ASTIfStmt*)node;
+            if (literal_value(stmt->condition, &v)) {
+                d->stats.branches++;
+                return v ? stmt->then_branch : stmt->else_branch;
+            }
+            if (is_terminal(d, stmt->then_branch) && is_terminal(d, stmt->else_branch)) mark_terminal(d, node);
+            return node;
+        }
+        case AST_WHILE_STMT:
+            if (!literal_value(((ASTWhileStmt*)node)->condition, &v)) return node;
+            if (!v) {
+                d->stats.branches++;
+                return NULL;
+            }
+            mark_terminal(d, node);
+            return node;
+        case AST_FOR_STMT: {
+            ASTForStmt* stmt = (ASTForStmt*)node;
+            if (!literal_value(stmt->condition, &v)) return node;
+            if (v) {
+                mark_terminal(d, node);
+                return node;
+            }
+            // A inicialização ainda roda, no escopo do for: o nó vira um
+            // bloco só com ela.
+            d->stats.branches++;
+            ASTNode* initializer = stmt->initializer;
+            node->type = AST_BLOCK;
+            ((ASTBlock*)node)->statements = initializer;
+            return node;
+        }
+        case AST_FN_DECL:
+            clear_terminal(d);
+            return node;
+        case AST_PROGRAM:
+            clear_terminal(d);
+            prune_functions(d, (ASTProgram*)node);
+            return node;
+        default:
+            return node;
+    }
+}
+
+Pass dce_pass(DeadCode* d) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "dce";
+    pass.state = d;
+    pass.leave = leave;
+    return pass;
+}
@@ -0,0 +1,36 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "ast.h"
+#include "pass.h"
+
+// Eliminação de código morto sobre a AST.
+//
+// Dentro de um bloco, tudo o que vem depois de um comando que nunca
+// termina normalmente é removido: return, while/for com condição sempre
+// verdadeira (Lamo não tem break) e blocos ou if/else que acabam num
+// deles. if com condição literal vira o ramo escolhido (ou some), while
+// com condição falsa some e for com condição falsa fica só com a
+// inicialização. Roda depois da dobra (fold.h) para ver as condições já
+// dobradas; o código removido já passou pelo resolvedor, então erros nele
+// continuam sendo reportados.
+//
+// Funções que não podem ser alcançadas a partir das instruções do nível
+// superior são removidas do programa. Isso depende do grafo de chamadas
+// inteiro e só acontece quando o passe roda sobre o AST_PROGRAM; nos modos
+// streaming e compacto, que processam uma declaração por vez, todas as
+// funções ficam.
+typedef struct {
+    int statements;     // comandos inalcançáveis removidos
+    int branches;       // if/while/for com condição constante
+    int functions;      // funções nunca chamadas
+} DceStats;
+
+typedef struct DeadCode DeadCode;
+
+DeadCode* dce_new(void);
+void dce_free(DeadCode* d);
+Pass dce_pass(DeadCode* d);
+const DceStats* dce_stats(const DeadCode* d);
+
+#endif
@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "fold.h"
+
+// Valores conhecidos de um frame (função ou main), indexados por slot.
+typedef struct {
+    unsigned char* known;
+    int* value;
+    int* name;
+    int capacity;
+} ConstFrame;
+
+// if/while/for e a faixa de assigned[] com os nomes atribuídos dentro
+// dele. Faixas de regiões aninhadas ficam dentro da faixa de fora.
+typedef struct {
+    ASTNode* node;
+    int first;
+    int count;
+} Region;
+
+static int is_region(const ASTNode* node) {
+    return node->type == AST_IF_STMT || node->type == AST_WHILE_STMT || node->type == AST_FOR_STMT;
+}
+
+struct Folder {
+    ConstFrame* frames;
+    int frame_count;
+    int frame_capacity;
+
+    // Regiões em aberto na travessia.
+    Region* regions;
+    int region_count;
+    int region_capacity;
+
+    // Regiões já varridas, na ordem em que a travessia vai abri-las: uma
+    // varredura da região mais externa serve para todas as de dentro.
+    Region* scanned;
+    int scanned_count;
+    int scanned_capacity;
+    int scanned_next;
+    int* scan_stack;
+    int scan_depth;
+    int scan_capacity;
+
+    int* assigned;
+    int assigned_count;
+    int assigned_capacity;
+
+    // Marca por id de nome, usada ao esquecer valores.
+    unsigned char* marks;
+    int mark_capacity;
+
+    // Percorre a subárvore de um if/while/for atrás de atribuições.
+    PassManager* scanner;
+
+    int checked;
+    FoldStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow Folder");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static void scan_enter(ASTNode* node, void* state) {
+    Folder* f = state;
+    if (node->type == AST_ASSIGN_STMT) {
+        f->assigned = grow(f->assigned, &f->assigned_capacity, f->assigned_count + 1, sizeof(int));
+        f->assigned[f->assigned_count++] = ((ASTAssignStmt*)node)->name;
+    } else if (is_region(node)) {
+        f->scanned = grow(f->scanned, &f->scanned_capacity, f->scanned_count + 1, sizeof(Region));
+        f->scan_stack = grow(f->scan_stack, &f->scan_capacity, f->scan_depth + 1, sizeof(int));
+        f->scan_stack[f->scan_depth++] = f->scanned_count;
+        Region* r = &f->scanned[f->scanned_count++];
+        r->node = node;
+        r->first = f->assigned_count;
+        r->count = 0;
+    }
+}
+
+static ASTNode* scan_leave(ASTNode* node, void* state) {
+    Folder* f = state;
+    if (is_region(node)) {
+        Region* r = &f->scanned[f->scan_stack[--f->scan_depth]];
+        r->count = f->assigned_count - r->first;
+    }
+    return node;
+}
+
+Folder* folder_new(int checked) {
+    Folder* f = calloc(1, sizeof(Folder));
+    if (!f) {
+        perror("Failed to allocate Folder");
+        exit(EXIT_FAILURE);
+    }
+    f->checked = checked;
+    f->scanner = pass_manager_new();
+    Pass scan;
+    memset(&scan, 0, sizeof(scan));
+    scan.name = "fold/scan";
+    scan.state = f;
+    scan.enter = scan_enter;
+    scan.leave = scan_leave;
+    pass_manager_add(f->scanner, &scan);
+    return f;
+}
+
+void folder_free(Folder* f) {
+    if (!f) return;
+    for (int i = 0; i < f->frame_capacity; i++) {
+        free(f->frames[i].known);
+        free(f->frames[i].value);
+        free(f->frames[i].name);
+    }
+    free(f->frames);
+    free(f->regions);
+    free(f->scanned);
+    free(f->scan_stack);
+    free(f->assigned);
+    free(f->marks);
+    pass_manager_free(f->scanner);
+    free(f);
+}
+
+const FoldStats* folder_stats(const Folder* f) {
+    return &f->stats;
+}
+
+// O frame do main é criado sob demanda; funções empilham o seu.
+static ConstFrame* frame(Folder* f) {
+    if (f->frame_count == 0) {
+        f->frames = grow(f->frames, &f->frame_capacity, 1, sizeof(ConstFrame));
+        memset(f->frames, 0, sizeof(ConstFrame) * f->frame_capacity);
+        f->frame_count = 1;
+    }
+    return &f->frames[f->frame_count - 1];
+}
+
+static void push_frame(Folder* f) {
+    frame(f);
+    int old = f->frame_capacity;
+    f->frames = grow(f->frames, &f->frame_capacity, f->frame_count + 1, sizeof(ConstFrame));
+    memset(f->frames + old, 0, sizeof(ConstFrame) * (f->frame_capacity - old));
+    ConstFrame* fr = &f->frames[f->frame_count++];
+    if (fr->capacity) memset(fr->known, 0, fr->capacity);
+}
+
+static void set_value(Folder* f, int slot, int name, int known, int value) {
+    if (slot < 0) return;
+    ConstFrame* fr = frame(f);
+    if (slot >= fr->capacity) {
+        int old = fr->capacity;
+        int capacity = old;
+        fr->known = grow(fr->known, &capacity, slot + 1, 1);
+        capacity = old;
+        fr->value = grow(fr->value, &capacity, slot + 1, sizeof(int));
+        capacity = old;
+        fr->name = grow(fr->name, &capacity, slot + 1, sizeof(int));
+        memset(fr->known + old, 0, capacity - old);
+        fr->capacity = capacity;
+    }
+    fr->known[slot] = (unsigned char)known;
+    fr->value[slot] = value;
+    fr->name[slot] = name;
+}
+
+static int get_value(Folder* f, int slot, int* value) {
+    ConstFrame* fr = frame(f);
+    if (slot < 0 || slot >= fr->capacity || !fr->known[slot]) return 0;
+    *value = fr->value[slot];
+    return 1;
+}
+
+// Esquece o valor das variáveis atribuídas dentro de uma região.
+static void forget(Folder* f, const Region* r) {
+    if (r->count == 0) return;
+    for (int i = r->first; i < r->first + r->count; i++) {
+        int name = f->assigned[i];
+        if (name >= f->mark_capacity) {
+            int old = f->mark_capacity;
+            f->marks = grow(f->marks, &f->mark_capacity, name + 1, 1);
+            memset(f->marks + old, 0, f->mark_capacity - old);
+        }
+        f->marks[name] = 1;
+    }
+    ConstFrame* fr = frame(f);
+    for (int slot = 0; slot < fr->capacity; slot++) {
+        if (fr->known[slot] && fr->name[slot] < f->mark_capacity && f->marks[fr->name[slot]]) {
+            fr->known[slot] = 0;
+        }
+    }
+    for (int i = r->first; i < r->first + r->count; i++) f->marks[f->assigned[i]] = 0;
+}
+
+// A varredura só roda na região mais externa; as de dentro já estão em
+// scanned[], na mesma ordem. Se a árvore mudou no caminho (outro passe
+// trocou um nó), a região é varrida de novo.
+static void open_region(Folder* f, ASTNode* node) {
+    if (f->region_count == 0) {
+        f->scanned_count = f->scanned_next = 0;
+        f->assigned_count = 0;
+    }
+    if (f->scanned_next == f->scanned_count || f->scanned[f->scanned_next].node != node) {
+        f->scanned_next = f->scanned_count;
+        ASTNode* root = node;
+        pass_manager_run_node(f->scanner, &root);
+    }
+    f->regions = grow(f->regions, &f->region_capacity, f->region_count + 1, sizeof(Region));
+    f->regions[f->region_count++] = f->scanned[f->scanned_next++];
+}
+
+static int literal_value(const ASTNode* node, int* value) {
+    if (node->type == AST_INT_LITERAL) {
+        *value = ((const ASTIntLiteral*)node)->value;
+        return 1;
+    }
+    if (node->type == AST_BOOL_LITERAL) {
+        *value = ((const ASTBoolLiteral*)node)->value;
+        return 1;
+    }
+    return 0;
+}
+
+// Reescreve o nó no lugar como um literal inteiro.
+static ASTNode* make_int(ASTNode* node, int value) {
+    node->type = AST_INT_LITERAL;
+    ((ASTIntLiteral*)node)->value = value;
+    return node;
+}
+
+static int wrap(int64_t v) {
+    return (int)(uint32_t)(uint64_t)v;
+}
+
+// 1 se o resultado foi para *out. Com checked, um resultado fora do int
+// não é dobrado e fica para a checagem em tempo de execução.
+static int arith(const Folder* f, int64_t v, int* out) {
+    if (f->checked && (v < INT_MIN || v > INT_MAX)) return 0;
+    *out = wrap(v);
+    return 1;
+}
+
+static void warn(Folder* f, const ASTNode* node, const char* msg) {
+    fprintf(stderr, "\n[Aviso] Linha %d, Coluna %d: %s\n", node->line, node->column, msg);
+    f->stats.warnings++;
+}
+
+// 1 se a operação foi dobrada em *out.
+static int fold_binary(Folder* f, const ASTNode* node, TokenType op, int a, int b, int* out) {
+    int64_t x = a, y = b;
+    switch (op) {
+        case TOKEN_PLUS: return arith(f, x + y, out);
+        case TOKEN_MINUS: return arith(f, x - y, out);
+        case TOKEN_STAR: return arith(f, x * y, out);
+        case TOKEN_SLASH:
+        case TOKEN_PERCENT:
+            if (b == 0) {
+                warn(f, node, op == TOKEN_SLASH ? "Divisão por zero" : "Resto de divisão por zero");
+                return 0;
+            }
+            if (a == INT_MIN && b == -1) return 0;
+            *out = op == TOKEN_SLASH ? a / b : a % b;
+            return 1;
+        case TOKEN_EQ_EQ: *out = a == b; return 1;
+        case TOKEN_BANG_EQ: *out = a != b; return 1;
+        case TOKEN_LT: *out = a < b; return 1;
+        case TOKEN_GT: *out = a > b; return 1;
+        case TOKEN_LT_EQ: *out = a <= b; return 1;
+        case TOKEN_GT_EQ: *out = a >= b; return 1;
+        case TOKEN_AND_AND: *out = a && b; return 1;
+        case TOKEN_OR_OR: *out = a || b; return 1;
+        default: return 0;
+    }
+}
+
+static void enter(ASTNode* node, void* state) {
+    Folder* f = state;
+    if (f->region_count) {
+        Region* r = &f->regions[f->region_count - 1];
+        // O else não vê o que o then atribuiu, e o corpo do for roda antes
+        // do incremento que o precede no source.
+        if ((r->node->type == AST_IF_STMT && node == ((ASTIfStmt*)r->node)->else_branch) ||
+            (r->node->type == AST_FOR_STMT && node == ((ASTForStmt*)r->node)->body)) {
+            forget(f, r);
+        }
+    }
+    switch (node->type) {
+        case AST_FN_DECL:
+            push_frame(f);
+            break;
+        case AST_IF_STMT:
+            // Condição e then partem do estado de antes do if.
+            open_region(f, node);
+            break;
+        case AST_WHILE_STMT:
+            open_region(f, node);
+            forget(f, &f->regions[f->region_count - 1]);
+            break;
+        case AST_FOR_STMT:
+            // A inicialização roda uma vez só: o esquecimento fica para o
+            // leave dela.
+            open_region(f, node);
+            if (!((ASTForStmt*)node)->initializer) forget(f, &f->regions[f->region_count - 1]);
+            break;
+        default:
+            break;
+    }
+}
+
+static ASTNode* fold(Folder* f, ASTNode* node) {
+    int a, b, v;
+    switch (node->type) {
+        case AST_IDENTIFIER: {
+            ASTIdentifier* id = (ASTIdentifier*)node;
+            if (get_value(f, id->slot, &v)) {
+                f->stats.propagated++;
+                return make_int(node, v);
+            }
+            return node;
+        }
+        case AST_GROUPING_EXPR: {
+            ASTNode* inner = ((ASTGroupingExpr*)node)->expression;
+            if (literal_value(inner, &v)) {
+                f->stats.folded++;
+                return make_int(node, v);
+            }
+            return node;
+        }
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* u = (ASTUnaryExpr*)node;
+            if (!literal_value(u->right, &a)) return node;
+            if (u->operator == TOKEN_MINUS) {
+                if (!arith(f, -(int64_t)a, &v)) return node;
+            } else if (u->operator == TOKEN_BANG) v = !a;
+            else return node;
+            f->stats.folded++;
+            return make_int(node, v);
+        }
+        case AST_BINARY_EXPR: {
+            ASTBinaryExpr* bin = (ASTBinaryExpr*)node;
+            if (!literal_value(bin->left, &a) || !literal_value(bin->right, &b)) return node;
+            if (!fold_binary(f, node, bin->operator, a, b, &v)) return node;
+            f->stats.folded++;
+            return make_int(node, v);
+        }
+        case AST_INLINE_EXPR: {
+            // Função expandida (inline.h) que se reduziu a lets de literais
+            // e um resultado literal.
+            ASTInlineExpr* inl = (ASTInlineExpr*)node;
+            if (!literal_value(inl->result, &v)) return node;
+            for (ASTNode* stmt = inl->statements; stmt; stmt = stmt->next) {
+                if (stmt->type != AST_VAR_DECL || !literal_value(((ASTVarDecl*)stmt)->initializer, &a)) return node;
+            }
+            f->stats.folded++;
+            return make_int(node, v);
+        }
+        case AST_VAR_DECL: {
+            ASTVarDecl* var = (ASTVarDecl*)node;
+            int known = var->initializer && literal_value(var->initializer, &v);
+            set_value(f, var->slot, var->name, known, known ? v : 0);
+            return node;
+        }
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* as = (ASTAssignStmt*)node;
+            int known = literal_value(as->value, &b);
+            if (known && as->op_type != TOKEN_EQUALS) {
+                known = get_value(f, as->slot, &a) &&
+                        arith(f, as->op_type == TOKEN_PLUS_EQ ? (int64_t)a + b : (int64_t)a - b, &b);
+            }
+            set_value(f, as->slot, as->name, known, known ? b : 0);
+            return node;
+        }
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+        case AST_FOR_STMT: {
+            forget(f, &f->regions[--f->region_count]);
+            return node;
+        }
+        case AST_FN_DECL:
+            f->frame_count--;
+            return node;
+        default:
+            return node;
+    }
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    Folder* f = state;
+    ASTNode* result = fold(f, node);
+    if (f->region_count) {
+        Region* r = &f->regions[f->region_count - 1];
+        if (r->node->type == AST_FOR_STMT && node == ((ASTForStmt*)r->node)->initializer) forget(f, r);
+    }
+    return result;
+}
+
+Pass folder_pass(Folder* f) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "fold";
+    pass.state = f;
+    pass.enter = enter;
+    pass.leave = leave;
+    return pass;
+}
@@ -0,0 +1,41 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "ast.h"
+#include "pass.h"
+
+// Dobra de constantes e propagação de constantes sobre a AST.
+//
+// Expressões binárias, unárias e parênteses cujos operandos são literais
+// viram um literal, com a aritmética do int de 32 bits do C gerado:
+// overflow dá a volta (complemento de dois), divisão trunca em direção a
+// zero e comparações e operadores lógicos dão 0 ou 1. Divisão ou resto por
+// zero não é dobrado e gera um aviso; INT_MIN / -1 também fica para o
+// tempo de execução. Com checked (--check-overflow), uma operação que
+// estoura também não é dobrada e a checagem do C gerado a pega. Strings
+// não são dobradas.
+//
+// Variáveis com valor inteiro conhecido são trocadas pelo valor. O valor
+// vem de let e atribuições em código em linha reta e é esquecido por
+// if/while/for para toda variável atribuída dentro deles. Depende dos slots
+// do resolvedor (resolve.h), então o passe deve ser registrado depois dele.
+//
+// Uma função expandida por inline.h que ficou só com lets de literais e um
+// resultado literal também vira o literal.
+//
+// Nós dobrados são reescritos no lugar (todo nó de expressão cabe num
+// ASTIntLiteral), sem alocar.
+typedef struct {
+    int folded;         // expressões trocadas por literais
+    int propagated;     // usos de variáveis trocados por literais
+    int warnings;
+} FoldStats;
+
+typedef struct Folder Folder;
+
+Folder* folder_new(int checked);
+void folder_free(Folder* f);
+Pass folder_pass(Folder* f);
+const FoldStats* folder_stats(const Folder* f);
+
+#endif
@@ -0,0 +1,551 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inline.h"
+
+typedef struct {
+    ASTFnDecl* fn;
+    // Faixa de calls[] com os nomes chamados no corpo.
+    int first_call;
+    int call_count;
+    // A expressão do return pode ser descartada numa chamada-comando.
+    int pure_result;
+    int enabled;
+} Candidate;
+
+// Quadro da busca em profundidade de Tarjan: nó e próxima aresta.
+typedef struct {
+    int node;
+    int edge;
+} Visit;
+
+struct Inliner {
+    SymbolTable* names;
+    Arena* arena;
+    int budget;
+
+    // Por id de nome: índice da candidata, -1 se não é função e -2 se é
+    // uma função que não pode ser expandida.
+    int* candidate_of;
+    int name_capacity;
+
+    Candidate* candidates;
+    int candidate_count;
+    int candidate_capacity;
+    int* calls;
+    int call_count;
+    int call_capacity;
+
+    // Componentes fortemente conexas do grafo das candidatas.
+    int* order;
+    int* low;
+    unsigned char* on_stack;
+    int* stack;
+    Visit* visits;
+    int scc_capacity;
+
+    // Renomeação da chamada sendo expandida: from[i] vira to[i].
+    int* rename_from;
+    int* rename_to;
+    int rename_count;
+    int rename_capacity;
+    int next_suffix;
+
+    // Crescimento já gasto na função atual e no main, que é retomado
+    // entre as funções.
+    int spent;
+    int main_spent;
+
+    InlineStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow Inliner");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+Inliner* inliner_new(SymbolTable* names, Arena* arena, int budget) {
+    Inliner* in = calloc(1, sizeof(Inliner));
+    if (!in) {
+        perror("Failed to allocate Inliner");
+        exit(EXIT_FAILURE);
+    }
+    in->names = names;
+    in->arena = arena;
+    in->budget = budget;
+    return in;
+}
+
+void inliner_free(Inliner* in) {
+    if (!in) return;
+    free(in->candidate_of);
+    free(in->candidates);
+    free(in->calls);
+    free(in->order);
+    free(in->low);
+    free(in->on_stack);
+    free(in->stack);
+    free(in->visits);
+    free(in->rename_from);
+    free(in->rename_to);
+    free(in);
+}
+
+const InlineStats* inliner_stats(const Inliner* in) {
+    return &in->stats;
+}
+
+static int candidate_of(const Inliner* in, int name) {
+    return name >= 0 && name < in->name_capacity ? in->candidate_of[name] : -1;
+}
+
+// Formato do corpo medido por measure().
+typedef struct {
+    int size;
+    int returns;
+    int limit;
+} Shape;
+
+// Conta os nós do corpo e guarda os nomes chamados em calls[]. Para assim
+// que passa de limit nós (a recursão fica limitada por ele) e devolve 0.
+static int measure(Inliner* in, const ASTNode* node, Shape* s) {
+    if (!node) return 1;
+    if (++s->size > s->limit) return 0;
+    switch (node->type) {
+        case AST_VAR_DECL:
+            return measure(in, ((const ASTVarDecl*)node)->initializer, s);
+        case AST_BLOCK:
+            for (const ASTNode* stmt = ((const ASTBlock*)node)->statements; stmt; stmt = stmt->next) {
+                if (!measure(in, stmt, s)) return 0;
+            }
+            return 1;
+        case AST_INLINE_EXPR:
+            for (const ASTNode* stmt = ((const ASTInlineExpr*)node)->statements; stmt; stmt = stmt->next) {
+                if (!measure(in, stmt, s)) return 0;
+            }
+            return measure(in, ((const ASTInlineExpr*)node)->result, s);
+        case AST_IF_STMT: {
+            const ASTIfStmt* n = (const ASTIfStmt*)node;
+            return measure(in, n->condition, s) && measure(in, n->then_branch, s) &&
+                   measure(in, n->else_branch, s);
+        }
+        case AST_WHILE_STMT: {
+            const ASTWhileStmt* n = (const ASTWhileStmt*)node;
+            return measure(in, n->condition, s) && measure(in, n->body, s);
+        }
+        case AST_FOR_STMT: {
+            const ASTForStmt* n = (const ASTForStmt*)node;
+            return measure(in, n->initializer, s) && measure(in, n->condition, s) &&
+                   measure(in, n->increment, s) && measure(in, n->body, s);
+        }
+        case AST_RETURN_STMT:
+            s->returns++;
+            return measure(in, ((const ASTReturnStmt*)node)->expression, s);
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+            return measure(in, ((const ASTPrintStmt*)node)->expression, s);
+        case AST_GROUPING_EXPR:
+            return measure(in, ((const ASTGroupingExpr*)node)->expression, s);
+        case AST_ASSIGN_STMT:
+            return measure(in, ((const ASTAssignStmt*)node)->value, s);
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR: {
+            const ASTCallStmt* n = (const ASTCallStmt*)node;
+            in->calls = grow(in->calls, &in->call_capacity, in->call_count + 1, sizeof(int));
+            in->calls[in->call_count++] = n->name;
+            for (int i = 0; i < n->arg_count; i++) {
+                if (!measure(in, n->args[i], s)) return 0;
+            }
+            return 1;
+        }
+        case AST_BINARY_EXPR: {
+            const ASTBinaryExpr* n = (const ASTBinaryExpr*)node;
+            return measure(in, n->left, s) && measure(in, n->right, s);
+        }
+        case AST_UNARY_EXPR:
+            return measure(in, ((const ASTUnaryExpr*)node)->right, s);
+        default:
+            return 1;
+    }
+}
+
+// Sem chamadas, leitura de entrada, exit ou divisão (que pode falhar).
+static int is_pure(const ASTNode* node) {
+    switch (node->type) {
+        case AST_INT_LITERAL:
+        case AST_BOOL_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_IDENTIFIER:
+            return 1;
+        case AST_GROUPING_EXPR:
+            return is_pure(((const ASTGroupingExpr*)node)->expression);
+        case AST_UNARY_EXPR:
+            return is_pure(((const ASTUnaryExpr*)node)->right);
+        case AST_ABS_EXPR:
+            return is_pure(((const ASTPrintStmt*)node)->expression);
+        case AST_BINARY_EXPR: {
+            const ASTBinaryExpr* n = (const ASTBinaryExpr*)node;
+            if (n->operator == TOKEN_SLASH || n->operator == TOKEN_PERCENT) return 0;
+            return is_pure(n->left) && is_pure(n->right);
+        }
+        default:
+            return 0;
+    }
+}
+
+static void add_candidate(Inliner* in, ASTFnDecl* fn) {
+    int state = candidate_of(in, fn->name);
+    if (state != -1) {
+        // Nome repetido: erro do resolvedor, nenhuma das duas é expandida.
+        if (state >= 0) in->candidates[state].enabled = 0;
+        in->candidate_of[fn->name] = -2;
+        return;
+    }
+    in->candidate_of[fn->name] = -2;
+    // @memo pede o cache (memo.h): as chamadas têm de passar por ele.
+    if (fn->memo) return;
+
+    ASTBlock* body = (ASTBlock*)fn->body;
+    if (!body || body->base.type != AST_BLOCK || !body->statements) return;
+    ASTNode* last = body->statements;
+    while (last->next) last = last->next;
+    if (last->type != AST_RETURN_STMT) return;
+
+    int first_call = in->call_count;
+    Shape shape = { 0, 0, in->budget };
+    if (!measure(in, fn->body, &shape) || shape.returns != 1) {
+        in->call_count = first_call;
+        return;
+    }
+
+    in->candidates = grow(in->candidates, &in->candidate_capacity, in->candidate_count + 1, sizeof(Candidate));
+    Candidate* c = &in->candidates[in->candidate_count];
+    c->fn = fn;
+    c->first_call = first_call;
+    c->call_count = in->call_count - first_call;
+    c->pure_result = is_pure(((ASTReturnStmt*)last)->expression);
+    c->enabled = 1;
+    in->candidate_of[fn->name] = in->candidate_count++;
+}
+
+// Aresta e de v, como índice de candidata (-1 se o alvo não é candidata).
+static int edge(const Inliner* in, int v, int e) {
+    const Candidate* c = &in->candidates[v];
+    int w = candidate_of(in, in->calls[c->first_call + e]);
+    return w >= 0 ? w : -1;
+}
+
+// Desliga as candidatas que estão num ciclo do grafo de chamadas (Tarjan,
+// com pilha explícita). Sem ciclos entre as que sobram, expandir dentro de
+// uma cópia sempre termina.
+static void drop_recursive(Inliner* in) {
+    int n = in->candidate_count;
+    int capacity = in->scc_capacity;
+    in->order = grow(in->order, &capacity, n, sizeof(int));
+    capacity = in->scc_capacity;
+    in->low = grow(in->low, &capacity, n, sizeof(int));
+    capacity = in->scc_capacity;
+    in->on_stack = grow(in->on_stack, &capacity, n, 1);
+    capacity = in->scc_capacity;
+    in->stack = grow(in->stack, &capacity, n, sizeof(int));
+    capacity = in->scc_capacity;
+    in->visits = grow(in->visits, &capacity, n, sizeof(Visit));
+    in->scc_capacity = capacity;
+    for (int i = 0; i < n; i++) {
+        in->order[i] = -1;
+        in->on_stack[i] = 0;
+    }
+
+    int counter = 0, top = 0;
+    for (int root = 0; root < n; root++) {
+        if (in->order[root] >= 0) continue;
+        int depth = 0;
+        in->visits[depth++] = (Visit){ root, 0 };
+        in->order[root] = in->low[root] = counter++;
+        in->stack[top++] = root;
+        in->on_stack[root] = 1;
+        while (depth > 0) {
+            Visit* vis = &in->visits[depth - 1];
+            int v = vis->node;
+            if (vis->edge < in->candidates[v].call_count) {
+                int w = edge(in, v, vis->edge++);
+                if (w < 0) continue;
+                if (w == v) {
+                    in->candidates[v].enabled = 0;
+                } else if (in->order[w] < 0) {
+                    in->order[w] = in->low[w] = counter++;
+                    in->stack[top++] = w;
+                    in->on_stack[w] = 1;
+                    in->visits[depth++] = (Visit){ w, 0 };
+                } else if (in->on_stack[w] && in->order[w] < in->low[v]) {
+                    in->low[v] = in->order[w];
+                }
+                continue;
+            }
+            depth--;
+            if (in->low[v] == in->order[v]) {
+                int end = top, w;
+                do {
+                    w = in->stack[--top];
+                    in->on_stack[w] = 0;
+                } while (w != v);
+                if (end - top > 1) {
+                    for (int i = top; i < end; i++) in->candidates[in->stack[i]].enabled = 0;
+                }
+            }
+            if (depth > 0) {
+                int u = in->visits[depth - 1].node;
+                if (in->low[v] < in->low[u]) in->low[u] = in->low[v];
+            }
+        }
+    }
+}
+
+static void choose_candidates(Inliner* in, ASTProgram* program) {
+    int capacity = in->name_capacity;
+    in->candidate_of = grow(in->candidate_of, &capacity, symtab_count(in->names) + 1, sizeof(int));
+    in->name_capacity = capacity;
+    for (int i = 0; i < capacity; i++) in->candidate_of[i] = -1;
+    in->candidate_count = 0;
+    in->call_count = 0;
+
+    for (ASTNode* decl = program->declarations; decl; decl = decl->next) {
+        if (decl->type == AST_FN_DECL) add_candidate(in, (ASTFnDecl*)decl);
+    }
+    drop_recursive(in);
+    for (int i = 0; i < in->candidate_count; i++) {
+        Candidate* c = &in->candidates[i];
+        if (c->enabled) in->stats.candidates++;
+        else if (in->candidate_of[c->fn->name] == i) in->candidate_of[c->fn->name] = -2;
+    }
+}
+
+static int rename_name(Inliner* in, int name) {
+    for (int i = 0; i < in->rename_count; i++) {
+        if (in->rename_from[i] == name) return in->rename_to[i];
+    }
+    int capacity = in->rename_capacity;
+    in->rename_from = grow(in->rename_from, &capacity, in->rename_count + 1, sizeof(int));
+    capacity = in->rename_capacity;
+    in->rename_to = grow(in->rename_to, &capacity, in->rename_count + 1, sizeof(int));
+    in->rename_capacity = capacity;
+    in->rename_from[in->rename_count] = name;
+    in->rename_to[in->rename_count] = symtab_fresh(in->names, name, &in->next_suffix);
+    return in->rename_to[in->rename_count++];
+}
+
+static ASTNode* copy(Inliner* in, const ASTNode* node);
+
+static ASTNode* copy_list(Inliner* in, const ASTNode* head) {
+    ASTNode* first = NULL;
+    ASTNode* tail = NULL;
+    for (; head; head = head->next) {
+        ASTNode* node = copy(in, head);
+        if (tail) tail->next = node; else first = node;
+        tail = node;
+    }
+    return first;
+}
+
+static ASTNode** copy_args(Inliner* in, ASTNode** args, int arg_count) {
+    if (arg_count == 0) return NULL;
+    ASTNode** copies = arena_alloc(in->arena, sizeof(ASTNode*) * arg_count);
+    for (int i = 0; i < arg_count; i++) copies[i] = copy(in, args[i]);
+    return copies;
+}
+
+// Cópia profunda com os nomes de variáveis trocados; nomes de funções
+// ficam. A profundidade é limitada pelo orçamento das candidatas.
+static ASTNode* copy(Inliner* in, const ASTNode* node) {
+    if (!node) return NULL;
+    Arena* a = in->arena;
+    int line = node->line, col = node->column;
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            const ASTVarDecl* n = (const ASTVarDecl*)node;
+            ASTNode* init = copy(in, n->initializer);
+            return (ASTNode*)ast_new_var_decl(a, rename_name(in, n->name), init, line, col);
+        }
+        case AST_BLOCK:
+            return (ASTNode*)ast_new_block(a, copy_list(in, ((const ASTBlock*)node)->statements), line, col);
+        case AST_IF_STMT: {
+            const ASTIfStmt* n = (const ASTIfStmt*)node;
+            ASTNode* cond = copy(in, n->condition);
+            ASTNode* then_branch = copy(in, n->then_branch);
+            return (ASTNode*)ast_new_if_stmt(a, cond, then_branch, copy(in, n->else_branch), line, col);
+        }
+        case AST_WHILE_STMT: {
+            const ASTWhileStmt* n = (const ASTWhileStmt*)node;
+            ASTNode* cond = copy(in, n->condition);
+            return (ASTNode*)ast_new_while_stmt(a, cond, copy(in, n->body), line, col);
+        }
+        case AST_FOR_STMT: {
+            const ASTForStmt* n = (const ASTForStmt*)node;
+            ASTNode* init = copy(in, n->initializer);
+            ASTNode* cond = copy(in, n->condition);
+            ASTNode* inc = copy(in, n->increment);
+            return (ASTNode*)ast_new_for_stmt(a, init, cond, inc, copy(in, n->body), line, col);
+        }
+        case AST_RETURN_STMT:
+            return (ASTNode*)ast_new_return_stmt(a, copy(in, ((const ASTReturnStmt*)node)->expression), line, col);
+        case AST_PRINT_STMT:
+            return (ASTNode*)ast_new_print_stmt(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_INPUT_EXPR:
+            return ast_new_input_expr(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_ISNUMBER_EXPR:
+            return ast_new_isnumber_expr(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_ISSTRING_EXPR:
+            return ast_new_isstring_expr(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_EXIT_STMT:
+            return ast_new_exit_stmt(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_ABS_EXPR:
+            return ast_new_abs_expr(a, copy(in, ((const ASTPrintStmt*)node)->expression), line, col);
+        case AST_ASSIGN_STMT: {
+            const ASTAssignStmt* n = (const ASTAssignStmt*)node;
+            ASTNode* value = copy(in, n->value);
+            return (ASTNode*)ast_new_assign_stmt(a, rename_name(in, n->name), value, n->op_type, line, col);
+        }
+        case AST_CALL_STMT: {
+            const ASTCallStmt* n = (const ASTCallStmt*)node;
+            ASTNode** args = copy_args(in, n->args, n->arg_count);
+            return (ASTNode*)ast_new_call_stmt(a, n->name, args, n->arg_count, line, col);
+        }
+        case AST_CALL_EXPR: {
+            const ASTCallExpr* n = (const ASTCallExpr*)node;
+            ASTNode** args = copy_args(in, n->args, n->arg_count);
+            return (ASTNode*)ast_new_call_expr(a, n->name, args, n->arg_count, line, col);
+        }
+        case AST_BINARY_EXPR: {
+            const ASTBinaryExpr* n = (const ASTBinaryExpr*)node;
+            ASTNode* left = copy(in, n->left);
+            return (ASTNode*)ast_new_binary_expr(a, left, n->operator, copy(in, n->right), line, col);
+        }
+        case AST_UNARY_EXPR: {
+            const ASTUnaryExpr* n = (const ASTUnaryExpr*)node;
+            return (ASTNode*)ast_new_unary_expr(a, n->operator, copy(in, n->right), line, col);
+        }
+        case AST_INT_LITERAL:
+            return (ASTNode*)ast_new_int_literal(a, ((const ASTIntLiteral*)node)->value, line, col);
+        case AST_BOOL_LITERAL:
+            return (ASTNode*)ast_new_bool_literal(a, ((const ASTBoolLiteral*)node)->value, line, col);
+        case AST_STRING_LITERAL: {
+            const char* s = ((const ASTStringLiteral*)node)->value;
+            return (ASTNode*)ast_new_string_literal(a, s, (int)strlen(s), line, col);
+        }
+        case AST_IDENTIFIER:
+            return (ASTNode*)ast_new_identifier(a, rename_name(in, ((const ASTIdentifier*)node)->name), line, col);
+        case AST_GROUPING_EXPR:
+            return (ASTNode*)ast_new_grouping_expr(a, copy(in, ((const ASTGroupingExpr*)node)->expression), line, col);
+        case AST_INLINE_EXPR: {
+            const ASTInlineExpr* n = (const ASTInlineExpr*)node;
+            ASTNode* statements = copy_list(in, n->statements);
+            return (ASTNode*)ast_new_inline_expr(a, statements, copy(in, n->result), line, col);
+        }
+        case AST_FN_DECL:
+        case AST_PROGRAM:
+            break;
+    }
+    return NULL;
+}
+
+// Reescreve a chamada no lugar (um ASTInlineExpr ou um ASTBlock cabe num
+// ASTCallExpr), para que os passes seguintes já vejam a expansão.
+static void expand(Inliner* in, ASTNode* node) {
+    ASTCallExpr* call = (ASTCallExpr*)node;
+    int index = candidate_of(in, call->name);
+    if (index < 0) return;
+    Candidate* c = &in->candidates[index];
+    ASTFnDecl* fn = c->fn;
+    if (call->arg_count != fn->param_count) return;
+    if (node->type == AST_CALL_STMT && !c->pure_result) return;
+    // O corpo pode já ter crescido com as expansões feitas nele; mede o de
+    // agora, sem guardar as chamadas.
+    int calls = in->call_count;
+    Shape shape = { 0, 0, INLINE_GROWTH - in->spent - fn->param_count };
+    int fits = measure(in, fn->body, &shape);
+    in->call_count = calls;
+    if (!fits) {
+        in->stats.limited++;
+        return;
+    }
+    in->spent += shape.size + fn->param_count;
+
+    in->rename_count = 0;
+    ASTNode* head = NULL;
+    ASTNode* tail = NULL;
+    for (int i = 0; i < fn->param_count; i++) {
+        int name = rename_name(in, fn->params[i]);
+        ASTNode* let = (ASTNode*)ast_new_var_decl(in->arena, name, call->args[i], node->line, node->column);
+        if (tail) tail->next = let; else head = let;
+        tail = let;
+    }
+    ASTNode* last = NULL;
+    for (ASTNode* stmt = ((ASTBlock*)fn->body)->statements; stmt; stmt = stmt->next) {
+        if (!stmt->next) {
+            last = stmt;
+            break;
+        }
+        ASTNode* body = copy(in, stmt);
+        if (tail) tail->next = body; else head = body;
+        tail = body;
+    }
+    in->stats.sites++;
+
+    if (node->type == AST_CALL_STMT) {
+        node->type = AST_BLOCK;
+        ((ASTBlock*)node)->statements = head;
+        return;
+    }
+    ASTNode* result = copy(in, ((ASTReturnStmt*)last)->expression);
+    node->type = AST_INLINE_EXPR;
+    ((ASTInlineExpr*)node)->statements = head;
+    ((ASTInlineExpr*)node)->result = result;
+}
+
+static void enter(ASTNode* node, void* state) {
+    Inliner* in = state;
+    switch (node->type) {
+        case AST_PROGRAM:
+            choose_candidates(in, (ASTProgram*)node);
+            in->spent = in->main_spent = 0;
+            break;
+        case AST_FN_DECL:
+            in->main_spent = in->spent;
+            in->spent = 0;
+            break;
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR:
+            expand(in, node);
+            break;
+        default:
+            break;
+    }
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    Inliner* in = state;
+    if (node->type == AST_FN_DECL) in->spent = in->main_spent;
+    return node;
+}
+
+Pass inliner_pass(Inliner* in) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "inline";
+    pass.state = in;
+    pass.enter = enter;
+    pass.leave = leave;
+    return pass;
+}
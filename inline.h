@@ -0,0 +1,52 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "ast.h"
+#include "arena.h"
+#include "pass.h"
+#include "symbol.h"
+
+// Tamanho máximo, em nós da AST, do corpo de uma função expandida.
+#define INLINE_BUDGET 32
+
+// Nós que as expansões podem acrescentar a uma função (os comandos de
+// nível superior contam como uma só, o main).
+#define INLINE_GROWTH 512
+
+// Expansão de funções pequenas no lugar das chamadas.
+//
+// Candidatas são funções com corpo de até budget nós, um único return, no
+// fim do corpo, e fora de qualquer ciclo do grafo de chamadas (nem
+// recursão direta nem mútua); funções com @memo nunca são expandidas. Uma
+// chamada em expressão vira um ASTInlineExpr com um let por parâmetro (os
+// argumentos são avaliados uma vez, em ordem) seguido de uma cópia do
+// corpo; uma chamada como comando vira um bloco, quando a expressão do
+// return não tem efeitos. Parâmetros e locais da cópia ganham nomes novos
+// (nome__N, com N sequencial), que não colidem com nada do programa.
+//
+// As chamadas dentro de uma cópia também são expandidas, então uma cadeia
+// de funções que chamam a anterior duas vezes dobraria de tamanho a cada
+// nível. Cada expansão, inclusive as de dentro das cópias, gasta o tamanho
+// do corpo copiado do crescimento da função onde acontece; acabado o
+// INLINE_GROWTH, as chamadas seguintes ficam como estão.
+//
+// O passe expande no enter da chamada, então deve ser registrado antes do
+// resolvedor: a cópia é resolvida, dobrada e limpa pelos passes seguintes
+// como código escrito à mão, com slots no frame de quem chama. As
+// candidatas são escolhidas no enter do AST_PROGRAM; nos modos streaming e
+// compacto, que processam uma declaração por vez, nada é expandido.
+typedef struct {
+    int candidates;     // funções que podem ser expandidas
+    int sites;          // chamadas expandidas
+    int limited;        // chamadas deixadas por falta de crescimento
+} InlineStats;
+
+typedef struct Inliner Inliner;
+
+// Nomes novos são internados em names e as cópias alocadas em arena.
+Inliner* inliner_new(SymbolTable* names, Arena* arena, int budget);
+void inliner_free(Inliner* in);
+Pass inliner_pass(Inliner* in);
+const InlineStats* inliner_stats(const Inliner* in);
+
+#endif
@@ -0,0 +1,667 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+#define IR_ARENA_CHUNK 65536
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow IR");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static void* xmalloc(size_t size) {
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        perror("Failed to allocate IR");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+IRFunction* ir_new(const char* name) {
+    IRFunction* f = calloc(1, sizeof(IRFunction));
+    if (!f) {
+        perror("Failed to allocate IRFunction");
+        exit(EXIT_FAILURE);
+    }
+    f->name = name;
+    arena_init(&f->arena, "ir", IR_ARENA_CHUNK);
+    return f;
+}
+
+void ir_free(IRFunction* f) {
+    if (!f) return;
+    for (int i = 0; i < f->block_count; i++) {
+        free(f->blocks[i].values);
+        free(f->blocks[i].phis);
+        free(f->blocks[i].preds);
+    }
+    free(f->blocks);
+    free(f->values);
+    free(f->order);
+    arena_release(&f->arena);
+    free(f);
+}
+
+int ir_add_block(IRFunction* f) {
+    f->blocks = grow(f->blocks, &f->block_capacity, f->block_count + 1, sizeof(IRBlock));
+    IRBlock* b = &f->blocks[f->block_count];
+    memset(b, 0, sizeof(IRBlock));
+    b->term = IR_OPEN;
+    b->term_value = IR_NONE;
+    b->rpo = -1;
+    b->idom = IR_NONE;
+    return f->block_count++;
+}
+
+int ir_add_value(IRFunction* f, int block, IROp op, ValueType type, int count) {
+    f->values = grow(f->values, &f->value_capacity, f->value_count + 1, sizeof(IRValue));
+    int id = f->value_count++;
+    IRValue* v = &f->values[id];
+    memset(v, 0, sizeof(IRValue));
+    v->op = op;
+    v->type = type;
+    v->block = block;
+    v->replaced = IR_NONE;
+    v->arg_count = count;
+    if (count > 0) v->args = arena_alloc(&f->arena, sizeof(int) * count);
+
+    IRBlock* b = &f->blocks[block];
+    if (op == IR_PHI) {
+        b->phis = grow(b->phis, &b->phi_capacity, b->phi_count + 1, sizeof(int));
+        b->phis[b->phi_count++] = id;
+    } else {
+        b->values = grow(b->values, &b->capacity, b->count + 1, sizeof(int));
+        b->values[b->count++] = id;
+    }
+    return id;
+}
+
+int ir_const(IRFunction* f, int block, int value, ValueType type) {
+    int id = ir_add_value(f, block, IR_CONST, type, 0);
+    f->values[id].imm = value;
+    return id;
+}
+
+static void add_edge(IRFunction* f, int from, int to) {
+    IRBlock* b = &f->blocks[from];
+    b->succs[b->succ_count++] = to;
+    IRBlock* t = &f->blocks[to];
+    t->preds = grow(t->preds, &t->pred_capacity, t->pred_count + 1, sizeof(int));
+    t->preds[t->pred_count++] = from;
+}
+
+void ir_jump(IRFunction* f, int block, int target) {
+    ir_terminate(f, block, IR_JUMP, IR_NONE);
+    add_edge(f, block, target);
+}
+
+void ir_branch(IRFunction* f, int block, int cond, int if_true, int if_false) {
+    ir_terminate(f, block, IR_BRANCH, cond);
+    add_edge(f, block, if_true);
+    add_edge(f, block, if_false);
+}
+
+void ir_terminate(IRFunction* f, int block, IRTerm term, int value) {
+    f->blocks[block].term = term;
+    f->blocks[block].term_value = value;
+}
+
+int ir_resolve(const IRFunction* f, int value) {
+    while (value != IR_NONE && f->values[value].replaced != IR_NONE) {
+        value = f->values[value].replaced;
+    }
+    return value;
+}
+
+int ir_simplify_phi(IRFunction* f, int phi) {
+    int same = IR_NONE;
+    IRValue* v = &f->values[phi];
+    for (int i = 0; i < v->arg_count; i++) {
+        int op = ir_resolve(f, v->args[i]);
+        if (op == same || op == phi) continue;
+        if (same != IR_NONE) return phi;
+        same = op;
+    }
+    // Só ele mesmo: o phi lê uma variável nunca definida no caminho.
+    if (same == IR_NONE) same = ir_const(f, 0, 0, f->values[phi].type);
+    f->values[phi].replaced = same;
+    return same;
+}
+
+// Pós-ordem reversa a partir da entrada; só os blocos alcançáveis entram.
+// Os sucessores são visitados do último para o primeiro, para que o
+// primeiro (o lado verdadeiro de um branch, o corpo de um laço) fique logo
+// depois do bloco e o C possa cair nele sem goto.
+static void compute_order(IRFunction* f) {
+    int n = f->block_count;
+    int* stack = xmalloc(sizeof(int) * n);
+    int* next = xmalloc(sizeof(int) * n);
+    int* post = xmalloc(sizeof(int) * n);
+    int post_count = 0, top = 0;
+    for (int i = 0; i < n; i++) {
+        f->blocks[i].rpo = -1;
+        next[i] = -1;
+    }
+    stack[top++] = 0;
+    next[0] = 0;
+    while (top > 0) {
+        int b = stack[top - 1];
+        IRBlock* block = &f->blocks[b];
+        if (next[b] < block->succ_count) {
+            int s = block->succs[block->succ_count - 1 - next[b]++];
+            if (next[s] < 0) {
+                next[s] = 0;
+                stack[top++] = s;
+            }
+        } else {
+            post[post_count++] = b;
+            top--;
+        }
+    }
+    free(f->order);
+    f->order = xmalloc(sizeof(int) * (post_count ? post_count : 1));
+    f->order_count = post_count;
+    for (int i = 0; i < post_count; i++) {
+        f->order[i] = post[post_count - 1 - i];
+        f->blocks[f->order[i]].rpo = i;
+    }
+    free(stack);
+    free(next);
+    free(post);
+}
+
+// Tira as arestas que vêm de blocos inalcançáveis, junto com os operandos
+// dos phis que chegavam por elas, e esvazia esses blocos.
+static void prune(IRFunction* f) {
+    for (int b = 0; b < f->block_count; b++) {
+        IRBlock* block = &f->blocks[b];
+        if (block->rpo < 0) {
+            block->count = 0;
+            block->phi_count = 0;
+            block->pred_count = 0;
+            continue;
+        }
+        int kept = 0;
+        for (int i = 0; i < block->pred_count; i++) {
+            if (f->blocks[block->preds[i]].rpo < 0) continue;
+            for (int p = 0; p < block->phi_count; p++) {
+                IRValue* phi = &f->values[block->phis[p]];
+                phi->args[kept] = phi->args[i];
+            }
+            block->preds[kept++] = block->preds[i];
+        }
+        block->pred_count = kept;
+        for (int p = 0; p < block->phi_count; p++) f->values[block->phis[p]].arg_count = kept;
+    }
+}
+
+static void remove_trivial_phis(IRFunction* f) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < f->order_count; i++) {
+            IRBlock* block = &f->blocks[f->order[i]];
+            for (int p = 0; p < block->phi_count; p++) {
+                int phi = block->phis[p];
+                if (f->values[phi].replaced != IR_NONE) continue;
+                if (ir_simplify_phi(f, phi) != phi) changed = 1;
+                block = &f->blocks[f->order[i]];
+            }
+        }
+    }
+    for (int i = 0; i < f->order_count; i++) {
+        IRBlock* block = &f->blocks[f->order[i]];
+        int kept = 0;
+        for (int p = 0; p < block->phi_count; p++) {
+            if (f->values[block->phis[p]].replaced == IR_NONE) block->phis[kept++] = block->phis[p];
+        }
+        block->phi_count = kept;
+    }
+}
+
+static void rewrite_operands(IRFunction* f) {
+    for (int i = 0; i < f->order_count; i++) {
+        IRBlock* block = &f->blocks[f->order[i]];
+        for (int k = 0; k < block->phi_count + block->count; k++) {
+            int id = k < block->phi_count ? block->phis[k] : block->values[k - block->phi_count];
+            IRValue* v = &f->values[id];
+            for (int a = 0; a < v->arg_count; a++) v->args[a] = ir_resolve(f, v->args[a]);
+        }
+        block->term_value = ir_resolve(f, block->term_value);
+    }
+}
+
+// Junta ao bloco o sucessor que só é alcançado por ele (b termina em jump
+// e s tem um único predecessor), repetindo enquanto der: os blocos vazios
+// que sobram de ifs e laços somem.
+static void merge_blocks(IRFunction* f) {
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        IRBlock* block = &f->blocks[b];
+        if (block->rpo < 0) continue;
+        while (block->term == IR_JUMP) {
+            int s = block->succs[0];
+            IRBlock* next = &f->blocks[s];
+            if (s == b || s == 0 || next->pred_count != 1 || next->phi_count != 0) break;
+            for (int k = 0; k < next->count; k++) {
+                int id = next->values[k];
+                f->values[id].block = b;
+                block->values = grow(block->values, &block->capacity, block->count + 1, sizeof(int));
+                block->values[block->count++] = id;
+            }
+            block->term = next->term;
+            block->term_value = next->term_value;
+            block->succ_count = next->succ_count;
+            for (int k = 0; k < next->succ_count; k++) {
+                int t = next->succs[k];
+                block->succs[k] = t;
+                IRBlock* target = &f->blocks[t];
+                for (int p = 0; p < target->pred_count; p++) {
+                    if (target->preds[p] == s) target->preds[p] = b;
+                }
+            }
+            next->count = 0;
+            next->pred_count = 0;
+            next->succ_count = 0;
+            next->term = IR_OPEN;
+            next->rpo = -1;
+        }
+    }
+}
+
+static int intersect(const IRFunction* f, int a, int b) {
+    while (a != b) {
+        while (f->blocks[a].rpo > f->blocks[b].rpo) a = f->blocks[a].idom;
+        while (f->blocks[b].rpo > f->blocks[a].rpo) b = f->blocks[b].idom;
+    }
+    return a;
+}
+
+static void compute_dominators(IRFunction* f) {
+    for (int b = 0; b < f->block_count; b++) f->blocks[b].idom = IR_NONE;
+    f->blocks[0].idom = 0;
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 1; i < f->order_count; i++) {
+            IRBlock* block = &f->blocks[f->order[i]];
+            int idom = IR_NONE;
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (f->blocks[pred].idom == IR_NONE) continue;
+                idom = idom == IR_NONE ? pred : intersect(f, pred, idom);
+            }
+            if (block->idom != idom) {
+                block->idom = idom;
+                changed = 1;
+            }
+        }
+    }
+
+    // Numeração da árvore em profundidade: a domina b se o intervalo de b
+    // está dentro do de a. Filhos ficam agrupados por pai em children.
+    int n = f->block_count;
+    int* first = xmalloc(sizeof(int) * (n + 1));
+    int* children = xmalloc(sizeof(int) * n);
+    int* stack = xmalloc(sizeof(int) * n);
+    int* next = xmalloc(sizeof(int) * n);
+    memset(first, 0, sizeof(int) * (n + 1));
+    for (int i = 1; i < f->order_count; i++) first[f->blocks[f->order[i]].idom + 1]++;
+    for (int b = 0; b < n; b++) first[b + 1] += first[b];
+    for (int b = 0; b < n; b++) next[b] = first[b];
+    for (int i = 1; i < f->order_count; i++) {
+        int b = f->order[i];
+        children[next[f->blocks[b].idom]++] = b;
+    }
+    int counter = 0, top = 0;
+    stack[top++] = 0;
+    next[0] = first[0];
+    f->blocks[0].dom_pre = counter++;
+    while (top > 0) {
+        int b = stack[top - 1];
+        if (next[b] < first[b + 1]) {
+            int c = children[next[b]++];
+            next[c] = first[c];
+            f->blocks[c].dom_pre = counter++;
+            stack[top++] = c;
+        } else {
+            f->blocks[b].dom_post = counter++;
+            top--;
+        }
+    }
+    free(first);
+    free(children);
+    free(stack);
+    free(next);
+}
+
+void ir_finish(IRFunction* f) {
+    compute_order(f);
+    prune(f);
+    remove_trivial_phis(f);
+    rewrite_operands(f);
+    merge_blocks(f);
+    compute_order(f);
+    compute_dominators(f);
+}
+
+int ir_dominates(const IRFunction* f, int a, int b) {
+    const IRBlock* x = &f->blocks[a];
+    const IRBlock* y = &f->blocks[b];
+    if (x->rpo < 0 || y->rpo < 0) return 0;
+    return x->dom_pre <= y->dom_pre && y->dom_post <= x->dom_post;
+}
+
+// --- verificação ---
+
+typedef struct {
+    const IRFunction* f;
+    FILE* err;
+    int errors;
+    int* position;      // índice de cada valor no seu bloco; -1 nos phis
+} Verifier;
+
+static void problem(Verifier* v, int block, const char* what, int value) {
+    if (value == IR_NONE) {
+        fprintf(v->err, "IR inválida em %s, b%d: %s\n", v->f->name, block, what);
+    } else {
+        fprintf(v->err, "IR inválida em %s, b%d: %s (v%d)\n", v->f->name, block, what, value);
+    }
+    v->errors++;
+}
+
+// Confere que op está definido e disponível no ponto de uso: antes dele no
+// mesmo bloco (at é a posição do uso; phis vêm antes de tudo) ou num bloco
+// que domina o bloco do uso.
+static void check_operand(Verifier* v, int block, int at, int op, int user) {
+    const IRFunction* f = v->f;
+    if (op < 0 || op >= f->value_count) {
+        problem(v, block, "operando inexistente", user);
+        return;
+    }
+    const IRValue* def = &f->values[op];
+    if (def->replaced != IR_NONE || f->blocks[def->block].rpo < 0) {
+        problem(v, block, "operando removido da IR", user);
+        return;
+    }
+    if (def->block == block) {
+        if (v->position[op] >= at) problem(v, block, "uso antes da definição", user);
+    } else if (!ir_dominates(f, def->block, block)) {
+        problem(v, block, "definição não domina o uso", user);
+    }
+}
+
+static int is_string_value(const IRFunction* f, int value) {
+    return value >= 0 && value < f->value_count && f->values[value].type == TYPE_STRING;
+}
+
+static int expected_args(const IRValue* value) {
+    switch (value->op) {
+        case IR_CONST:
+        case IR_STRING:
+        case IR_PARAM:
+        case IR_LOAD:
+            return 0;
+        case IR_STORE:
+        case IR_NEG:
+        case IR_NOT:
+        case IR_ABS:
+        case IR_PRINT:
+            return 1;
+        case IR_BINARY:
+            return 2;
+        case IR_INPUT:
+            return value->arg_count <= 1 ? value->arg_count : 1;
+        default:
+            return value->arg_count;
+    }
+}
+
+static void check_types(Verifier* v, int block, int id) {
+    const IRFunction* f = v->f;
+    const IRValue* value = &f->values[id];
+    switch (value->op) {
+        case IR_NEG:
+        case IR_NOT:
+        case IR_ABS:
+            if (is_string_value(f, value->args[0])) problem(v, block, "operando string", id);
+            break;
+        case IR_BINARY: {
+            int left = is_string_value(f, value->args[0]);
+            int right = is_string_value(f, value->args[1]);
+            int strings = value->operand_type == TYPE_STRING;
+            if (left != strings || right != strings) problem(v, block, "tipos dos operandos", id);
+            break;
+        }
+        case IR_PRINT:
+        case IR_INPUT:
+            if (value->arg_count == 1 &&
+                is_string_value(f, value->args[0]) != (value->operand_type == TYPE_STRING)) {
+                problem(v, block, "tipo do operando", id);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void check_edges(Verifier* v, int b) {
+    const IRFunction* f = v->f;
+    const IRBlock* block = &f->blocks[b];
+    for (int i = 0; i < block->succ_count; i++) {
+        const IRBlock* s = &f->blocks[block->succs[i]];
+        int as_succ = 0, as_pred = 0;
+        for (int k = 0; k < block->succ_count; k++) as_succ += block->succs[k] == block->succs[i];
+        for (int k = 0; k < s->pred_count; k++) as_pred += s->preds[k] == b;
+        if (as_succ != as_pred) problem(v, b, "aresta sem o predecessor correspondente", IR_NONE);
+    }
+    for (int i = 0; i < block->pred_count; i++) {
+        const IRBlock* p = &f->blocks[block->preds[i]];
+        int found = 0;
+        for (int k = 0; k < p->succ_count; k++) found |= p->succs[k] == b;
+        if (!found) problem(v, b, "predecessor sem a aresta correspondente", IR_NONE);
+    }
+}
+
+static void check_terminator(Verifier* v, int b) {
+    const IRFunction* f = v->f;
+    const IRBlock* block = &f->blocks[b];
+    int succs = 0, needs_value = 0;
+    switch (block->term) {
+        case IR_OPEN:
+            problem(v, b, "bloco sem terminador", IR_NONE);
+            return;
+        case IR_JUMP: succs = 1; break;
+        case IR_BRANCH: succs = 2; needs_value = 1; break;
+        case IR_EXIT: needs_value = 1; break;
+        default: break;
+    }
+    if (block->succ_count != succs) problem(v, b, "número de sucessores do terminador", IR_NONE);
+    if (block->term_value == IR_NONE) {
+        if (needs_value) problem(v, b, "terminador sem valor", IR_NONE);
+        return;
+    }
+    check_operand(v, b, block->count, block->term_value, IR_NONE);
+    int string = is_string_value(f, block->term_value);
+    if (block->term == IR_RETURN) {
+        if (string != (f->return_type == TYPE_STRING)) problem(v, b, "tipo do valor retornado", IR_NONE);
+    } else if (string) {
+        problem(v, b, "condição ou código de saída string", IR_NONE);
+    }
+}
+
+int ir_verify(const IRFunction* f, FILE* err) {
+    Verifier v;
+    v.f = f;
+    v.err = err;
+    v.errors = 0;
+    v.position = xmalloc(sizeof(int) * (f->value_count ? f->value_count : 1));
+    for (int i = 0; i < f->order_count; i++) {
+        const IRBlock* block = &f->blocks[f->order[i]];
+        for (int p = 0; p < block->phi_count; p++) v.position[block->phis[p]] = -1;
+        for (int k = 0; k < block->count; k++) v.position[block->values[k]] = k;
+    }
+
+    if (f->block_count == 0 || f->blocks[0].rpo != 0) {
+        problem(&v, 0, "entrada inalcançável", IR_NONE);
+        free(v.position);
+        return v.errors;
+    }
+    if (f->blocks[0].pred_count != 0) problem(&v, 0, "entrada com predecessores", IR_NONE);
+
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        const IRBlock* block = &f->blocks[b];
+        check_edges(&v, b);
+        for (int p = 0; p < block->phi_count; p++) {
+            int id = block->phis[p];
+            const IRValue* phi = &f->values[id];
+            if (phi->op != IR_PHI || phi->block != b) problem(&v, b, "phi fora do lugar", id);
+            if (phi->arg_count != block->pred_count) {
+                problem(&v, b, "phi com operandos e predecessores em número diferente", id);
+                continue;
+            }
+            // O operando vindo de um predecessor tem de estar disponível no
+            // fim dele.
+            for (int a = 0; a < phi->arg_count; a++) {
+                int pred = block->preds[a];
+                check_operand(&v, pred, f->blocks[pred].count, phi->args[a], id);
+                if (is_string_value(f, phi->args[a]) != (phi->type == TYPE_STRING)) {
+                    problem(&v, b, "tipo do operando do phi", id);
+                }
+            }
+        }
+        for (int k = 0; k < block->count; k++) {
+            int id = block->values[k];
+            const IRValue* value = &f->values[id];
+            if (value->op == IR_PHI || value->block != b) problem(&v, b, "instrução fora do lugar", id);
+            if (value->arg_count != expected_args(value)) {
+                problem(&v, b, "número de operandos", id);
+                continue;
+            }
+            for (int a = 0; a < value->arg_count; a++) check_operand(&v, b, k, value->args[a], id);
+            check_types(&v, b, id);
+        }
+        check_terminator(&v, b);
+    }
+    free(v.position);
+    return v.errors;
+}
+
+// --- dump ---
+
+static const char* type_name(ValueType type) {
+    switch (type) {
+        case TYPE_BOOL: return "bool";
+        case TYPE_STRING: return "string";
+        default: return "int";
+    }
+}
+
+static const char* op_text(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "+";
+        case TOKEN_MINUS: return "-";
+        case TOKEN_STAR: return "*";
+        case TOKEN_SLASH: return "/";
+        case TOKEN_PERCENT: return "%";
+        case TOKEN_EQ_EQ: return "==";
+        case TOKEN_BANG_EQ: return "!=";
+        case TOKEN_LT: return "<";
+        case TOKEN_GT: return ">";
+        case TOKEN_LT_EQ: return "<=";
+        case TOKEN_GT_EQ: return ">=";
+        default: return "?";
+    }
+}
+
+static void print_value(const IRFunction* f, const SymbolTable* names, int id, FILE* out) {
+    const IRValue* v = &f->values[id];
+    if (v->op == IR_STORE) {
+        fprintf(out, "  store m%d, v%d\n", v->imm, v->args[0]);
+        return;
+    }
+    if (v->op == IR_PRINT) {
+        fprintf(out, "  print %s v%d\n", type_name(v->operand_type), v->args[0]);
+        return;
+    }
+    fprintf(out, "  v%d: %s = ", id, type_name(v->type));
+    switch (v->op) {
+        case IR_CONST: fprintf(out, "const %d", v->imm); break;
+        case IR_STRING: fprintf(out, "const \"%s\"", v->text); break;
+        case IR_PARAM: fprintf(out, "param %d", v->imm); break;
+        case IR_LOAD: fprintf(out, "load m%d", v->imm); break;
+        case IR_BINARY:
+            fprintf(out, "v%d %s v%d", v->args[0], op_text(v->binop), v->args[1]);
+            if (v->operand_type == TYPE_STRING) fprintf(out, " (string)");
+            break;
+        case IR_NEG: fprintf(out, "neg v%d", v->args[0]); break;
+        case IR_NOT: fprintf(out, "not v%d", v->args[0]); break;
+        case IR_ABS: fprintf(out, "abs v%d", v->args[0]); break;
+        case IR_INPUT:
+            fprintf(out, "input");
+            if (v->arg_count == 1) fprintf(out, " v%d", v->args[0]);
+            break;
+        case IR_CALL:
+            fprintf(out, "call %s(", names ? symtab_name(names, v->name) : "?");
+            for (int i = 0; i < v->arg_count; i++) fprintf(out, "%sv%d", i ? ", " : "", v->args[i]);
+            fprintf(out, ")");
+            break;
+        case IR_PHI: {
+            fprintf(out, "phi");
+            const IRBlock* block = &f->blocks[v->block];
+            for (int i = 0; i < v->arg_count; i++) {
+                fprintf(out, "%s [b%d: v%d]", i ? "," : "", block->preds[i], v->args[i]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    fprintf(out, "\n");
+}
+
+void ir_print(const IRFunction* f, const SymbolTable* names, FILE* out) {
+    fprintf(out, "fn %s(", f->name);
+    for (int i = 0; i < f->param_count; i++) {
+        fprintf(out, "%s%s", i ? ", " : "", type_name(f->param_types ? f->param_types[i] : TYPE_INT));
+    }
+    fprintf(out, ") -> %s\n", type_name(f->return_type));
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        const IRBlock* block = &f->blocks[b];
+        fprintf(out, "b%d:", b);
+        if (block->pred_count > 0) {
+            fprintf(out, "  ; preds");
+            for (int p = 0; p < block->pred_count; p++) fprintf(out, " b%d", block->preds[p]);
+            fprintf(out, ", idom b%d", block->idom);
+        }
+        fprintf(out, "\n");
+        for (int p = 0; p < block->phi_count; p++) print_value(f, names, block->phis[p], out);
+        for (int k = 0; k < block->count; k++) print_value(f, names, block->values[k], out);
+        switch (block->term) {
+            case IR_JUMP: fprintf(out, "  jump b%d\n", block->succs[0]); break;
+            case IR_BRANCH:
+                fprintf(out, "  branch v%d, b%d, b%d\n", block->term_value, block->succs[0], block->succs[1]);
+                break;
+            case IR_RETURN:
+                if (block->term_value == IR_NONE) fprintf(out, "  return\n");
+                else fprintf(out, "  return v%d\n", block->term_value);
+                break;
+            case IR_EXIT: fprintf(out, "  exit v%d\n", block->term_value); break;
+            case IR_END: fprintf(out, "  end\n"); break;
+            default: fprintf(out, "  ; sem terminador\n"); break;
+        }
+    }
+    fprintf(out, "\n");
+}
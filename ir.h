@@ -0,0 +1,135 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "arena.h"
+#include "symbol.h"
+
+// Representação intermediária entre a AST e o C: um grafo de fluxo de
+// controle de blocos básicos em forma SSA, uma por função (ou fragmento do
+// main, ver lower.h).
+//
+// Cada valor é definido uma única vez e identificado pelo índice em
+// values[]; as instruções de um bloco são os índices em ordem. Os phis
+// ficam numa lista à parte, no início do bloco, com um operando por
+// predecessor (args[i] chega por preds[i]). O bloco 0 é a entrada. Cada
+// bloco termina num terminador (jump, branch, return, exit ou end), que
+// define os sucessores.
+#define IR_NONE -1
+
+// Os operandos de todo valor ficam em args (alocado na arena da função).
+typedef enum {
+    IR_CONST,       // imm; int ou bool
+    IR_STRING,      // text: o literal como no source, sem as aspas
+    IR_PARAM,       // imm = índice do parâmetro
+    IR_PHI,         // um operando por predecessor
+    IR_LOAD,        // imm = slot do main guardado em memória
+    IR_STORE,       // imm = slot; guarda args[0]
+    IR_BINARY,      // args[0] binop args[1]; operand_type diz se compara
+                    // strings
+    IR_NEG,         // -args[0]
+    IR_NOT,         // !args[0]
+    IR_ABS,         // abs(args[0])
+    IR_CALL,        // name(args)
+    IR_PRINT,       // args[0], do tipo operand_type
+    IR_INPUT        // prompt opcional em args[0], do tipo operand_type
+} IROp;
+
+typedef enum {
+    IR_OPEN,        // bloco ainda em construção
+    IR_JUMP,        // succs[0]
+    IR_BRANCH,      // value ? succs[0] : succs[1]
+    IR_RETURN,      // value, ou IR_NONE (retorna 0)
+    IR_EXIT,        // exit(value)
+    IR_END          // fim de um fragmento do main: segue para o próximo
+} IRTerm;
+
+typedef struct {
+    IROp op;
+    ValueType type;
+    int block;
+    int imm;
+    TokenType binop;
+    ValueType operand_type;
+    const char* text;
+    int name;           // IR_CALL: id na tabela de símbolos
+    int* args;
+    int arg_count;
+    int replaced;       // phi trivial: o valor que o substitui, ou IR_NONE
+} IRValue;
+
+typedef struct {
+    int* values;
+    int count;
+    int capacity;
+    int* phis;
+    int phi_count;
+    int phi_capacity;
+    int* preds;
+    int pred_count;
+    int pred_capacity;
+
+    IRTerm term;
+    int term_value;
+    int succs[2];
+    int succ_count;
+
+    // Preenchidos por ir_finish; rpo é -1 nos blocos inalcançáveis.
+    int rpo;
+    int idom;
+    int dom_pre;        // intervalo do bloco na árvore de dominadores
+    int dom_post;
+} IRBlock;
+
+typedef struct {
+    const char* name;   // para o dump e as mensagens
+    int param_count;
+    const ValueType* param_types;   // NULL é tudo int
+    ValueType return_type;
+
+    IRValue* values;
+    int value_count;
+    int value_capacity;
+    IRBlock* blocks;
+    int block_count;
+    int block_capacity;
+
+    int* order;         // blocos alcançáveis em pós-ordem reversa
+    int order_count;
+
+    Arena arena;
+} IRFunction;
+
+IRFunction* ir_new(const char* name);
+void ir_free(IRFunction* f);
+
+int ir_add_block(IRFunction* f);
+// Acrescenta um valor com count operandos, ainda por preencher, ao fim do
+// bloco (phis vão para a lista de phis).
+int ir_add_value(IRFunction* f, int block, IROp op, ValueType type, int count);
+int ir_const(IRFunction* f, int block, int value, ValueType type);
+
+// Terminadores; jump e branch também ligam as arestas.
+void ir_jump(IRFunction* f, int block, int target);
+void ir_branch(IRFunction* f, int block, int cond, int if_true, int if_false);
+void ir_terminate(IRFunction* f, int block, IRTerm term, int value);
+
+// Segue a cadeia de phis substituídos até o valor que vale.
+int ir_resolve(const IRFunction* f, int value);
+// Se o phi só recebe ele mesmo e um único outro valor, marca-o como
+// substituído por esse valor e o devolve; senão devolve o próprio phi.
+int ir_simplify_phi(IRFunction* f, int phi);
+
+// Depois da construção: remove os blocos inalcançáveis e os phis triviais,
+// reescreve os operandos substituídos, junta blocos em sequência e calcula
+// a ordem dos blocos e a árvore de dominadores (Cooper, Harvey e Kennedy).
+void ir_finish(IRFunction* f);
+int ir_dominates(const IRFunction* f, int a, int b);
+
+// Confere a estrutura, os tipos e a dominância das definições sobre os
+// usos. Escreve cada problema em err e devolve quantos achou.
+int ir_verify(const IRFunction* f, FILE* err);
+void ir_print(const IRFunction* f, const SymbolTable* names, FILE* out);
+
+#endif
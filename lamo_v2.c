@@ -5,29 +5,104 @@
 #include "lexer_v2.h"
 #include "parser_v2.h"
 #include "ast.h"
+#include "source.h"
+#include "parallel.h"
+#include "stream.h"
+#include "context.h"
+#include "compact_ast.h"
+#include "cache.h"
+#include "pass.h"
+#include "resolve.h"
+#include "types.h"
+#include "fold.h"
+#include "dce.h"
+#include "inline.h"
+#include "tailcall.h"
+#include "memo.h"
+#include "consteval.h"
+#include "loop.h"
+#include "lower.h"
+#include "codegen.h"
 
 #define VERSION "2.0"
 
 void print_usage(const char* prog);
-char* read_file(const char* path);
-void generate_c_code(ASTNode* node, FILE* out);
+void generate_c_code(ASTNode* node, const SymbolTable* names, FILE* out);
 
 void print_usage(const char* prog) {
     printf("Lamo v%s - Linguagem de Programação\n\n", VERSION);
-    printf("Uso: %s <arquivo.lamo> [opções]\n\n", prog);
+    printf("Uso: %s <arquivo.lamo | -> [opções]\n\n", prog);
+    printf("Opções:\n");
+    printf("  --no-token-buffer  Lexa sob demanda em vez de pré-tokenizar o arquivo\n");
+    printf("  --dump-tokens      Imprime o fluxo de tokens e sai\n");
+    printf("  -j N               Lexa e parseia as funções em N threads\n");
+    printf("  --stream           Gera o código declaração a declaração, com memória constante\n");
+    printf("  --compact          Guarda a AST na forma compacta (arrays e índices); sem -j os passes\n");
+    printf("                     rodam por declaração, como no --stream: sem inline, sem chamadas\n");
+    printf("                     avaliadas na compilação e sem remover funções nunca chamadas\n");
+    printf("  --cache            Reusa a AST de um .lamoc quando o source não mudou (implica --compact)\n");
+    printf("  --mem-stats        Mostra nós e memória usados por arena\n");
+    printf("  --no-fold          Não dobra nem propaga constantes\n");
+    printf("  --no-consteval     Não executa na compilação chamadas puras com argumentos constantes\n");
+    printf("  --consteval-fuel N Passos do interpretador por chamada (padrão %d)\n", CONSTEVAL_FUEL);
+    printf("  --no-dce           Não remove código morto nem funções nunca chamadas\n");
+    printf("  --no-inline        Não expande funções pequenas no lugar das chamadas\n");
+    printf("  --no-tail-calls    Não transforma a recursão de cauda em laço\n");
+    printf("  --no-loop-opt      Não move expressões invariantes para fora dos laços\n");
+    printf("  --no-cse           Não reaproveita expressões repetidas dentro de um bloco\n");
+    printf("  --strength-reduce  Troca i * c em laços for por uma variável somada a cada volta\n");
+    printf("  --no-memo          Não gera cache para funções puras recursivas nem com @memo\n");
+    printf("  --memo-size N      Entradas do cache de cada função (potência de 2, padrão %d)\n", MEMO_ENTRIES);
+    printf("  --memo-stats       O programa mostra acertos e faltas de cada cache ao sair\n");
+    printf("  --check-overflow   Aritmética que pode estourar encerra o programa com erro\n");
+    printf("  --narrow-types     Guarda em char ou short as variáveis de intervalo pequeno\n");
+    printf("  --range-stats      Mostra quantas operações aritméticas não podem estourar\n");
+    printf("  --time-passes      Mostra o tempo de cada passe sobre a AST\n");
+    printf("  --dump-ir          Imprime a IR de cada função antes de gerar o C\n");
+    printf("  --verify-ir        Confere a IR de cada função antes de gerar o C\n");
 }
 
-char* read_file(const char* path) {
-    FILE* f = fopen(path, "r");
-    if (!f) return NULL;
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    char* content = malloc(size + 1);
-    fread(content, 1, size, f);
-    content[size] = '\0';
-    fclose(f);
-    return content;
+static void dump_tokens(const Lexer* lexer, const TokenBuffer* tb) {
+    for (int i = 0; i < tb->count; i++) {
+        Token t = token_buffer_get(tb, i);
+        printf("%d:%d\t%-10s\t%.*s\n", t.line, t.column, token_type_name(t.type),
+               t.length, token_text(lexer, t));
+    }
+}
+
+static ASTProgram* build_ast(CompileContext* ctx, const SourceFile* source, int threads, int use_token_buffer,
+                             PassManager* passes) {
+    ASTProgram* program;
+    if (threads > 1) {
+        program = parse_program_parallel(ctx, source->data, (int)source->length, threads);
+    } else {
+        Arena* arena = context_new_arena(ctx, "ast");
+        Lexer* lexer = lexer_init_symbols(source->data, (int)source->length, ctx->symbols);
+        TokenBuffer* tokens = use_token_buffer ? token_buffer_build(lexer) : NULL;
+        Parser* parser = tokens ? parser_init_tokens(lexer, tokens, arena) : parser_init(lexer, arena);
+        program = parse_program_v2(parser);
+    }
+    pass_manager_run(passes, program);
+    return program;
+}
+
+static CompactAST* build_compact(CompileContext* ctx, const SourceFile* source, int threads, int use_token_buffer,
+                                 PassManager* passes) {
+    if (threads > 1) {
+        return compact_from_program(build_ast(ctx, source, threads, use_token_buffer, passes), ctx->symbols);
+    }
+    Lexer* lexer = lexer_init_symbols(source->data, (int)source->length, ctx->symbols);
+    TokenBuffer* tokens = use_token_buffer ? token_buffer_build(lexer) : NULL;
+    Arena* arena = context_new_arena(ctx, "ast");
+    Parser* parser = tokens ? parser_init_tokens(lexer, tokens, arena) : parser_init(lexer, arena);
+    return compact_parse_program(parser, passes);
+}
+
+// Erros semânticos encerram a compilação antes do gcc.
+static int check_semantics(Resolver* resolver, Typer* typer) {
+    int errors = resolver_finish(resolver) + typer_stats(typer)->errors;
+    if (errors > 0) fprintf(stderr, "\n%d erro(s) semântico(s)\n", errors);
+    return errors;
 }
 
 int main(int argc, char** argv) {
@@ -37,28 +112,280 @@ int main(int argc, char** argv) {
     }
     
     char* input_file = argv[1];
-    char* source = read_file(input_file);
-    if (!source) return 1;
-    
-    printf("Compilando %s...\n", input_file);
-    
-    Lexer* lexer = lexer_init(source);
-    Parser* parser = parser_init(lexer);
+    int use_token_buffer = 1;
+    int only_tokens = 0;
+    int threads = 1;
+    int streaming = 0;
+    int mem_stats = 0;
+    int compact = 0;
+    int use_cache = 0;
+    int time_passes = 0;
+    int fold = 1;
+    int consteval = 1;
+    int consteval_fuel = CONSTEVAL_FUEL;
+    int dce = 1;
+    int inline_calls = 1;
+    int tail_calls = 1;
+    int loop_opt = 1;
+    int strength_reduce = 0;
+    int memo = 1;
+    int memo_entries = MEMO_ENTRIES;
+    int memo_stats = 0;
+    int check_overflow = 0;
+    int narrow_types = 0;
+    int range_stats = 0;
+    int dump_ir = 0;
+    int verify_ir = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--no-token-buffer") == 0) {
+            use_token_buffer = 0;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            streaming = 1;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char* n = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            threads = atoi(n);
+            if (threads < 1) {
+                fprintf(stderr, "Número de threads inválido: %s\n", n);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--compact") == 0) {
+            compact = 1;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
+            compact = 1;
+        } else if (strcmp(argv[i], "--mem-stats") == 0) {
+            mem_stats = 1;
+        } else if (strcmp(argv[i], "--no-fold") == 0) {
+            fold = 0;
+        } else if (strcmp(argv[i], "--no-cse") == 0) {
+            lower_set_cse(0);
+        } else if (strcmp(argv[i], "--no-consteval") == 0) {
+            consteval = 0;
+        } else if (strcmp(argv[i], "--consteval-fuel") == 0) {
+            const char* n = i + 1 < argc ? argv[++i] : "";
+            consteval_fuel = atoi(n);
+            if (consteval_fuel < 1) {
+                fprintf(stderr, "Fuel inválido: %s\n", n);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-dce") == 0) {
+            dce = 0;
+        } else if (strcmp(argv[i], "--no-inline") == 0) {
+            inline_calls = 0;
+        } else if (strcmp(argv[i], "--no-tail-calls") == 0) {
+            tail_calls = 0;
+        } else if (strcmp(argv[i], "--no-loop-opt") == 0) {
+            loop_opt = 0;
+        } else if (strcmp(argv[i], "--strength-reduce") == 0) {
+            strength_reduce = 1;
+        } else if (strcmp(argv[i], "--no-memo") == 0) {
+            memo = 0;
+        } else if (strcmp(argv[i], "--memo-size") == 0) {
+            const char* n = i + 1 < argc ? argv[++i] : "";
+            memo_entries = atoi(n);
+            if (memo_entries < 1 || memo_entries > (1 << 24) || (memo_entries & (memo_entries - 1)) != 0) {
+                fprintf(stderr, "Tamanho de cache inválido (potência de 2 até 16777216): %s\n", n);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--memo-stats") == 0) {
+            memo_stats = 1;
+        } else if (strcmp(argv[i], "--check-overflow") == 0) {
+            check_overflow = 1;
+        } else if (strcmp(argv[i], "--narrow-types") == 0) {
+            narrow_types = 1;
+        } else if (strcmp(argv[i], "--range-stats") == 0) {
+            range_stats = 1;
+        } else if (strcmp(argv[i], "--time-passes") == 0) {
+            time_passes = 1;
+        } else if (strcmp(argv[i], "--dump-ir") == 0) {
+            dump_ir = 1;
+        } else if (strcmp(argv[i], "--verify-ir") == 0) {
+            verify_ir = 1;
+        } else if (strcmp(argv[i], "--dump-tokens") == 0) {
+            only_tokens = 1;
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    SourceFile* source = source_open(input_file);
+    if (!source) {
+        perror(input_file);
+        return 1;
+    }
     
-    printf("Construindo AST...\n");
-    ASTProgram* program_ast = parse_program_v2(parser);
-    printf("[OK] AST construída em %p\n", (void*)program_ast);
+    if (only_tokens) {
+        Lexer* lexer = lexer_init_n(source->data, (int)source->length);
+        TokenBuffer* tokens = token_buffer_build(lexer);
+        dump_tokens(lexer, tokens);
+        return 0;
+    }
+
+    printf("Compilando %s...\n", source->name);
 
     FILE* out = fopen("lamo_exec.c", "w");
     if (!out) return 1;
-    
-    printf("Gerando código C...\n");
-    generate_c_code((ASTNode*)program_ast, out);
+    codegen_set_ir_options(dump_ir ? stdout : NULL, verify_ir);
+    codegen_set_memo_options(memo_entries, memo_stats);
+    codegen_set_range_options(check_overflow, narrow_types, range_stats);
+
+    CompileContext* ctx = context_new();
+    // Passes sobre a AST, fundidos numa travessia. A otimização de laços e a
+    // expansão de funções vêm antes do resolvedor, que resolve os nomes que
+    // elas criam; a inferência de tipos e a dobra usam os slots do
+    // resolvedor, então vêm depois dele, e a avaliação de chamadas
+    // constantes depois da dobra dos argumentos; a eliminação de código
+    // morto vem em seguida para ver as condições já dobradas e as funções
+    // que deixaram de ser chamadas; a memoização conta as
+    // chamadas recursivas antes que a recursão de cauda vire laço, por
+    // último, sobre o corpo já limpo.
+    PassManager* passes = pass_manager_new();
+    // No streaming, os nós que a otimização de laços e a recursão de cauda
+    // criam fazem parte da declaração atual: vão para a arena do parser,
+    // reiniciada depois de cada uma (stream.h).
+    Arena* stream_arena = streaming ? context_new_arena(ctx, "ast") : NULL;
+    LoopOpt* loops = loop_opt ? loop_opt_new(ctx->symbols, stream_arena ? stream_arena : context_new_arena(ctx, "loop"),
+                                             strength_reduce, check_overflow)
+                              : NULL;
+    if (loops) {
+        Pass pass = loop_opt_pass(loops);
+        pass_manager_add(passes, &pass);
+    }
+    Inliner* inliner = inline_calls ? inliner_new(ctx->symbols, context_new_arena(ctx, "inline"), INLINE_BUDGET) : NULL;
+    if (inliner) {
+        Pass pass = inliner_pass(inliner);
+        pass_manager_add(passes, &pass);
+    }
+    Resolver* resolver = resolver_new(ctx->symbols);
+    Pass resolve = resolver_pass(resolver);
+    pass_manager_add(passes, &resolve);
+    Typer* typer = typer_new(context_new_arena(ctx, "types"));
+    Pass types = typer_pass(typer);
+    pass_manager_add(passes, &types);
+    Folder* folder = fold ? folder_new(check_overflow) : NULL;
+    if (folder) {
+        Pass pass = folder_pass(folder);
+        pass_manager_add(passes, &pass);
+    }
+    ConstEval* const_eval = consteval ? consteval_new(consteval_fuel, check_overflow) : NULL;
+    if (const_eval) {
+        Pass pass = consteval_pass(const_eval);
+        pass_manager_add(passes, &pass);
+    }
+    DeadCode* dead_code = dce ? dce_new() : NULL;
+    if (dead_code) {
+        Pass pass = dce_pass(dead_code);
+        pass_manager_add(passes, &pass);
+    }
+    Memoizer* memoizer = memo ? memoizer_new() : NULL;
+    if (memoizer) {
+        Pass pass = memoizer_pass(memoizer);
+        pass_manager_add(passes, &pass);
+    }
+    TailCalls* tail = tail_calls ? tail_calls_new(ctx->symbols,
+                                                  stream_arena ? stream_arena : context_new_arena(ctx, "tailcall"))
+                                 : NULL;
+    if (tail) {
+        Pass pass = tail_calls_pass(tail);
+        pass_manager_add(passes, &pass);
+    }
+
+    if (streaming) {
+        // Lexa sob demanda: um buffer de tokens cresceria com o arquivo.
+        Lexer* lexer = lexer_init_symbols(source->data, (int)source->length, ctx->symbols);
+        Parser* parser = parser_init(lexer, stream_arena);
+        printf("Gerando código C em modo streaming...\n");
+        if (compile_streaming(parser, passes, out) != 0 || check_semantics(resolver, typer) > 0) {
+            fclose(out);
+            return 1;
+        }
+    } else if (compact) {
+        CompactAST* cast = NULL;
+        char* cache_file = NULL;
+        uint64_t hash = 0;
+        uint64_t config = 0;
+        if (use_cache) {
+            // O cache guarda a AST depois dos passes: vale só para as mesmas
+            // opções que os configuram.
+            char options[160];
+            int length = snprintf(options, sizeof(options),
+                                  "loop=%d reduce=%d checked=%d inline=%d/%d fold=%d consteval=%d/%d dce=%d "
+                                  "memo=%d tail=%d",
+                                  loop_opt, strength_reduce, check_overflow, inline_calls, INLINE_BUDGET, fold,
+                                  consteval, consteval_fuel, dce, memo, tail_calls);
+            config = cache_hash(options, (size_t)length);
+            hash = cache_hash(source->data, source->length);
+            cache_file = cache_path(source, hash);
+            if (cache_file) cast = cache_load(cache_file, hash, source->length, config, ctx->symbols);
+            if (cast) printf("[OK] AST carregada do cache %s\n", cache_file);
+        }
+        if (!cast) {
+            printf("Construindo AST compacta...\n");
+            cast = build_compact(ctx, source, threads, use_token_buffer, passes);
+            if (check_semantics(resolver, typer) > 0) {
+                fclose(out);
+                return 1;
+            }
+            if (cache_file && cache_save(cast, hash, source->length, config, cache_file) != 0) {
+                fprintf(stderr, "Aviso: não foi possível gravar o cache %s\n", cache_file);
+            }
+        }
+        free(cache_file);
+        printf("[OK] AST compacta: %u nós, %zu bytes\n", cast->count - 1, compact_bytes(cast));
+
+        printf("Gerando código C...\n");
+        compact_generate_c_code(cast, out);
+        compact_free(cast);
+    } else {
+        printf("Construindo AST...\n");
+        ASTProgram* program_ast = build_ast(ctx, source, threads, use_token_buffer, passes);
+        if (check_semantics(resolver, typer) > 0) {
+            fclose(out);
+            return 1;
+        }
+        printf("[OK] AST construída em %p\n", (void*)program_ast);
+
+        printf("Gerando código C...\n");
+        generate_c_code((ASTNode*)program_ast, ctx->symbols, out);
+    }
     fclose(out);
+    // Só depois dos erros semânticos: no streaming a IR de um programa com
+    // erro é gerada antes de eles aparecerem.
+    if (codegen_ir_errors() > 0) {
+        fprintf(stderr, "Erro interno: %d problema(s) na IR\n", codegen_ir_errors());
+        return 1;
+    }
     
     printf("[OK] Código C gerado: lamo_exec.c\n");
+    if (range_stats) {
+        const RangeStats* r = codegen_range_stats();
+        printf("[OK] Aritmética sem estouro: %d de %d operações (%.1f%%), %d variáveis estreitadas\n",
+               r->safe, r->arithmetic, r->arithmetic ? 100.0 * r->safe / r->arithmetic : 100.0, r->narrowed);
+    }
+    if (time_passes) pass_manager_report(passes, stdout);
+    if (mem_stats) {
+        context_report(ctx, stdout);
+        const LowerStats* l = lower_stats();
+        printf("IR: %ld valores, %ld expressões compartilhadas (%zu bytes a menos)\n",
+               l->values, l->shared, (size_t)l->shared * sizeof(IRValue));
+    }
+    pass_manager_free(passes);
+    tail_calls_free(tail);
+    memoizer_free(memoizer);
+    dce_free(dead_code);
+    consteval_free(const_eval);
+    folder_free(folder);
+    typer_free(typer);
+    resolver_free(resolver);
+    inliner_free(inliner);
+    loop_opt_free(loops);
+    context_free(ctx);
+    source_close(source);
     
-    system("gcc -Wall -o lamo_exec lamo_exec.c");
+    // Variáveis que a dobra deixou sem leitura não são problema do usuário.
+    system("gcc -Wall -Wno-unused-variable -o lamo_exec lamo_exec.c");
     printf("\n--- Executando ---\n");
     #ifdef _WIN32
     system("lamo_exec.exe");
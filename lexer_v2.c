@@ -2,28 +2,298 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <stdint.h>
 #include "lexer_v2.h"
 
-static char* my_strndup(const char* s, size_t n) {
-    char* res = malloc(n + 1);
-    if (res) {
-        memcpy(res, s, n);
-        res[n] = '\0';
+// -DLAMO_NO_SIMD força o caminho escalar.
+#if defined(__AVX2__) && !defined(LAMO_NO_SIMD)
+#include <immintrin.h>
+#elif defined(__SSE2__) && !defined(LAMO_NO_SIMD)
+#include <emmintrin.h>
+#endif
+
+// Classes de caracteres: uma consulta de tabela em vez de isspace/isalpha,
+// que dependem de locale e não são inlináveis.
+enum {
+    CC_SPACE = 1,
+    CC_DIGIT = 2,
+    CC_ALPHA = 4      // letras ASCII e '_'
+};
+
+#define S CC_SPACE
+#define D CC_DIGIT
+#define A CC_ALPHA
+static const unsigned char char_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, S, S, S, S, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+#undef S
+#undef D
+#undef A
+
+#define CLASS(c) char_class[(unsigned char)(c)]
+#define IS_IDENT(c) (CLASS(c) & (CC_ALPHA | CC_DIGIT))
+
+// ---------------------------------------------------------------------------
+// Varredura em blocos de 16 (SSE2) ou 32 (AVX2) bytes. Cada função devolve a
+// posição do primeiro byte que encerra a sequência. Os blocos só são lidos
+// enquanto cabem inteiros em [pos, end); o resto fica com o caminho escalar.
+// ---------------------------------------------------------------------------
+
+#if defined(__AVX2__) && !defined(LAMO_NO_SIMD)
+#define SIMD_WIDTH 32
+typedef __m256i simd_vec;
+#define simd_load(p)     _mm256_loadu_si256((const __m256i*)(p))
+#define simd_splat(c)    _mm256_set1_epi8(c)
+#define simd_eq(v, c)    _mm256_cmpeq_epi8((v), _mm256_set1_epi8(c))
+#define simd_gt(v, c)    _mm256_cmpgt_epi8((v), _mm256_set1_epi8(c))
+#define simd_lt(v, c)    _mm256_cmpgt_epi8(_mm256_set1_epi8(c), (v))
+#define simd_or(a, b)    _mm256_or_si256((a), (b))
+#define simd_and(a, b)   _mm256_and_si256((a), (b))
+#define simd_mask(v)     ((uint32_t)_mm256_movemask_epi8(v))
+#define SIMD_FULL        0xFFFFFFFFu
+#elif defined(__SSE2__) && !defined(LAMO_NO_SIMD)
+#define SIMD_WIDTH 16
+typedef __m128i simd_vec;
+#define simd_load(p)     _mm_loadu_si128((const __m128i*)(p))
+#define simd_splat(c)    _mm_set1_epi8(c)
+#define simd_eq(v, c)    _mm_cmpeq_epi8((v), _mm_set1_epi8(c))
+#define simd_gt(v, c)    _mm_cmpgt_epi8((v), _mm_set1_epi8(c))
+#define simd_lt(v, c)    _mm_cmplt_epi8((v), _mm_set1_epi8(c))
+#define simd_or(a, b)    _mm_or_si128((a), (b))
+#define simd_and(a, b)   _mm_and_si128((a), (b))
+#define simd_mask(v)     ((uint32_t)_mm_movemask_epi8(v))
+#define SIMD_FULL        0xFFFFu
+#endif
+
+#ifdef SIMD_WIDTH
+// Comparações com sinal: bytes >= 0x80 ficam negativos e nunca casam.
+static inline uint32_t mask_space(simd_vec v) {
+    return simd_mask(simd_or(simd_eq(v, ' '),
+                             simd_and(simd_gt(v, '\t' - 1), simd_lt(v, '\r' + 1))));
+}
+
+static inline uint32_t mask_ident(simd_vec v) {
+    simd_vec lower = simd_or(v, simd_splat(0x20));
+    simd_vec alpha = simd_and(simd_gt(lower, 'a' - 1), simd_lt(lower, 'z' + 1));
+    simd_vec digit = simd_and(simd_gt(v, '0' - 1), simd_lt(v, '9' + 1));
+    return simd_mask(simd_or(simd_or(alpha, digit), simd_eq(v, '_')));
+}
+#endif
+
+static int scan_space(const char* s, int pos, int end) {
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        uint32_t stop = ~mask_space(simd_load(s + pos)) & SIMD_FULL;
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && (CLASS(s[pos]) & CC_SPACE)) pos++;
+    return pos;
+}
+
+static int scan_ident(const char* s, int pos, int end) {
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        uint32_t stop = ~mask_ident(simd_load(s + pos)) & SIMD_FULL;
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && IS_IDENT(s[pos])) pos++;
+    return pos;
+}
+
+// Corpo de comentário de linha: para no '\n' ou em '\0'.
+static int scan_line(const char* s, int pos, int end) {
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        simd_vec v = simd_load(s + pos);
+        uint32_t stop = simd_mask(simd_or(simd_eq(v, '\n'), simd_eq(v, '\0')));
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && s[pos] != '\n' && s[pos] != '\0') pos++;
+    return pos;
+}
+
+// Corpo de comentário de bloco: devolve a posição do '*' de "*/" (ou de '\0').
+static int scan_block_comment(const char* s, int pos, int end) {
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        simd_vec v = simd_load(s + pos);
+        uint32_t cand = simd_mask(simd_or(simd_eq(v, '*'), simd_eq(v, '\0')));
+        while (cand) {
+            int i = pos + __builtin_ctz(cand);
+            if (s[i] == '\0' || s[i + 1] == '/') return i;
+            cand &= cand - 1;
+        }
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && s[pos] != '\0' && !(s[pos] == '*' && s[pos + 1] == '/')) pos++;
+    return pos;
+}
+
+// Corpo de string: para em '"', '\\' ou '\0'; o escape fica com o chamador.
+static int scan_string(const char* s, int pos, int end) {
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= end) {
+        simd_vec v = simd_load(s + pos);
+        uint32_t stop = simd_mask(simd_or(simd_or(simd_eq(v, '"'), simd_eq(v, '\\')),
+                                          simd_eq(v, '\0')));
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += SIMD_WIDTH;
+    }
+#endif
+    while (pos < end && s[pos] != '"' && s[pos] != '\\' && s[pos] != '\0') pos++;
+    return pos;
+}
+
+// Move o lexer até new_pos, contando as quebras de linha no caminho.
+static void move_to(Lexer* l, int new_pos) {
+    const char* s = l->source;
+    int pos = l->pos;
+    int last_nl = -1;
+    int lines = 0;
+#ifdef SIMD_WIDTH
+    while (pos + SIMD_WIDTH <= new_pos) {
+        uint32_t nl = simd_mask(simd_eq(simd_load(s + pos), '\n'));
+        if (nl) {
+            lines += __builtin_popcount(nl);
+            last_nl = pos + 31 - __builtin_clz(nl);
+        }
+        pos += SIMD_WIDTH;
+    }
+#endif
+    for (; pos < new_pos; pos++) {
+        if (s[pos] == '\n') {
+            lines++;
+            last_nl = pos;
+        }
+    }
+    if (lines) {
+        l->line += lines;
+        l->column = new_pos - last_nl;
+    } else {
+        l->column += new_pos - l->pos;
+    }
+    l->pos = new_pos;
+}
+
+// Palavras-chave por tamanho + primeiro caractere: no máximo um memcmp.
+static TokenType keyword_type(const char* s, int n) {
+#define KW(word, tok) if (memcmp(s, word, n) == 0) return tok; break
+    switch (n) {
+        case 2:
+            switch (s[0]) {
+                case 'f': KW("fn", TOKEN_FN);
+                case 'i': KW("if", TOKEN_IF);
+            }
+            break;
+        case 3:
+            switch (s[0]) {
+                case 'l': KW("let", TOKEN_LET);
+                case 'f': KW("for", TOKEN_FOR);
+                case 'a': KW("abs", TOKEN_ABS);
+            }
+            break;
+        case 4:
+            switch (s[0]) {
+                case 'e':
+                    if (memcmp(s, "else", 4) == 0) return TOKEN_ELSE;
+                    KW("exit", TOKEN_EXIT);
+                case 't': KW("true", TOKEN_TRUE);
+            }
+            break;
+        case 5:
+            switch (s[0]) {
+                case 'w': KW("while", TOKEN_WHILE);
+                case 'p': KW("print", TOKEN_PRINT);
+                case 'i': KW("input", TOKEN_INPUT);
+                case 'f': KW("false", TOKEN_FALSE);
+            }
+            break;
+        case 6:
+            if (s[0] == 'r' && memcmp(s, "return", 6) == 0) return TOKEN_RETURN;
+            break;
+        case 8:
+            if (s[0] == 'i' && s[1] == 's' && s[2] == 'n' && memcmp(s, "isnumber", 8) == 0) return TOKEN_ISNUMBER;
+            if (s[0] == 'i' && s[1] == 's' && s[2] == 's' && memcmp(s, "isstring", 8) == 0) return TOKEN_ISSTRING;
+            break;
+    }
+#undef KW
+    return TOKEN_IDENTIFIER;
+}
+
+Lexer* lexer_init(const char* source) {
+    return lexer_init_n(source, (int)strlen(source));
+}
+
+// source[length] precisa ser '\0'.
+Lexer* lexer_init_n(const char* source, int length) {
+    return lexer_init_range(source, 0, length, 1, 1);
+}
+
+// Tabela nova com as palavras-chave nos primeiros ids, na mesma ordem de
+// TokenType: o id de uma palavra-chave é o próprio tipo do token.
+SymbolTable* lexer_new_symbols(void) {
+    SymbolTable* st = symtab_new();
+    for (int k = TOKEN_LET; k <= TOKEN_FALSE; k++) {
+        const char* kw = token_type_name((TokenType)k);
+        symtab_intern(st, kw, (int)strlen(kw));
     }
-    return res;
+    return st;
+}
+
+// Lexa só source[start, end), começando na linha/coluna informadas. end deve
+// cair no início de um token (ou no '\0' final): nenhum token atravessa o
+// limite, e ao alcançá-lo o lexer devolve EOF.
+Lexer* lexer_init_range(const char* source, int start, int end, int line, int column) {
+    Lexer* l = malloc(sizeof(Lexer));
+    l->source = source;
+    l->end = end;
+    l->pos = start;
+    l->line = line;
+    l->column = column;
+    l->symbols = lexer_new_symbols();
+    l->owns_symbols = 1;
+    return l;
 }
 
-Lexer* lexer_init(char* source) {
+// Interna na tabela dada (criada por lexer_new_symbols), que continua sendo
+// do chamador e sobrevive ao lexer.
+Lexer* lexer_init_symbols(const char* source, int length, SymbolTable* symbols) {
     Lexer* l = malloc(sizeof(Lexer));
     l->source = source;
+    l->end = length;
     l->pos = 0;
     l->line = 1;
     l->column = 1;
+    l->symbols = symbols;
+    l->owns_symbols = 0;
     return l;
 }
 
 void lexer_free(Lexer* lexer) {
+    if (!lexer) return;
+    if (lexer->owns_symbols) symtab_free(lexer->symbols);
     free(lexer);
 }
 
@@ -31,28 +301,27 @@ static char peek(Lexer* l) {
     return l->source[l->pos];
 }
 
-static char advance(Lexer* l) {
-    char c = l->source[l->pos++];
-    if (c == '\n') {
-        l->line++;
-        l->column = 1;
-    } else {
-        l->column++;
-    }
-    return c;
+// Avança um caractere que não é '\n'.
+static void advance(Lexer* l) {
+    l->pos++;
+    l->column++;
 }
 
 static void skip_whitespace(Lexer* l) {
+    const char* s = l->source;
     while (1) {
         char c = peek(l);
-        if (isspace(c)) {
-            advance(l);
-        } else if (c == '/' && l->source[l->pos + 1] == '/') {
-            while (peek(l) != '\n' && peek(l) != '\0') advance(l);
-        } else if (c == '/' && l->source[l->pos + 1] == '*') {
-            advance(l); advance(l);
-            while (!(peek(l) == '*' && l->source[l->pos + 1] == '/') && peek(l) != '\0') advance(l);
-            if (peek(l) != '\0') { advance(l); advance(l); }
+        if (CLASS(c) & CC_SPACE) {
+            move_to(l, scan_space(s, l->pos, l->end));
+        } else if (c == '/' && s[l->pos + 1] == '/') {
+            // Sem quebras de linha antes do '\n' final: só a coluna muda.
+            int end = scan_line(s, l->pos + 2, l->end);
+            l->column += end - l->pos;
+            l->pos = end;
+        } else if (c == '/' && s[l->pos + 1] == '*') {
+            int end = scan_block_comment(s, l->pos + 2, l->end);
+            if (s[end] != '\0') end += 2;
+            move_to(l, end);
         } else {
             break;
         }
@@ -65,122 +334,113 @@ Token lexer_next_token(Lexer* l) {
     Token t;
     t.line = l->line;
     t.column = l->column;
-    t.value = NULL;
+    t.start = l->pos;
+    t.length = 0;
+    t.symbol = -1;
 
+    const char* s = l->source;
     char c = peek(l);
-    if (c == '\0') {
+    if (c == '\0' || l->pos >= l->end) {
         t.type = TOKEN_EOF;
-        t.value = strdup("EOF");
         return t;
     }
 
-    if (isdigit(c)) {
-        int start = l->pos;
-        while (isdigit(peek(l))) advance(l);
+    unsigned char cls = CLASS(c);
+    if (cls & CC_DIGIT) {
+        int end = l->pos + 1;
+        while (CLASS(s[end]) & CC_DIGIT) end++;
         t.type = TOKEN_INT;
-        t.value = my_strndup(&l->source[start], l->pos - start);
+        t.length = end - t.start;
+        l->column += t.length;
+        l->pos = end;
         return t;
     }
 
-    if (isalpha(c) || c == '_') {
-        int start = l->pos;
-        while (isalnum(peek(l)) || peek(l) == '_') advance(l);
-        t.value = my_strndup(&l->source[start], l->pos - start);
-        
-        if (strcmp(t.value, "let") == 0) t.type = TOKEN_LET;
-        else if (strcmp(t.value, "fn") == 0) t.type = TOKEN_FN;
-        else if (strcmp(t.value, "return") == 0) t.type = TOKEN_RETURN;
-        else if (strcmp(t.value, "if") == 0) t.type = TOKEN_IF;
-        else if (strcmp(t.value, "else") == 0) t.type = TOKEN_ELSE;
-        else if (strcmp(t.value, "while") == 0) t.type = TOKEN_WHILE;
-        else if (strcmp(t.value, "for") == 0) t.type = TOKEN_FOR;
-        else if (strcmp(t.value, "print") == 0) t.type = TOKEN_PRINT;
-        else if (strcmp(t.value, "input") == 0) t.type = TOKEN_INPUT;
-        else if (strcmp(t.value, "isnumber") == 0) t.type = TOKEN_ISNUMBER;
-        else if (strcmp(t.value, "isstring") == 0) t.type = TOKEN_ISSTRING;
-        else if (strcmp(t.value, "exit") == 0) t.type = TOKEN_EXIT;
-        else if (strcmp(t.value, "abs") == 0) t.type = TOKEN_ABS;
-        else if (strcmp(t.value, "true") == 0) t.type = TOKEN_TRUE;
-        else if (strcmp(t.value, "false") == 0) t.type = TOKEN_FALSE;
-        else t.type = TOKEN_IDENTIFIER;
-        
+    if (cls & CC_ALPHA) {
+        int end = scan_ident(s, l->pos + 1, l->end);
+        t.length = end - t.start;
+        l->column += t.length;
+        l->pos = end;
+        t.type = keyword_type(&s[t.start], t.length);
+        t.symbol = t.type == TOKEN_IDENTIFIER
+            ? symtab_intern(l->symbols, &s[t.start], t.length)
+            : (int)t.type;
         return t;
     }
 
     if (c == '"') {
-printf("DEBUG: Found quote at %d\n", l->pos);
         advance(l);
-        int start = l->pos;
-        while (peek(l) != '\0') {
-            if (peek(l) == '\\' && l->source[l->pos + 1] == '"') {
-                advance(l); advance(l);
-            } else if (peek(l) == '"') {
-                break;
+        t.start = l->pos;
+        int end = l->pos;
+        while (1) {
+            end = scan_string(s, end, l->end);
+            if (s[end] == '\\') {
+                end += s[end + 1] == '"' ? 2 : 1;
             } else {
-                advance(l);
+                break;
             }
         }
+        move_to(l, end);
         t.type = TOKEN_STRING;
-        t.value = my_strndup(&l->source[start], l->pos - start);
+        t.length = l->pos - t.start;
         if (peek(l) == '"') advance(l);
         return t;
     }
 
     advance(l);
     switch (c) {
-        case '(': t.type = TOKEN_LPAREN; t.value = strdup("("); break;
-        case ')': t.type = TOKEN_RPAREN; t.value = strdup(")"); break;
-        case '{': t.type = TOKEN_LBRACE; t.value = strdup("{"); break;
-        case '}': t.type = TOKEN_RBRACE; t.value = strdup("}"); break;
-        case '[': t.type = TOKEN_LBRACKET; t.value = strdup("["); break;
-        case ']': t.type = TOKEN_RBRACKET; t.value = strdup("]"); break;
-        case ',': t.type = TOKEN_COMMA; t.value = strdup(","); break;
-        case ';': t.type = TOKEN_SEMICOLON; t.value = strdup(";"); break;
-        case ':': t.type = TOKEN_COLON; t.value = strdup(":"); break;
+        case '(': t.type = TOKEN_LPAREN; break;
+        case ')': t.type = TOKEN_RPAREN; break;
+        case '{': t.type = TOKEN_LBRACE; break;
+        case '}': t.type = TOKEN_RBRACE; break;
+        case '[': t.type = TOKEN_LBRACKET; break;
+        case ']': t.type = TOKEN_RBRACKET; break;
+        case ',': t.type = TOKEN_COMMA; break;
+        case ';': t.type = TOKEN_SEMICOLON; break;
+        case ':': t.type = TOKEN_COLON; break;
+        case '@': t.type = TOKEN_AT; break;
         case '+':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_PLUS_EQ; t.value = strdup("+="); }
-            else if (peek(l) == '+') { advance(l); t.type = TOKEN_PLUS_PLUS; t.value = strdup("++"); }
-            else { t.type = TOKEN_PLUS; t.value = strdup("+"); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_PLUS_EQ; }
+            else if (peek(l) == '+') { advance(l); t.type = TOKEN_PLUS_PLUS; }
+            else { t.type = TOKEN_PLUS; }
             break;
         case '-':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_MINUS_EQ; t.value = strdup("-="); }
-            else if (peek(l) == '-') { advance(l); t.type = TOKEN_MINUS_MINUS; t.value = strdup("--"); }
-            else { t.type = TOKEN_MINUS; t.value = strdup("-"); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_MINUS_EQ; }
+            else if (peek(l) == '-') { advance(l); t.type = TOKEN_MINUS_MINUS; }
+            else { t.type = TOKEN_MINUS; }
             break;
-        case '*': t.type = TOKEN_STAR; t.value = strdup("*"); break;
-        case '/': t.type = TOKEN_SLASH; t.value = strdup("/"); break;
-        case '%': t.type = TOKEN_PERCENT; t.value = strdup("%"); break;
+        case '*': t.type = TOKEN_STAR; break;
+        case '/': t.type = TOKEN_SLASH; break;
+        case '%': t.type = TOKEN_PERCENT; break;
         case '=':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_EQ_EQ; t.value = strdup("=="); }
-            else { t.type = TOKEN_EQUALS; t.value = strdup("="); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_EQ_EQ; }
+            else { t.type = TOKEN_EQUALS; }
             break;
         case '!':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_BANG_EQ; t.value = strdup("!="); }
-            else { t.type = TOKEN_BANG; t.value = strdup("!"); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_BANG_EQ; }
+            else { t.type = TOKEN_BANG; }
             break;
         case '<':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_LT_EQ; t.value = strdup("<="); }
-            else { t.type = TOKEN_LT; t.value = strdup("<"); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_LT_EQ; }
+            else { t.type = TOKEN_LT; }
             break;
         case '>':
-            if (peek(l) == '=') { advance(l); t.type = TOKEN_GT_EQ; t.value = strdup(">="); }
-            else { t.type = TOKEN_GT; t.value = strdup(">"); }
+            if (peek(l) == '=') { advance(l); t.type = TOKEN_GT_EQ; }
+            else { t.type = TOKEN_GT; }
             break;
         case '&':
-            if (peek(l) == '&') { advance(l); t.type = TOKEN_AND_AND; t.value = strdup("&&"); }
-            else { t.type = TOKEN_UNKNOWN; t.value = strdup("&"); }
+            if (peek(l) == '&') { advance(l); t.type = TOKEN_AND_AND; }
+            else { t.type = TOKEN_UNKNOWN; }
             break;
         case '|':
-            if (peek(l) == '|') { advance(l); t.type = TOKEN_OR_OR; t.value = strdup("||"); }
-            else { t.type = TOKEN_UNKNOWN; t.value = strdup("|"); }
+            if (peek(l) == '|') { advance(l); t.type = TOKEN_OR_OR; }
+            else { t.type = TOKEN_UNKNOWN; }
             break;
         default:
             t.type = TOKEN_UNKNOWN;
-            t.value = malloc(2);
-            t.value[0] = c;
-            t.value[1] = '\0';
             break;
     }
+    t.length = l->pos - t.start;
     return t;
 }
 
@@ -195,8 +455,76 @@ Token lexer_peek_token(Lexer* l) {
     return t;
 }
 
-void token_free(Token t) {
-    free(t.value);
+// Início do texto do token em Lexer.source (não terminado em '\0').
+const char* token_text(const Lexer* lexer, Token t) {
+    return lexer->source + t.start;
+}
+
+static void* grow(void* ptr, size_t elem, int capacity) {
+    void* p = realloc(ptr, elem * capacity);
+    if (!p) {
+        perror("Failed to allocate TokenBuffer");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void token_buffer_reserve(TokenBuffer* tb, int capacity) {
+    tb->types = grow(tb->types, sizeof(unsigned char), capacity);
+    tb->starts = grow(tb->starts, sizeof(int), capacity);
+    tb->lengths = grow(tb->lengths, sizeof(int), capacity);
+    tb->lines = grow(tb->lines, sizeof(int), capacity);
+    tb->columns = grow(tb->columns, sizeof(int), capacity);
+    tb->symbols = grow(tb->symbols, sizeof(int), capacity);
+    tb->capacity = capacity;
+}
+
+// Tokeniza todo o restante do source de uma vez, incluindo o EOF final.
+TokenBuffer* token_buffer_build(Lexer* l) {
+    TokenBuffer* tb = calloc(1, sizeof(TokenBuffer));
+    if (!tb) {
+        perror("Failed to allocate TokenBuffer");
+        exit(EXIT_FAILURE);
+    }
+    // Código típico tem um token a cada 4-6 bytes.
+    token_buffer_reserve(tb, (l->end - l->pos) / 4 + 16);
+    while (1) {
+        Token t = lexer_next_token(l);
+        if (tb->count == tb->capacity) token_buffer_reserve(tb, tb->capacity * 2);
+        int i = tb->count++;
+        tb->types[i] = (unsigned char)t.type;
+        tb->starts[i] = t.start;
+        tb->lengths[i] = t.length;
+        tb->lines[i] = t.line;
+        tb->columns[i] = t.column;
+        tb->symbols[i] = t.symbol;
+        if (t.type == TOKEN_EOF) break;
+    }
+    return tb;
+}
+
+void token_buffer_free(TokenBuffer* tb) {
+    if (!tb) return;
+    free(tb->types);
+    free(tb->starts);
+    free(tb->lengths);
+    free(tb->lines);
+    free(tb->columns);
+    free(tb->symbols);
+    free(tb);
+}
+
+// Índices além do fim devolvem o EOF, então lookahead nunca sai do buffer.
+Token token_buffer_get(const TokenBuffer* tb, int index) {
+    if (index >= tb->count) index = tb->count - 1;
+    Token t;
+    t.type = (TokenType)tb->types[index];
+    t.start = tb->starts[index];
+    t.length = tb->lengths[index];
+    t.line = tb->lines[index];
+    t.column = tb->columns[index];
+    t.symbol = tb->symbols[index];
+    return t;
 }
 
 const char* token_type_name(TokenType type) {
@@ -237,6 +565,7 @@ const char* token_type_name(TokenType type) {
         case TOKEN_COMMA: return ",";
         case TOKEN_SEMICOLON: return ";";
         case TOKEN_COLON: return ":";
+        case TOKEN_AT: return "@";
         case TOKEN_EQ_EQ: return "==";
         case TOKEN_BANG_EQ: return "!=";
         case TOKEN_LT_EQ: return "<=";
@@ -3,6 +3,8 @@
 
 #define _POSIX_C_SOURCE 200809L
 
+#include "symbol.h"
+
 typedef enum {
     // Keywords
     TOKEN_LET, TOKEN_FN, TOKEN_RETURN, TOKEN_IF, TOKEN_ELSE, TOKEN_WHILE, TOKEN_FOR, TOKEN_PRINT, TOKEN_INPUT, TOKEN_ISNUMBER, TOKEN_ISSTRING, TOKEN_EXIT, TOKEN_ABS,
@@ -20,32 +22,61 @@ typedef enum {
     // Delimiters
     TOKEN_LPAREN, TOKEN_RPAREN, TOKEN_LBRACE, TOKEN_RBRACE, 
     TOKEN_LBRACKET, TOKEN_RBRACKET,
-    TOKEN_COMMA, TOKEN_SEMICOLON, TOKEN_COLON,
+    TOKEN_COMMA, TOKEN_SEMICOLON, TOKEN_COLON, TOKEN_AT,
     
     // System
     TOKEN_EOF, TOKEN_UNKNOWN
 } TokenType;
 
+// Um token é apenas uma fatia de Lexer.source: o lexer não aloca nada por
+// token. Para strings a fatia exclui as aspas. Identificadores e
+// palavras-chave carregam também o id internado em Lexer.symbols.
 typedef struct {
     TokenType type;
-    char* value;
+    int start;
+    int length;
     int line;
     int column;
+    int symbol;
 } Token;
 
 typedef struct {
-    char* source;
+    const char* source;
+    int end;
     int pos;
     int line;
     int column;
+    SymbolTable* symbols;
+    int owns_symbols;
 } Lexer;
 
+// Fluxo de tokens pré-tokenizado, em layout struct-of-arrays. O índice
+// count - 1 é sempre o TOKEN_EOF; os textos continuam sendo fatias do
+// source do lexer que o produziu.
+typedef struct {
+    unsigned char* types;
+    int* starts;
+    int* lengths;
+    int* lines;
+    int* columns;
+    int* symbols;
+    int count;
+    int capacity;
+} TokenBuffer;
+
 // Funções públicas
-Lexer* lexer_init(char* source);
+Lexer* lexer_init(const char* source);
+Lexer* lexer_init_n(const char* source, int length);
+Lexer* lexer_init_range(const char* source, int start, int end, int line, int column);
+Lexer* lexer_init_symbols(const char* source, int length, SymbolTable* symbols);
+SymbolTable* lexer_new_symbols(void);
 void lexer_free(Lexer* lexer);
 Token lexer_next_token(Lexer* lexer);
 Token lexer_peek_token(Lexer* lexer);
-void token_free(Token t);
+const char* token_text(const Lexer* lexer, Token t);
+TokenBuffer* token_buffer_build(Lexer* lexer);
+void token_buffer_free(TokenBuffer* tb);
+Token token_buffer_get(const TokenBuffer* tb, int index);
 const char* token_type_name(TokenType type);
 
 #endif
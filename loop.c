@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "loop.h"
+
+// Variável derivada de i * factor; factor é um literal ou um nome.
+typedef struct {
+    ASTNode* factor;
+    int name;
+} Derived;
+
+struct LoopOpt {
+    SymbolTable* names;
+    Arena* arena;
+    int inv_name;
+    int reduce;         // redução de força ligada
+    int checked;        // a aritmética pode encerrar o programa (--check-overflow)
+
+    // Lets e atribuições por id de nome no laço atual; written guarda os
+    // ids tocados, para zerar no fim.
+    PassManager* scanner;
+    int* writes;
+    int writes_capacity;
+    int* written;
+    int written_count;
+    int written_capacity;
+
+    // Pré-cabeçalho do laço atual.
+    ASTNode* head;
+    ASTNode* tail;
+
+    // Variável de indução do for atual e suas derivadas.
+    int iv;
+    ASTNode* base;      // valor inicial: literal ou nome
+    ASTNode* step;      // k: literal ou nome
+    TokenType step_op;
+    Derived* derived;
+    int derived_count;
+    int derived_capacity;
+
+    // Cópia do laço que acabou de ganhar pré-cabeçalho: será visitada logo
+    // em seguida e já está pronta.
+    ASTNode* skip;
+    int next_suffix;
+    LoopStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow LoopOpt");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static void note_write(LoopOpt* o, int name) {
+    if (name < 0) return;
+    if (name >= o->writes_capacity) {
+        int old = o->writes_capacity;
+        o->writes = grow(o->writes, &o->writes_capacity, name + 1, sizeof(int));
+        memset(o->writes + old, 0, sizeof(int) * (o->writes_capacity - old));
+    }
+    if (o->writes[name]++ == 0) {
+        o->written = grow(o->written, &o->written_capacity, o->written_count + 1, sizeof(int));
+        o->written[o->written_count++] = name;
+    }
+}
+
+static int writes_of(const LoopOpt* o, int name) {
+    return name >= 0 && name < o->writes_capacity ? o->writes[name] : 0;
+}
+
+static void scan_enter(ASTNode* node, void* state) {
+    if (node->type == AST_VAR_DECL) note_write(state, ((ASTVarDecl*)node)->name);
+    else if (node->type == AST_ASSIGN_STMT) note_write(state, ((ASTAssignStmt*)node)->name);
+}
+
+LoopOpt* loop_opt_new(SymbolTable* names, Arena* arena, int reduce, int checked) {
+    LoopOpt* o = calloc(1, sizeof(LoopOpt));
+    if (!o) {
+        perror("Failed to allocate LoopOpt");
+        exit(EXIT_FAILURE);
+    }
+    o->names = names;
+    o->arena = arena;
+    o->reduce = reduce;
+    o->checked = checked;
+    o->inv_name = symtab_intern(names, "inv", 3);
+    o->scanner = pass_manager_new();
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "loop/scan";
+    pass.state = o;
+    pass.enter = scan_enter;
+    pass_manager_add(o->scanner, &pass);
+    return o;
+}
+
+void loop_opt_free(LoopOpt* o) {
+    if (!o) return;
+    free(o->writes);
+    free(o->written);
+    free(o->derived);
+    pass_manager_free(o->scanner);
+    free(o);
+}
+
+const LoopStats* loop_opt_stats(const LoopOpt* o) {
+    return &o->stats;
+}
+
+static ASTNode* strip(ASTNode* node) {
+    while (node && node->type == AST_GROUPING_EXPR) node = ((ASTGroupingExpr*)node)->expression;
+    return node;
+}
+
+static int mentions_name(const ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return 1;
+        case AST_GROUPING_EXPR:
+            return mentions_name(((const ASTGroupingExpr*)node)->expression);
+        case AST_UNARY_EXPR:
+            return mentions_name(((const ASTUnaryExpr*)node)->right);
+        case AST_ABS_EXPR:
+            return mentions_name(((const ASTPrintStmt*)node)->expression);
+        case AST_BINARY_EXPR:
+            return mentions_name(((const ASTBinaryExpr*)node)->left) ||
+                   mentions_name(((const ASTBinaryExpr*)node)->right);
+        default:
+            return 0;
+    }
+}
+
+// Literal inteiro ou nome que o laço não escreve.
+static int invariant_leaf(const LoopOpt* o, const ASTNode* node) {
+    if (!node) return 0;
+    if (node->type == AST_INT_LITERAL) return 1;
+    return node->type == AST_IDENTIFIER && writes_of(o, ((const ASTIdentifier*)node)->name) == 0;
+}
+
+// Cópia de um literal inteiro ou de um nome.
+static ASTNode* copy_leaf(LoopOpt* o, const ASTNode* leaf, const ASTNode* at) {
+    if (leaf->type == AST_INT_LITERAL) {
+        return (ASTNode*)ast_new_int_literal(o->arena, ((const ASTIntLiteral*)leaf)->value, at->line, at->column);
+    }
+    return (ASTNode*)ast_new_identifier(o->arena, ((const ASTIdentifier*)leaf)->name, at->line, at->column);
+}
+
+static int preheader_let(LoopOpt* o, int base, ASTNode* value) {
+    int name = symtab_fresh(o->names, base, &o->next_suffix);
+    ASTNode* let = (ASTNode*)ast_new_var_decl(o->arena, name, value, value->line, value->column);
+    if (o->tail) o->tail->next = let; else o->head = let;
+    o->tail = let;
+    return name;
+}
+
+// Move a expressão invariante para o pré-cabeçalho, se valer a pena:
+// literais e nomes soltos já são baratos, e expressões só de literais são
+// da dobra de constantes.
+static void lift(LoopOpt* o, ASTNode** slot) {
+    ASTNode* e = strip(*slot);
+    if (!e || !mentions_name(e)) return;
+    if (e->type == AST_UNARY_EXPR) {
+        ASTNode* operand = strip(((ASTUnaryExpr*)e)->right);
+        if (operand->type == AST_IDENTIFIER) return;
+    } else if (e->type != AST_BINARY_EXPR && e->type != AST_ABS_EXPR) {
+        return;
+    }
+    int name = preheader_let(o, o->inv_name, *slot);
+    *slot = (ASTNode*)ast_new_identifier(o->arena, name, e->line, e->column);
+    o->stats.hoisted++;
+}
+
+// Divisão por zero (ou INT_MIN / -1) não pode passar a acontecer antes de
+// um laço que talvez nem rodasse: só divisor literal fora de 0 e -1. Com
+// checked, o mesmo vale para o estouro de + - *.
+static int may_trap(const LoopOpt* o, const ASTBinaryExpr* n) {
+    if (o->checked && (n->operator == TOKEN_PLUS || n->operator == TOKEN_MINUS || n->operator == TOKEN_STAR)) {
+        return 1;
+    }
+    if (n->operator != TOKEN_SLASH && n->operator != TOKEN_PERCENT) return 0;
+    const ASTNode* divisor = strip(n->right);
+    if (divisor->type != AST_INT_LITERAL) return 1;
+    int value = ((const ASTIntLiteral*)divisor)->value;
+    return value == 0 || value == -1;
+}
+
+// Devolve 1 se a expressão é pura e invariante; senão, as subexpressões
+// que são já foram movidas.
+static int visit(LoopOpt* o, ASTNode** slot) {
+    ASTNode* e = *slot;
+    switch (e->type) {
+        case AST_INT_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOL_LITERAL:
+            return 1;
+        case AST_IDENTIFIER:
+            return writes_of(o, ((ASTIdentifier*)e)->name) == 0;
+        case AST_GROUPING_EXPR:
+            return visit(o, &((ASTGroupingExpr*)e)->expression);
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* n = (ASTUnaryExpr*)e;
+            int operand = visit(o, &n->right);
+            if (!o->checked || n->operator == TOKEN_BANG) return operand;
+            if (operand) lift(o, &n->right);
+            return 0;
+        }
+        case AST_ABS_EXPR: {
+            ASTNode** operand = &((ASTPrintStmt*)e)->expression;
+            int invariant = visit(o, operand);
+            if (!o->checked) return invariant;
+            if (invariant) lift(o, operand);
+            return 0;
+        }
+        case AST_BINARY_EXPR: {
+            ASTBinaryExpr* n = (ASTBinaryExpr*)e;
+            int left = visit(o, &n->left);
+            int right = visit(o, &n->right);
+            if (left && right && !may_trap(o, n)) return 1;
+            if (left) lift(o, &n->left);
+            if (right) lift(o, &n->right);
+            return 0;
+        }
+        case AST_CALL_EXPR: {
+            ASTCallExpr* n = (ASTCallExpr*)e;
+            for (int i = 0; i < n->arg_count; i++) {
+                if (visit(o, &n->args[i])) lift(o, &n->args[i]);
+            }
+            return 0;
+        }
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT: {
+            ASTNode** operand = &((ASTPrintStmt*)e)->expression;
+            if (*operand && visit(o, operand)) lift(o, operand);
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+static void hoist(LoopOpt* o, ASTNode** slot) {
+    if (visit(o, slot)) lift(o, slot);
+}
+
+static int derived_name(LoopOpt* o, ASTNode* factor, const ASTNode* at);
+
+// i * c e c * i viram a derivada de c.
+static void reduce(LoopOpt* o, ASTNode** slot) {
+    ASTNode* e = *slot;
+    switch (e->type) {
+        case AST_GROUPING_EXPR:
+            reduce(o, &((ASTGroupingExpr*)e)->expression);
+            break;
+        case AST_UNARY_EXPR:
+            reduce(o, &((ASTUnaryExpr*)e)->right);
+            break;
+        case AST_BINARY_EXPR: {
+            ASTBinaryExpr* n = (ASTBinaryExpr*)e;
+            if (n->operator == TOKEN_STAR) {
+                ASTNode* left = strip(n->left);
+                ASTNode* right = strip(n->right);
+                ASTNode* factor = NULL;
+                if (left->type == AST_IDENTIFIER && ((ASTIdentifier*)left)->name == o->iv) factor = right;
+                else if (right->type == AST_IDENTIFIER && ((ASTIdentifier*)right)->name == o->iv) factor = left;
+                if (invariant_leaf(o, factor)) {
+                    int name = derived_name(o, factor, e);
+                    *slot = (ASTNode*)ast_new_identifier(o->arena, name, e->line, e->column);
+                    o->stats.reduced++;
+                    break;
+                }
+            }
+            reduce(o, &n->left);
+            reduce(o, &n->right);
+            break;
+        }
+        case AST_CALL_EXPR: {
+            ASTCallExpr* n = (ASTCallExpr*)e;
+            for (int i = 0; i < n->arg_count; i++) reduce(o, &n->args[i]);
+            break;
+        }
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+            if (((ASTPrintStmt*)e)->expression) reduce(o, &((ASTPrintStmt*)e)->expression);
+            break;
+        default:
+            break;
+    }
+}
+
+typedef void (*ExpressionFn)(LoopOpt* o, ASTNode** slot);
+
+// Aplica fn a cada expressão dos comandos da lista, descendo nos comandos
+// compostos (inclusive laços internos).
+static void each_expression(LoopOpt* o, ASTNode* stmt, ExpressionFn fn) {
+    for (; stmt; stmt = stmt->next) {
+        switch (stmt->type) {
+            case AST_VAR_DECL:
+                if (((ASTVarDecl*)stmt)->initializer) fn(o, &((ASTVarDecl*)stmt)->initializer);
+                break;
+            case AST_ASSIGN_STMT:
+                fn(o, &((ASTAssignStmt*)stmt)->value);
+                break;
+            case AST_RETURN_STMT:
+            case AST_PRINT_STMT:
+                if (((ASTReturnStmt*)stmt)->expression) fn(o, &((ASTReturnStmt*)stmt)->expression);
+                break;
+            case AST_EXIT_STMT:
+                fn(o, &((ASTPrintStmt*)stmt)->expression);
+                break;
+            case AST_CALL_STMT: {
+                ASTCallStmt* n = (ASTCallStmt*)stmt;
+                for (int i = 0; i < n->arg_count; i++) fn(o, &n->args[i]);
+                break;
+            }
+            case AST_BLOCK:
+                each_expression(o, ((ASTBlock*)stmt)->statements, fn);
+                break;
+            case AST_IF_STMT: {
+                ASTIfStmt* n = (ASTIfStmt*)stmt;
+                fn(o, &n->condition);
+                each_expression(o, n->then_branch, fn);
+                each_expression(o, n->else_branch, fn);
+                break;
+            }
+            case AST_WHILE_STMT:
+                fn(o, &((ASTWhileStmt*)stmt)->condition);
+                each_expression(o, ((ASTWhileStmt*)stmt)->body, fn);
+                break;
+            case AST_FOR_STMT: {
+                ASTForStmt* n = (ASTForStmt*)stmt;
+                each_expression(o, n->initializer, fn);
+                if (n->condition) fn(o, &n->condition);
+                each_expression(o, n->increment, fn);
+                each_expression(o, n->body, fn);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+static int derived_name(LoopOpt* o, ASTNode* factor, const ASTNode* at) {
+    for (int i = 0; i < o->derived_count; i++) {
+        ASTNode* f = o->derived[i].factor;
+        if (f->type != factor->type) continue;
+        if (f->type == AST_INT_LITERAL ? ((ASTIntLiteral*)f)->value == ((ASTIntLiteral*)factor)->value
+                                       : ((ASTIdentifier*)f)->name == ((ASTIdentifier*)factor)->name) {
+            return o->derived[i].name;
+        }
+    }
+    ASTNode* start = (ASTNode*)ast_new_binary_expr(o->arena, copy_leaf(o, o->base, at), TOKEN_STAR,
+                                                   copy_leaf(o, factor, at), at->line, at->column);
+    o->derived = grow(o->derived, &o->derived_capacity, o->derived_count + 1, sizeof(Derived));
+    o->derived[o->derived_count].factor = factor;
+    o->derived[o->derived_count].name = preheader_let(o, o->iv, start);
+    return o->derived[o->derived_count++].name;
+}
+
+// i = i + k, i = k + i, i = i - k, i += k ou i -= k, com k invariante.
+static int match_increment(LoopOpt* o, const ASTNode* node) {
+    if (!node || node->type != AST_ASSIGN_STMT) return 0;
+    const ASTAssignStmt* as = (const ASTAssignStmt*)node;
+    if (as->name != o->iv) return 0;
+    ASTNode* value = strip(as->value);
+    if (as->op_type == TOKEN_PLUS_EQ || as->op_type == TOKEN_MINUS_EQ) {
+        o->step = value;
+        o->step_op = as->op_type == TOKEN_PLUS_EQ ? TOKEN_PLUS : TOKEN_MINUS;
+        return invariant_leaf(o, value);
+    }
+    if (as->op_type != TOKEN_EQUALS || value->type != AST_BINARY_EXPR) return 0;
+    const ASTBinaryExpr* bin = (const ASTBinaryExpr*)value;
+    ASTNode* left = strip(bin->left);
+    ASTNode* right = strip(bin->right);
+    int left_iv = left->type == AST_IDENTIFIER && ((ASTIdentifier*)left)->name == o->iv;
+    int right_iv = right->type == AST_IDENTIFIER && ((ASTIdentifier*)right)->name == o->iv;
+    if (bin->operator == TOKEN_PLUS && (left_iv || right_iv)) {
+        o->step = left_iv ? right : left;
+    } else if (bin->operator == TOKEN_MINUS && left_iv) {
+        o->step = right;
+    } else {
+        return 0;
+    }
+    o->step_op = bin->operator;
+    return invariant_leaf(o, o->step);
+}
+
+// Redução de força no for: acha a variável de indução, troca as
+// multiplicações e soma o passo de cada derivada no fim do corpo.
+static void strength_reduce(LoopOpt* o, ASTForStmt* loop) {
+    ASTNode* init = loop->initializer;
+    if (!init || init->type != AST_VAR_DECL || !((ASTVarDecl*)init)->initializer) return;
+    ASTVarDecl* let = (ASTVarDecl*)init;
+    o->iv = let->name;
+    // Só o let do for e o incremento escrevem i.
+    if (writes_of(o, o->iv) != 2 || !match_increment(o, loop->increment)) return;
+
+    // Um valor inicial que não é literal nem nome é calculado uma vez, no
+    // pré-cabeçalho, e lido pelo let do for e pelas derivadas.
+    ASTNode* start = strip(let->initializer);
+    int copied = start->type == AST_INT_LITERAL || start->type == AST_IDENTIFIER;
+    int base_name = copied ? -1 : symtab_fresh(o->names, o->iv, &o->next_suffix);
+    ASTNode* before = o->tail;
+    o->base = copied ? start : (ASTNode*)ast_new_identifier(o->arena, base_name, start->line, start->column);
+    o->derived_count = 0;
+    if (loop->condition) reduce(o, &loop->condition);
+    each_expression(o, loop->body, reduce);
+    if (o->derived_count == 0) return;
+    if (!copied) {
+        ASTNode* base_let = (ASTNode*)ast_new_var_decl(o->arena, base_name, let->initializer,
+                                                       start->line, start->column);
+        base_let->next = before ? before->next : o->head;
+        if (before) before->next = base_let; else o->head = base_let;
+        let->initializer = (ASTNode*)ast_new_identifier(o->arena, base_name, start->line, start->column);
+    }
+
+    // derivada = derivada ± k * c, depois de tudo no corpo.
+    ASTNode* updates = NULL;
+    ASTNode* last = NULL;
+    const ASTNode* at = loop->increment;
+    for (int i = 0; i < o->derived_count; i++) {
+        ASTNode* factor = o->derived[i].factor;
+        ASTNode* step;
+        if (o->step->type == AST_INT_LITERAL && factor->type == AST_INT_LITERAL) {
+            unsigned product = (unsigned)((ASTIntLiteral*)o->step)->value *
+                               (unsigned)((ASTIntLiteral*)factor)->value;
+            step = (ASTNode*)ast_new_int_literal(o->arena, (int)product, at->line, at->column);
+        } else {
+            ASTNode* value = (ASTNode*)ast_new_binary_expr(o->arena, copy_leaf(o, o->step, at), TOKEN_STAR,
+                                                           copy_leaf(o, factor, at), at->line, at->column);
+            step = (ASTNode*)ast_new_identifier(o->arena, preheader_let(o, o->inv_name, value),
+                                                at->line, at->column);
+        }
+        int name = o->derived[i].name;
+        ASTNode* current = (ASTNode*)ast_new_identifier(o->arena, name, at->line, at->column);
+        ASTNode* sum = (ASTNode*)ast_new_binary_expr(o->arena, current, o->step_op, step, at->line, at->column);
+        ASTNode* update = (ASTNode*)ast_new_assign_stmt(o->arena, name, sum, TOKEN_EQUALS, at->line, at->column);
+        if (last) last->next = update; else updates = update;
+        last = update;
+    }
+    if (loop->body->type == AST_BLOCK) {
+        ASTBlock* body = (ASTBlock*)loop->body;
+        ASTNode** end = &body->statements;
+        while (*end) end = &(*end)->next;
+        *end = updates;
+    } else {
+        loop->body->next = updates;
+        loop->body = (ASTNode*)ast_new_block(o->arena, loop->body, loop->body->line, loop->body->column);
+    }
+}
+
+static void enter(ASTNode* node, void* state) {
+    LoopOpt* o = state;
+    if (node == o->skip) {
+        o->skip = NULL;
+        return;
+    }
+    if (node->type != AST_WHILE_STMT && node->type != AST_FOR_STMT) return;
+
+    pass_manager_run_node(o->scanner, &node);
+    o->head = o->tail = NULL;
+    size_t size;
+    if (node->type == AST_WHILE_STMT) {
+        ASTWhileStmt* loop = (ASTWhileStmt*)node;
+        hoist(o, &loop->condition);
+        each_expression(o, loop->body, hoist);
+        size = sizeof(ASTWhileStmt);
+    } else {
+        ASTForStmt* loop = (ASTForStmt*)node;
+        if (loop->condition) hoist(o, &loop->condition);
+        each_expression(o, loop->increment, hoist);
+        each_expression(o, loop->body, hoist);
+        // A derivada ainda soma k * c depois da última volta, e esse valor,
+        // que ninguém lê, pode estourar.
+        if (o->reduce && !o->checked) strength_reduce(o, loop);
+        size = sizeof(ASTForStmt);
+    }
+    for (int i = 0; i < o->written_count; i++) o->writes[o->written[i]] = 0;
+    o->written_count = 0;
+    if (!o->head) return;
+
+    // O laço vira o último comando de um bloco com o pré-cabeçalho; o nó
+    // original é reaproveitado como o bloco, para ficar no mesmo lugar.
+    ASTNode* loop = arena_alloc(o->arena, size);
+    memcpy(loop, node, size);
+    loop->next = NULL;
+    o->tail->next = loop;
+    node->type = AST_BLOCK;
+    ((ASTBlock*)node)->statements = o->head;
+    o->skip = loop;
+    o->stats.loops++;
+}
+
+Pass loop_opt_pass(LoopOpt* o) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "loop";
+    pass.state = o;
+    pass.enter = enter;
+    return pass;
+}
@@ -0,0 +1,49 @@
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "ast.h"
+#include "arena.h"
+#include "pass.h"
+#include "symbol.h"
+
+// Otimização de laços while e for: movimentação de código invariante e
+// redução de força sobre a variável de indução.
+//
+// Uma expressão é invariante quando só lê nomes que nada no laço declara
+// ou atribui (chamadas não alteram as variáveis de quem chama); sem
+// chamadas, input, exit, nem divisão exceto por literal fora de 0 e -1,
+// ela pode rodar uma vez antes do laço, mesmo que ele não rode nenhuma.
+// As maiores subexpressões invariantes da condição, do incremento e do
+// corpo viram lets num pré-cabeçalho (inv__N); o laço passa a ser o
+// último comando de um bloco com eles. Com checked (--check-overflow),
+// + - *, negação e abs também ficam no laço: o estouro encerra o programa,
+// e não pode acontecer num caminho que não rodaria.
+//
+// Com reduce, num for (let i = a; ...; i = i + k), com k literal ou nome
+// invariante e i sem outras atribuições, cada i * c (c literal ou nome
+// invariante) na condição e no corpo vira uma variável derivada i__N:
+// começa em a * c no pré-cabeçalho e soma k * c no fim do corpo. Lamo não
+// tem break nem continue, então o fim do corpo precede todo incremento.
+// Fica desligada por padrão: com o gcc sem -O, cada variável vive na
+// memória, e a derivada é mais uma dependência entre voltas, que custa
+// mais que a multiplicação que substitui (ver make bench-loops). Com
+// checked também não roda: a última soma, depois da última volta, pode
+// estourar sem que o programa original estourasse.
+//
+// Roda no enter do laço, antes de todos os outros passes: os nomes novos
+// são resolvidos, tipados e dobrados por eles como código escrito à mão.
+typedef struct {
+    int loops;          // laços que ganharam pré-cabeçalho
+    int hoisted;        // expressões invariantes movidas
+    int reduced;        // multiplicações pela variável de indução trocadas
+} LoopStats;
+
+typedef struct LoopOpt LoopOpt;
+
+// Nomes novos são internados em names e os nós alocados em arena.
+LoopOpt* loop_opt_new(SymbolTable* names, Arena* arena, int reduce, int checked);
+void loop_opt_free(LoopOpt* o);
+Pass loop_opt_pass(LoopOpt* o);
+const LoopStats* loop_opt_stats(const LoopOpt* o);
+
+#endif
@@ -0,0 +1,821 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lower.h"
+
+struct MainMemory {
+    unsigned char* live;    // slot é uma variável de nível superior
+    int live_capacity;
+    ValueType* types;
+    int types_capacity;
+};
+
+// Phi criado num bloco ainda não selado; completado em seal.
+typedef struct {
+    int slot;
+    int phi;
+    int next;           // próximo do mesmo bloco, ou -1
+} Incomplete;
+
+// Quadro da leitura iterativa de um slot (read_slot).
+typedef struct {
+    int block;
+    int stage;
+    int phi;
+    int pred;
+} ReadFrame;
+
+typedef struct {
+    IRFunction* f;
+    int block;              // bloco atual
+
+    // Definição atual de cada (bloco, slot): tabela hash com endereçamento
+    // aberto, map_block -1 nas posições livres.
+    int* map_block;
+    int* map_slot;
+    int* map_value;
+    int map_count;
+    int map_capacity;       // potência de 2
+
+    // Por bloco.
+    unsigned char* sealed;
+    int sealed_capacity;
+    int* incomplete_head;
+    int head_capacity;
+    Incomplete* incomplete;
+    int incomplete_count;
+    int incomplete_capacity;
+
+    ValueType* slot_types;  // tipo da variável que ocupa o slot agora
+    int slot_capacity;
+
+    ReadFrame* frames;
+    int frame_count;
+    int frame_capacity;
+
+    // Fragmento do main: variáveis em memória e os slots delas que o
+    // fragmento altera.
+    MainMemory* memory;
+    ASTNode* root;
+    int* written;
+    int written_count;
+    int written_capacity;
+    unsigned char* is_written;
+    int is_written_capacity;
+
+    // Expressões puras já criadas (hash-consing): ids de valores, -1 nas
+    // posições livres.
+    int* exprs;
+    int expr_count;
+    int expr_capacity;      // potência de 2
+} Lowerer;
+
+// Chave de uma expressão pura na tabela.
+typedef struct {
+    int block;
+    IROp op;
+    ValueType type;
+    int imm;
+    TokenType binop;
+    int args[2];
+    int arg_count;
+} ExprKey;
+
+static int cse = 1;
+static LowerStats stats;
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow Lowerer");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+// Como grow, mas zera a parte nova.
+static void* grow_zero(void* data, int* capacity, int needed, size_t size) {
+    int old = *capacity;
+    data = grow(data, capacity, needed, size);
+    if (*capacity > old) memset((char*)data + size * old, 0, size * (*capacity - old));
+    return data;
+}
+
+MainMemory* main_memory_new(void) {
+    MainMemory* m = calloc(1, sizeof(MainMemory));
+    if (!m) {
+        perror("Failed to allocate MainMemory");
+        exit(EXIT_FAILURE);
+    }
+    return m;
+}
+
+void main_memory_free(MainMemory* m) {
+    if (!m) return;
+    free(m->live);
+    free(m->types);
+    free(m);
+}
+
+// Uma variável, parâmetro ou retorno bool guarda qualquer int (`b -= 2` é
+// válido): só comparações, ! e constantes são garantidamente 0 ou 1, e o
+// que vem de um slot ou de uma chamada entra na IR como int.
+static ValueType held_type(ValueType type) {
+    return type == TYPE_BOOL ? TYPE_INT : type;
+}
+
+static void memory_declare(MainMemory* m, int slot, ValueType type) {
+    m->live = grow_zero(m->live, &m->live_capacity, slot + 1, 1);
+    m->types = grow(m->types, &m->types_capacity, slot + 1, sizeof(ValueType));
+    m->live[slot] = 1;
+    m->types[slot] = held_type(type);
+}
+
+static int in_memory(const Lowerer* l, int slot) {
+    return l->memory && slot >= 0 && slot < l->memory->live_capacity && l->memory->live[slot];
+}
+
+// --- definições por bloco ---
+
+static unsigned hash(int block, int slot) {
+    return (unsigned)block * 0x9E3779B1u ^ (unsigned)slot * 0x85EBCA6Bu;
+}
+
+static void map_put(Lowerer* l, int block, int slot, int value);
+
+static void map_rehash(Lowerer* l) {
+    int old_capacity = l->map_capacity;
+    int* old_block = l->map_block;
+    int* old_slot = l->map_slot;
+    int* old_value = l->map_value;
+    l->map_capacity = old_capacity ? old_capacity * 2 : 256;
+    l->map_block = malloc(sizeof(int) * l->map_capacity);
+    l->map_slot = malloc(sizeof(int) * l->map_capacity);
+    l->map_value = malloc(sizeof(int) * l->map_capacity);
+    if (!l->map_block || !l->map_slot || !l->map_value) {
+        perror("Failed to grow Lowerer");
+        exit(EXIT_FAILURE);
+    }
+    memset(l->map_block, 0xff, sizeof(int) * l->map_capacity);
+    l->map_count = 0;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_block[i] >= 0) map_put(l, old_block[i], old_slot[i], old_value[i]);
+    }
+    free(old_block);
+    free(old_slot);
+    free(old_value);
+}
+
+static void map_put(Lowerer* l, int block, int slot, int value) {
+    if (2 * (l->map_count + 1) > l->map_capacity) map_rehash(l);
+    unsigned mask = (unsigned)l->map_capacity - 1;
+    unsigned i = hash(block, slot) & mask;
+    while (l->map_block[i] >= 0 && (l->map_block[i] != block || l->map_slot[i] != slot)) {
+        i = (i + 1) & mask;
+    }
+    if (l->map_block[i] < 0) l->map_count++;
+    l->map_block[i] = block;
+    l->map_slot[i] = slot;
+    l->map_value[i] = value;
+}
+
+static int map_get(const Lowerer* l, int block, int slot) {
+    if (l->map_capacity == 0) return IR_NONE;
+    unsigned mask = (unsigned)l->map_capacity - 1;
+    unsigned i = hash(block, slot) & mask;
+    while (l->map_block[i] >= 0) {
+        if (l->map_block[i] == block && l->map_slot[i] == slot) return l->map_value[i];
+        i = (i + 1) & mask;
+    }
+    return IR_NONE;
+}
+
+// --- hash-consing ---
+
+void lower_set_cse(int enabled) {
+    cse = enabled;
+}
+
+const LowerStats* lower_stats(void) {
+    return &stats;
+}
+
+void lower_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+static unsigned expr_hash(const ExprKey* k) {
+    unsigned h = (unsigned)k->block * 0x9E3779B1u;
+    h = (h ^ (unsigned)k->op) * 0x85EBCA6Bu;
+    h = (h ^ (unsigned)k->type) * 0xC2B2AE35u;
+    h = (h ^ (unsigned)k->imm) * 0x9E3779B1u;
+    h = (h ^ (unsigned)k->binop) * 0x85EBCA6Bu;
+    for (int i = 0; i < k->arg_count; i++) h = (h ^ (unsigned)k->args[i]) * 0xC2B2AE35u;
+    return h ^ (h >> 16);
+}
+
+static ExprKey expr_key(const IRFunction* f, int id) {
+    const IRValue* v = &f->values[id];
+    ExprKey k;
+    memset(&k, 0, sizeof(k));
+    k.block = v->block;
+    k.op = v->op;
+    k.type = v->type;
+    k.imm = v->op == IR_CONST ? v->imm : 0;
+    k.binop = v->op == IR_BINARY ? v->binop : TOKEN_EOF;
+    k.arg_count = v->arg_count;
+    for (int i = 0; i < v->arg_count; i++) k.args[i] = v->args[i];
+    return k;
+}
+
+static int expr_equal(const ExprKey* a, const ExprKey* b) {
+    if (a->block != b->block || a->op != b->op || a->type != b->type || a->imm != b->imm ||
+        a->binop != b->binop || a->arg_count != b->arg_count) {
+        return 0;
+    }
+    for (int i = 0; i < a->arg_count; i++) {
+        if (a->args[i] != b->args[i]) return 0;
+    }
+    return 1;
+}
+
+static void expr_put(Lowerer* l, int id);
+
+static void expr_rehash(Lowerer* l) {
+    int old_capacity = l->expr_capacity;
+    int* old = l->exprs;
+    l->expr_capacity = old_capacity ? old_capacity * 2 : 256;
+    l->exprs = malloc(sizeof(int) * l->expr_capacity);
+    if (!l->exprs) {
+        perror("Failed to grow Lowerer");
+        exit(EXIT_FAILURE);
+    }
+    memset(l->exprs, 0xff, sizeof(int) * l->expr_capacity);
+    l->expr_count = 0;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i] >= 0) expr_put(l, old[i]);
+    }
+    free(old);
+}
+
+static void expr_put(Lowerer* l, int id) {
+    if (2 * (l->expr_count + 1) > l->expr_capacity) expr_rehash(l);
+    ExprKey k = expr_key(l->f, id);
+    unsigned mask = (unsigned)l->expr_capacity - 1;
+    unsigned i = expr_hash(&k) & mask;
+    while (l->exprs[i] >= 0) i = (i + 1) & mask;
+    l->exprs[i] = id;
+    l->expr_count++;
+}
+
+static int expr_get(const Lowerer* l, const ExprKey* k) {
+    if (l->expr_capacity == 0) return IR_NONE;
+    unsigned mask = (unsigned)l->expr_capacity - 1;
+    unsigned i = expr_hash(k) & mask;
+    while (l->exprs[i] >= 0) {
+        ExprKey other = expr_key(l->f, l->exprs[i]);
+        if (expr_equal(&other, k)) return l->exprs[i];
+        i = (i + 1) & mask;
+    }
+    return IR_NONE;
+}
+
+// O valor da expressão pura k: o já criado no mesmo bloco, se houver, ou
+// um novo. Uma atribuição não precisa invalidar nada: depois dela, ler a
+// variável dá outra definição, e a mesma expressão do source ganha outra
+// chave.
+static int intern(Lowerer* l, const ExprKey* k) {
+    IRFunction* f = l->f;
+    int found = cse ? expr_get(l, k) : IR_NONE;
+    if (found != IR_NONE) {
+        stats.shared++;
+        return found;
+    }
+    int v = ir_add_value(f, k->block, k->op, k->type, k->arg_count);
+    IRValue* value = &f->values[v];
+    if (k->op == IR_CONST) value->imm = k->imm;
+    if (k->op == IR_BINARY) {
+        value->binop = k->binop;
+        value->operand_type = f->values[k->args[0]].type == TYPE_STRING ? TYPE_STRING : TYPE_INT;
+    }
+    for (int i = 0; i < k->arg_count; i++) value->args[i] = k->args[i];
+    if (cse) expr_put(l, v);
+    return v;
+}
+
+static int constant(Lowerer* l, int block, int value, ValueType type) {
+    ExprKey k;
+    memset(&k, 0, sizeof(k));
+    k.block = block;
+    k.op = IR_CONST;
+    k.type = type;
+    k.imm = value;
+    k.binop = TOKEN_EOF;
+    return intern(l, &k);
+}
+
+// --- construção de SSA ---
+
+// Slots -1 só aparecem em nós com erro semântico; o modo streaming gera o
+// código antes de saber dos erros, e o resultado é descartado.
+static ValueType slot_type(const Lowerer* l, int slot) {
+    return slot >= 0 && slot < l->slot_capacity ? l->slot_types[slot] : TYPE_INT;
+}
+
+static void set_slot_type(Lowerer* l, int slot, ValueType type) {
+    if (slot < 0) return;
+    l->slot_types = grow_zero(l->slot_types, &l->slot_capacity, slot + 1, sizeof(ValueType));
+    l->slot_types[slot] = held_type(type);
+}
+
+static int new_block(Lowerer* l) {
+    int b = ir_add_block(l->f);
+    l->sealed = grow_zero(l->sealed, &l->sealed_capacity, b + 1, 1);
+    l->incomplete_head = grow(l->incomplete_head, &l->head_capacity, b + 1, sizeof(int));
+    l->incomplete_head[b] = -1;
+    return b;
+}
+
+static void write_slot(Lowerer* l, int block, int slot, int value) {
+    if (slot < 0) return;
+    map_put(l, block, slot, value);
+    if (in_memory(l, slot)) {
+        l->is_written = grow_zero(l->is_written, &l->is_written_capacity, slot + 1, 1);
+        if (!l->is_written[slot]) {
+            l->is_written[slot] = 1;
+            l->written = grow(l->written, &l->written_capacity, l->written_count + 1, sizeof(int));
+            l->written[l->written_count++] = slot;
+        }
+    }
+}
+
+// Valor de um slot que nenhum caminho definiu: o que está em memória, nos
+// fragmentos do main, ou 0 (só acontece em código inalcançável).
+static int undefined(Lowerer* l, int block, int slot) {
+    if (in_memory(l, slot)) {
+        int v = ir_add_value(l->f, block, IR_LOAD, l->memory->types[slot], 0);
+        l->f->values[v].imm = slot;
+        return v;
+    }
+    return constant(l, block, 0, slot_type(l, slot));
+}
+
+static void push_frame(Lowerer* l, int block) {
+    l->frames = grow(l->frames, &l->frame_capacity, l->frame_count + 1, sizeof(ReadFrame));
+    ReadFrame* fr = &l->frames[l->frame_count++];
+    fr->block = block;
+    fr->stage = 0;
+    fr->phi = IR_NONE;
+    fr->pred = 0;
+}
+
+// Leitura recursiva do algoritmo, com a pilha explícita: uma cadeia longa
+// de blocos (um main com milhares de ifs) não estoura a pilha do C.
+static int read_slot(Lowerer* l, int block, int slot) {
+    IRFunction* f = l->f;
+    if (slot < 0) return constant(l, block, 0, TYPE_INT);
+    int base = l->frame_count;
+    int result = IR_NONE;
+    push_frame(l, block);
+    while (l->frame_count > base) {
+        ReadFrame* fr = &l->frames[l->frame_count - 1];
+        int b = fr->block;
+        if (fr->stage == 1) {
+            // Bloco com um só predecessor: vale o que veio dele.
+            map_put(l, b, slot, result);
+            l->frame_count--;
+            continue;
+        }
+        if (fr->stage == 2) {
+            f->values[fr->phi].args[fr->pred++] = result;
+            if (fr->pred < f->blocks[b].pred_count) {
+                push_frame(l, f->blocks[b].preds[fr->pred]);
+                continue;
+            }
+            int phi = fr->phi;
+            result = ir_simplify_phi(f, phi);
+            if (result != phi) map_put(l, b, slot, result);
+            l->frame_count--;
+            continue;
+        }
+        int v = map_get(l, b, slot);
+        if (v != IR_NONE) {
+            result = ir_resolve(f, v);
+            l->frame_count--;
+        } else if (!l->sealed[b]) {
+            int phi = ir_add_value(f, b, IR_PHI, slot_type(l, slot), 0);
+            l->incomplete = grow(l->incomplete, &l->incomplete_capacity, l->incomplete_count + 1,
+                                 sizeof(Incomplete));
+            Incomplete* inc = &l->incomplete[l->incomplete_count];
+            inc->slot = slot;
+            inc->phi = phi;
+            inc->next = l->incomplete_head[b];
+            l->incomplete_head[b] = l->incomplete_count++;
+            map_put(l, b, slot, phi);
+            result = phi;
+            l->frame_count--;
+        } else if (f->blocks[b].pred_count == 0) {
+            result = undefined(l, b, slot);
+            map_put(l, b, slot, result);
+            l->frame_count--;
+        } else if (f->blocks[b].pred_count == 1) {
+            fr->stage = 1;
+            push_frame(l, f->blocks[b].preds[0]);
+        } else {
+            // O phi é registrado antes de ler os predecessores: num laço,
+            // a leitura volta a este bloco e para nele.
+            int phi = ir_add_value(f, b, IR_PHI, slot_type(l, slot), f->blocks[b].pred_count);
+            map_put(l, b, slot, phi);
+            fr = &l->frames[l->frame_count - 1];
+            fr->stage = 2;
+            fr->phi = phi;
+            push_frame(l, f->blocks[b].preds[0]);
+        }
+    }
+    return result;
+}
+
+static void seal(Lowerer* l, int block) {
+    IRFunction* f = l->f;
+    for (int i = l->incomplete_head[block]; i >= 0; i = l->incomplete[i].next) {
+        int phi = l->incomplete[i].phi;
+        int slot = l->incomplete[i].slot;
+        int n = f->blocks[block].pred_count;
+        int* args = arena_alloc(&f->arena, sizeof(int) * (n ? n : 1));
+        for (int p = 0; p < n; p++) args[p] = read_slot(l, f->blocks[block].preds[p], slot);
+        f->values[phi].args = args;
+        f->values[phi].arg_count = n;
+        ir_simplify_phi(f, phi);
+    }
+    l->incomplete_head[block] = -1;
+    l->sealed[block] = 1;
+}
+
+// --- tradução ---
+
+static int lower_expr(Lowerer* l, ASTNode* node);
+static void lower_stmt(Lowerer* l, ASTNode* node);
+
+static int emit(Lowerer* l, IROp op, ValueType type, int count) {
+    return ir_add_value(l->f, l->block, op, type, count);
+}
+
+static int emit_unary(Lowerer* l, IROp op, ValueType type, int operand) {
+    int v = emit(l, op, type, 1);
+    l->f->values[v].args[0] = operand;
+    return v;
+}
+
+// Operação pura do bloco atual, pela tabela de expressões.
+static int emit_pure(Lowerer* l, IROp op, ValueType type, TokenType binop, int left, int right) {
+    ExprKey k;
+    memset(&k, 0, sizeof(k));
+    k.block = l->block;
+    k.op = op;
+    k.type = type;
+    k.binop = binop;
+    k.args[0] = ir_resolve(l->f, left);
+    k.args[1] = ir_resolve(l->f, right);
+    k.arg_count = right == IR_NONE ? 1 : 2;
+    return intern(l, &k);
+}
+
+static int emit_unary_pure(Lowerer* l, IROp op, ValueType type, int operand) {
+    return emit_pure(l, op, type, TOKEN_EOF, operand, IR_NONE);
+}
+
+static int emit_binary(Lowerer* l, int left, TokenType op, int right) {
+    int compare = op != TOKEN_PLUS && op != TOKEN_MINUS && op != TOKEN_STAR &&
+                  op != TOKEN_SLASH && op != TOKEN_PERCENT;
+    return emit_pure(l, IR_BINARY, compare ? TYPE_BOOL : TYPE_INT, op, left, right);
+}
+
+// Código depois de return ou exit: vai para um bloco sem predecessores.
+static void start_unreachable(Lowerer* l) {
+    l->block = new_block(l);
+    seal(l, l->block);
+}
+
+// Desvia conforme cond; condição constante vira salto direto, e o outro
+// lado fica sem predecessores.
+static void branch(Lowerer* l, int cond, int if_true, int if_false) {
+    const IRValue* v = &l->f->values[cond];
+    if (v->op == IR_CONST) {
+        ir_jump(l->f, l->block, v->imm ? if_true : if_false);
+    } else {
+        ir_branch(l->f, l->block, cond, if_true, if_false);
+    }
+}
+
+// a && b e a || b: b só roda num bloco à parte, e o resultado (0 ou 1) é
+// um phi na junção.
+static int lower_logical(Lowerer* l, ASTBinaryExpr* expr) {
+    IRFunction* f = l->f;
+    int is_and = expr->operator == TOKEN_AND_AND;
+    int left = lower_expr(l, expr->left);
+    int rhs = new_block(l);
+    int join = new_block(l);
+    if (is_and) branch(l, left, rhs, join);
+    else branch(l, left, join, rhs);
+    seal(l, rhs);
+
+    l->block = rhs;
+    int right = lower_expr(l, expr->right);
+    if (f->values[right].type != TYPE_BOOL) {
+        right = emit_binary(l, right, TOKEN_BANG_EQ, constant(l, l->block, 0, TYPE_INT));
+    }
+    int rhs_end = l->block;
+    ir_jump(f, rhs_end, join);
+    seal(l, join);
+
+    l->block = join;
+    int n = f->blocks[join].pred_count;
+    int shortcut = IR_NONE;
+    int phi = ir_add_value(f, join, IR_PHI, TYPE_BOOL, n);
+    for (int i = 0; i < n; i++) {
+        if (f->blocks[join].preds[i] == rhs_end) {
+            f->values[phi].args[i] = right;
+        } else {
+            if (shortcut == IR_NONE) shortcut = constant(l, 0, is_and ? 0 : 1, TYPE_BOOL);
+            f->values[phi].args[i] = shortcut;
+        }
+    }
+    return ir_simplify_phi(f, phi);
+}
+
+static int lower_call(Lowerer* l, int name, ASTNode** args, int arg_count, ValueType type) {
+    int* values = NULL;
+    if (arg_count > 0) values = arena_alloc(&l->f->arena, sizeof(int) * arg_count);
+    for (int i = 0; i < arg_count; i++) values[i] = lower_expr(l, args[i]);
+    int v = emit(l, IR_CALL, held_type(type), 0);
+    l->f->values[v].name = name;
+    l->f->values[v].args = values;
+    l->f->values[v].arg_count = arg_count;
+    return v;
+}
+
+static int lower_exit(Lowerer* l, ASTNode* code) {
+    int v = code ? lower_expr(l, code) : constant(l, l->block, 0, TYPE_INT);
+    ir_terminate(l->f, l->block, IR_EXIT, v);
+    start_unreachable(l);
+    return constant(l, l->block, 0, TYPE_INT);
+}
+
+static int lower_expr(Lowerer* l, ASTNode* node) {
+    IRFunction* f = l->f;
+    if (!node) return constant(l, l->block, 0, TYPE_INT);
+    switch (node->type) {
+        case AST_INT_LITERAL:
+            return constant(l, l->block, ((ASTIntLiteral*)node)->value, TYPE_INT);
+        case AST_BOOL_LITERAL:
+            return constant(l, l->block, ((ASTBoolLiteral*)node)->value, TYPE_BOOL);
+        case AST_STRING_LITERAL: {
+            int v = emit(l, IR_STRING, TYPE_STRING, 0);
+            f->values[v].text = ((ASTStringLiteral*)node)->value;
+            return v;
+        }
+        case AST_IDENTIFIER:
+            return read_slot(l, l->block, ((ASTIdentifier*)node)->slot);
+        case AST_GROUPING_EXPR:
+            return lower_expr(l, ((ASTGroupingExpr*)node)->expression);
+        case AST_BINARY_EXPR: {
+            ASTBinaryExpr* expr = (ASTBinaryExpr*)node;
+            if (expr->operator == TOKEN_AND_AND || expr->operator == TOKEN_OR_OR) {
+                return lower_logical(l, expr);
+            }
+            int left = lower_expr(l, expr->left);
+            int right = lower_expr(l, expr->right);
+            return emit_binary(l, left, expr->operator, right);
+        }
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* expr = (ASTUnaryExpr*)node;
+            int operand = lower_expr(l, expr->right);
+            if (expr->operator == TOKEN_BANG) return emit_unary_pure(l, IR_NOT, TYPE_BOOL, operand);
+            return emit_unary_pure(l, IR_NEG, TYPE_INT, operand);
+        }
+        case AST_CALL_EXPR: {
+            ASTCallExpr* call = (ASTCallExpr*)node;
+            return lower_call(l, call->name, call->args, call->arg_count, call->value_type);
+        }
+        case AST_INPUT_EXPR: {
+            ASTPrintStmt* input = (ASTPrintStmt*)node;
+            if (!input->expression) return emit(l, IR_INPUT, TYPE_INT, 0);
+            int prompt = lower_expr(l, input->expression);
+            int v = emit_unary(l, IR_INPUT, TYPE_INT, prompt);
+            f->values[v].operand_type = f->values[prompt].type == TYPE_STRING ? TYPE_STRING : TYPE_INT;
+            return v;
+        }
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR: {
+            // O tipo do operando é conhecido aqui; ele só roda pelos efeitos.
+            int operand = lower_expr(l, ((ASTPrintStmt*)node)->expression);
+            int string = f->values[operand].type == TYPE_STRING;
+            return constant(l, l->block, string == (node->type == AST_ISSTRING_EXPR), TYPE_BOOL);
+        }
+        case AST_ABS_EXPR:
+            return emit_unary_pure(l, IR_ABS, TYPE_INT, lower_expr(l, ((ASTPrintStmt*)node)->expression));
+        case AST_EXIT_STMT:
+            return lower_exit(l, ((ASTPrintStmt*)node)->expression);
+        case AST_INLINE_EXPR: {
+            ASTInlineExpr* expr = (ASTInlineExpr*)node;
+            for (ASTNode* stmt = expr->statements; stmt; stmt = stmt->next) lower_stmt(l, stmt);
+            return lower_expr(l, expr->result);
+        }
+        default:
+            return constant(l, l->block, 0, TYPE_INT);
+    }
+}
+
+static void lower_if(Lowerer* l, ASTIfStmt* stmt) {
+    int cond = lower_expr(l, stmt->condition);
+    int then_block = new_block(l);
+    int else_block = stmt->else_branch ? new_block(l) : IR_NONE;
+    int join = new_block(l);
+    branch(l, cond, then_block, else_block != IR_NONE ? else_block : join);
+    seal(l, then_block);
+    l->block = then_block;
+    lower_stmt(l, stmt->then_branch);
+    ir_jump(l->f, l->block, join);
+    if (else_block != IR_NONE) {
+        seal(l, else_block);
+        l->block = else_block;
+        lower_stmt(l, stmt->else_branch);
+        ir_jump(l->f, l->block, join);
+    }
+    seal(l, join);
+    l->block = join;
+}
+
+// while e for: o cabeçalho avalia a condição e só é selado depois do corpo,
+// que volta para ele. O incremento do for fecha o corpo.
+static void lower_loop(Lowerer* l, ASTNode* condition, ASTNode* body, ASTNode* increment) {
+    IRFunction* f = l->f;
+    int header = new_block(l);
+    ir_jump(f, l->block, header);
+    l->block = header;
+    int cond = condition ? lower_expr(l, condition) : constant(l, l->block, 1, TYPE_BOOL);
+    int body_block = new_block(l);
+    int exit_block = new_block(l);
+    branch(l, cond, body_block, exit_block);
+    seal(l, body_block);
+    seal(l, exit_block);
+
+    l->block = body_block;
+    lower_stmt(l, body);
+    if (increment) lower_stmt(l, increment);
+    ir_jump(f, l->block, header);
+    seal(l, header);
+    l->block = exit_block;
+}
+
+static void lower_stmt(Lowerer* l, ASTNode* node) {
+    IRFunction* f = l->f;
+    if (!node) return;
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* decl = (ASTVarDecl*)node;
+            int v = decl->initializer ? lower_expr(l, decl->initializer)
+                                      : constant(l, l->block, 0, decl->value_type);
+            set_slot_type(l, decl->slot, decl->value_type);
+            if (node == l->root && l->memory && decl->slot >= 0) memory_declare(l->memory, decl->slot, decl->value_type);
+            write_slot(l, l->block, decl->slot, v);
+            break;
+        }
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* assign = (ASTAssignStmt*)node;
+            int v = lower_expr(l, assign->value);
+            if (assign->op_type == TOKEN_PLUS_EQ || assign->op_type == TOKEN_MINUS_EQ) {
+                int current = read_slot(l, l->block, assign->slot);
+                v = emit_binary(l, current, assign->op_type == TOKEN_PLUS_EQ ? TOKEN_PLUS : TOKEN_MINUS, v);
+            }
+            write_slot(l, l->block, assign->slot, v);
+            break;
+        }
+        case AST_PRINT_STMT: {
+            int v = lower_expr(l, ((ASTPrintStmt*)node)->expression);
+            int print = emit_unary(l, IR_PRINT, TYPE_INT, v);
+            f->values[print].operand_type = f->values[v].type == TYPE_STRING ? TYPE_STRING : TYPE_INT;
+            break;
+        }
+        case AST_RETURN_STMT: {
+            ASTReturnStmt* ret = (ASTReturnStmt*)node;
+            int v = ret->expression ? lower_expr(l, ret->expression) : IR_NONE;
+            ir_terminate(f, l->block, IR_RETURN, v);
+            start_unreachable(l);
+            break;
+        }
+        case AST_EXIT_STMT:
+            lower_exit(l, ((ASTPrintStmt*)node)->expression);
+            break;
+        case AST_CALL_STMT: {
+            ASTCallStmt* call = (ASTCallStmt*)node;
+            lower_call(l, call->name, call->args, call->arg_count, TYPE_INT);
+            break;
+        }
+        case AST_BLOCK:
+            for (ASTNode* stmt = ((ASTBlock*)node)->statements; stmt; stmt = stmt->next) lower_stmt(l, stmt);
+            break;
+        case AST_IF_STMT:
+            lower_if(l, (ASTIfStmt*)node);
+            break;
+        case AST_WHILE_STMT: {
+            ASTWhileStmt* loop = (ASTWhileStmt*)node;
+            lower_loop(l, loop->condition, loop->body, NULL);
+            break;
+        }
+        case AST_FOR_STMT: {
+            ASTForStmt* loop = (ASTForStmt*)node;
+            lower_stmt(l, loop->initializer);
+            lower_loop(l, loop->condition, loop->body, loop->increment);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void lowerer_init(Lowerer* l, IRFunction* f) {
+    memset(l, 0, sizeof(Lowerer));
+    l->f = f;
+    l->block = new_block(l);
+    seal(l, l->block);
+}
+
+static void lowerer_free(Lowerer* l) {
+    free(l->map_block);
+    free(l->map_slot);
+    free(l->map_value);
+    free(l->sealed);
+    free(l->incomplete_head);
+    free(l->incomplete);
+    free(l->slot_types);
+    free(l->frames);
+    free(l->written);
+    free(l->is_written);
+    free(l->exprs);
+}
+
+IRFunction* lower_function(const ASTFnDecl* fn, const SymbolTable* names) {
+    IRFunction* f = ir_new(symtab_name(names, fn->name));
+    f->param_count = fn->param_count;
+    f->param_types = fn->param_types;
+    f->return_type = fn->return_type;
+    Lowerer l;
+    lowerer_init(&l, f);
+    for (int i = 0; i < fn->param_count; i++) {
+        ValueType type = fn->param_types ? fn->param_types[i] : TYPE_INT;
+        int v = ir_add_value(f, l.block, IR_PARAM, held_type(type), 0);
+        f->values[v].imm = i;
+        set_slot_type(&l, i, type);
+        write_slot(&l, l.block, i, v);
+    }
+    lower_stmt(&l, fn->body);
+    ir_terminate(f, l.block, IR_RETURN, IR_NONE);
+    stats.values += f->value_count;
+    lowerer_free(&l);
+    ir_finish(f);
+    return f;
+}
+
+IRFunction* lower_main(ASTNode* declarations) {
+    IRFunction* f = ir_new("main");
+    Lowerer l;
+    lowerer_init(&l, f);
+    for (ASTNode* stmt = declarations; stmt; stmt = stmt->next) {
+        if (stmt->type != AST_FN_DECL) lower_stmt(&l, stmt);
+    }
+    ir_terminate(f, l.block, IR_END, IR_NONE);
+    stats.values += f->value_count;
+    lowerer_free(&l);
+    ir_finish(f);
+    return f;
+}
+
+IRFunction* lower_main_statement(ASTNode* stmt, MainMemory* memory, int* declared_slot,
+                                 ValueType* declared_type) {
+    IRFunction* f = ir_new("main");
+    Lowerer l;
+    lowerer_init(&l, f);
+    l.memory = memory;
+    l.root = stmt;
+    lower_stmt(&l, stmt);
+    // O que o fragmento alterou volta para a memória no fim dele.
+    for (int i = 0; i < l.written_count; i++) {
+        int slot = l.written[i];
+        int v = read_slot(&l, l.block, slot);
+        int store = emit_unary(&l, IR_STORE, TYPE_INT, v);
+        f->values[store].imm = slot;
+    }
+    ir_terminate(f, l.block, IR_END, IR_NONE);
+    *declared_slot = stmt->type == AST_VAR_DECL && in_memory(&l, ((ASTVarDecl*)stmt)->slot)
+                         ? ((ASTVarDecl*)stmt)->slot : -1;
+    *declared_type = stmt->type == AST_VAR_DECL ? ((ASTVarDecl*)stmt)->value_type : TYPE_INT;
+    stats.values += f->value_count;
+    lowerer_free(&l);
+    ir_finish(f);
+    return f;
+}
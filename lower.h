@@ -0,0 +1,60 @@
+#ifndef LOWER_H
+#define LOWER_H
+
+#include "ast.h"
+#include "ir.h"
+#include "symbol.h"
+
+// Tradução da AST resolvida e tipada (resolve.h, types.h) para a IR.
+//
+// A forma SSA é construída durante a tradução (Braun et al., "Simple and
+// Efficient Construction of Static Single Assignment Form"): cada slot do
+// resolvedor tem uma definição atual por bloco; ler um slot que o bloco não
+// definiu busca nos predecessores, criando um phi quando há mais de um. Um
+// bloco só é selado quando todos os seus predecessores são conhecidos (o
+// cabeçalho de um laço, depois do corpo); até lá as leituras nele viram
+// phis incompletos. Phis que recebem um único valor são eliminados.
+//
+// && e || viram desvios com um phi na junção; while e for, um cabeçalho
+// com a condição; return e exit encerram o bloco. Código depois deles vai
+// para blocos inalcançáveis, descartados por ir_finish.
+IRFunction* lower_function(const ASTFnDecl* fn, const SymbolTable* names);
+
+// O main do programa inteiro: os comandos de nível superior da lista, na
+// ordem, num único grafo.
+IRFunction* lower_main(ASTNode* declarations);
+
+// Nos modos streaming e compacto o main chega um comando de nível superior
+// por vez, e cada um vira um fragmento separado. As variáveis declaradas
+// no nível superior atravessam fragmentos: ficam em memória (mN, N o slot),
+// são lidas com load quando o fragmento as usa antes de atribuir e
+// guardadas com store no fim quando ele as altera.
+typedef struct MainMemory MainMemory;
+
+MainMemory* main_memory_new(void);
+void main_memory_free(MainMemory* m);
+
+// Traduz um comando de nível superior; se for um let, a variável passa a
+// morar em memória (slot e tipo ficam em *declared_slot e *declared_type;
+// o slot é -1 nos demais comandos).
+IRFunction* lower_main_statement(ASTNode* stmt, MainMemory* memory, int* declared_slot,
+                                 ValueType* declared_type);
+
+// Expressões puras (constantes, operações binárias, negação, ! e abs) são
+// criadas por uma tabela hash por função, com chave (bloco, operação,
+// operandos): a mesma expressão sobre os mesmos valores SSA no mesmo bloco
+// devolve o valor já criado em vez de um novo. Isso é a eliminação de
+// subexpressões comuns local ao bloco; atribuições não precisam invalidar
+// a tabela, porque depois delas ler a variável dá outra definição e a
+// expressão ganha outra chave. --no-cse desliga (cada expressão vira um
+// valor novo).
+typedef struct {
+    long values;            // valores criados na IR
+    long shared;            // expressões que reaproveitaram um valor
+} LowerStats;
+
+void lower_set_cse(int enabled);
+const LowerStats* lower_stats(void);
+void lower_reset_stats(void);
+
+#endif
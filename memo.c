@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memo.h"
+
+// Pureza conhecida de cada nome de função.
+enum {
+    PURITY_UNKNOWN,
+    PURITY_PURE,
+    PURITY_IMPURE
+};
+
+// Função vista nesta execução; os nomes que ela chama ficam em
+// callees[first .. first + count).
+typedef struct {
+    ASTFnDecl* fn;
+    int local;          // sem print, input nem exit no próprio corpo
+    int self_calls;
+    int first;
+    int count;
+} Pending;
+
+struct Memoizer {
+    // Função sendo percorrida, índice em pending[].
+    int current;
+
+    Pending* pending;
+    int pending_count;
+    int pending_capacity;
+    int* callees;
+    int callee_count;
+    int callee_capacity;
+
+    // Sobrevive entre execuções: nos modos streaming e compacto, as
+    // funções das declarações anteriores.
+    unsigned char* purity;
+    int purity_capacity;
+
+    MemoStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow Memoizer");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+Memoizer* memoizer_new(void) {
+    Memoizer* m = calloc(1, sizeof(Memoizer));
+    if (!m) {
+        perror("Failed to allocate Memoizer");
+        exit(EXIT_FAILURE);
+    }
+    m->current = -1;
+    return m;
+}
+
+void memoizer_free(Memoizer* m) {
+    if (!m) return;
+    free(m->pending);
+    free(m->callees);
+    free(m->purity);
+    free(m);
+}
+
+const MemoStats* memoizer_stats(const Memoizer* m) {
+    return &m->stats;
+}
+
+static int purity(const Memoizer* m, int name) {
+    return name >= 0 && name < m->purity_capacity ? m->purity[name] : PURITY_UNKNOWN;
+}
+
+static void set_purity(Memoizer* m, int name, int value) {
+    int old = m->purity_capacity;
+    m->purity = grow(m->purity, &m->purity_capacity, name + 1, 1);
+    if (m->purity_capacity > old) memset(m->purity + old, PURITY_UNKNOWN, (size_t)(m->purity_capacity - old));
+    m->purity[name] = (unsigned char)value;
+}
+
+static void enter(ASTNode* node, void* state) {
+    Memoizer* m = state;
+    if (node->type == AST_FN_DECL) {
+        m->pending = grow(m->pending, &m->pending_capacity, m->pending_count + 1, sizeof(Pending));
+        Pending* p = &m->pending[m->pending_count];
+        p->fn = (ASTFnDecl*)node;
+        p->local = 1;
+        p->self_calls = 0;
+        p->first = m->callee_count;
+        p->count = 0;
+        m->current = m->pending_count++;
+        return;
+    }
+    if (m->current < 0) return;
+    Pending* p = &m->pending[m->current];
+    switch (node->type) {
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_EXIT_STMT:
+            p->local = 0;
+            break;
+        case AST_CALL_EXPR:
+        case AST_CALL_STMT: {
+            int name = ((ASTCallExpr*)node)->name;
+            if (name == p->fn->name) {
+                p->self_calls++;
+                break;
+            }
+            m->callees = grow(m->callees, &m->callee_capacity, m->callee_count + 1, sizeof(int));
+            m->callees[m->callee_count++] = name;
+            p->count++;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    Memoizer* m = state;
+    if (node->type == AST_FN_DECL) m->current = -1;
+    return node;
+}
+
+static int string_params(const ASTFnDecl* fn) {
+    for (int i = 0; fn->param_types && i < fn->param_count; i++) {
+        if (fn->param_types[i] == TYPE_STRING) return 1;
+    }
+    return 0;
+}
+
+static void warn(Memoizer* m, const ASTFnDecl* fn, const char* why) {
+    fprintf(stderr, "\n[Aviso] Linha %d, Coluna %d: @memo ignorado: %s\n", fn->base.line, fn->base.column, why);
+    m->stats.warnings++;
+}
+
+// Começa supondo puras as funções sem efeito no próprio corpo e tira as
+// que chamam uma impura (ou desconhecida) até nada mudar: o maior ponto
+// fixo, que aceita ciclos de funções puras.
+static void end(void* state) {
+    Memoizer* m = state;
+    for (int i = 0; i < m->pending_count; i++) {
+        Pending* p = &m->pending[i];
+        if (p->fn->base.type != AST_FN_DECL) p->local = 0;
+        set_purity(m, p->fn->name, p->local ? PURITY_PURE : PURITY_IMPURE);
+    }
+    for (int changed = 1; changed;) {
+        changed = 0;
+        for (int i = 0; i < m->pending_count; i++) {
+            Pending* p = &m->pending[i];
+            if (purity(m, p->fn->name) != PURITY_PURE) continue;
+            for (int k = 0; k < p->count; k++) {
+                if (purity(m, m->callees[p->first + k]) != PURITY_PURE) {
+                    set_purity(m, p->fn->name, PURITY_IMPURE);
+                    changed = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < m->pending_count; i++) {
+        Pending* p = &m->pending[i];
+        ASTFnDecl* fn = p->fn;
+        if (fn->base.type != AST_FN_DECL) continue;
+        int pure = purity(m, fn->name) == PURITY_PURE;
+        if (pure) m->stats.pure++;
+        if (fn->memo) m->stats.annotated++;
+        if (!fn->memo && p->self_calls < MEMO_FANOUT) continue;
+        if (!pure || string_params(fn)) {
+            if (fn->memo) warn(m, fn, pure ? "parâmetro string" : "a função não é pura");
+            continue;
+        }
+        fn->memoized = 1;
+        m->stats.memoized++;
+    }
+    m->pending_count = 0;
+    m->callee_count = 0;
+    m->current = -1;
+}
+
+Pass memoizer_pass(Memoizer* m) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "memo";
+    pass.state = m;
+    pass.enter = enter;
+    pass.leave = leave;
+    pass.end = end;
+    return pass;
+}
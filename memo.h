@@ -0,0 +1,47 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "ast.h"
+#include "pass.h"
+
+// Entradas do cache de cada função memoizada (potência de 2).
+#define MEMO_ENTRIES 4096
+// Chamadas a si mesma no corpo a partir das quais uma função pura ganha
+// cache sem precisar de @memo: com duas ou mais a recursão se ramifica e o
+// trabalho repetido cresce exponencialmente.
+#define MEMO_FANOUT 2
+
+// Memoização automática de funções puras.
+//
+// Uma função é pura quando não tem print, input nem exit e só chama
+// funções puras (ela mesma inclusive); como funções não enxergam as
+// variáveis do nível superior (resolve.h), o resultado só depende dos
+// argumentos. A pureza é um ponto fixo sobre o grafo de chamadas, então a
+// recursão mútua entre funções puras é reconhecida. Nos modos streaming e
+// compacto, que processam uma declaração por vez, uma chamada a uma função
+// ainda não vista conta como impura.
+//
+// Ganham cache (ASTFnDecl.memoized) as funções puras sem parâmetros string
+// anotadas com @memo ou com pelo menos MEMO_FANOUT chamadas a si mesmas. O
+// cache é gerado por codegen.h: uma tabela de tamanho fixo, indexada pelo
+// hash dos argumentos inteiros, em que uma entrada nova substitui a antiga
+// da mesma posição. @memo numa função que não se qualifica gera um aviso.
+//
+// A decisão é tomada no end, depois dos tipos dos parâmetros (types.h);
+// o passe deve ser registrado depois do typer e antes da recursão de cauda
+// (tailcall.h), que tira as chamadas a si mesma do corpo.
+typedef struct {
+    int pure;           // funções puras
+    int annotated;      // funções com @memo
+    int memoized;       // funções que ganharam cache
+    int warnings;       // @memo ignorado
+} MemoStats;
+
+typedef struct Memoizer Memoizer;
+
+Memoizer* memoizer_new(void);
+void memoizer_free(Memoizer* m);
+Pass memoizer_pass(Memoizer* m);
+const MemoStats* memoizer_stats(const Memoizer* m);
+
+#endif
@@ -0,0 +1,317 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "lexer_v2.h"
+#include "parser_v2.h"
+#include "parallel.h"
+#include "pass.h"
+
+// Pedaços por thread: mais que um para equilibrar arquivos irregulares.
+#define CHUNKS_PER_THREAD 8
+#ifndef MIN_CHUNK_BYTES
+#define MIN_CHUNK_BYTES 65536
+#endif
+
+static int is_ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+// Pré-varredura: devolve as posições (com linha/coluna) de cada 'fn' no
+// nível de chaves zero, ou da anotação (@memo) logo antes dele. Segue as
+// mesmas regras do lexer para strings e comentários, para que chaves
+// dentro deles não contem.
+int split_top_level_fns(const char* s, int length, SplitPoint** out) {
+    int capacity = 64;
+    int count = 0;
+    SplitPoint* points = malloc(sizeof(SplitPoint) * capacity);
+    if (!points) {
+        perror("Failed to allocate split points");
+        exit(EXIT_FAILURE);
+    }
+
+    int depth = 0;
+    int line = 1;
+    int line_start = 0;
+    int i = 0;
+    // '@' de nível zero ainda sem o 'fn' que ela anota, ou -1; named diz
+    // se o nome da anotação já passou. Espaços e comentários podem vir
+    // entre '@', o nome e o 'fn', como no lexer.
+    int at = -1, at_line = 0, at_column = 0;
+    int named = 0;
+    while (i < length && s[i] != '\0') {
+        char c = s[i];
+        if (c == '\n') {
+            line++;
+            line_start = ++i;
+        } else if (c == '/' && s[i + 1] == '/') {
+            while (i < length && s[i] != '\n' && s[i] != '\0') i++;
+        } else if (c == '/' && s[i + 1] == '*') {
+            i += 2;
+            while (i < length && s[i] != '\0' && !(s[i] == '*' && s[i + 1] == '/')) {
+                if (s[i] == '\n') {
+                    line++;
+                    line_start = i + 1;
+                }
+                i++;
+            }
+            if (i < length && s[i] != '\0') i += 2;
+        } else if (c == '"') {
+            at = -1;
+            i++;
+            while (i < length && s[i] != '\0' && s[i] != '"') {
+                if (s[i] == '\\' && s[i + 1] == '"') {
+                    i += 2;
+                    continue;
+                }
+                if (s[i] == '\n') {
+                    line++;
+                    line_start = i + 1;
+                }
+                i++;
+            }
+            if (i < length && s[i] == '"') i++;
+        } else if (c == '@' && depth == 0) {
+            at = i;
+            at_line = line;
+            at_column = i - line_start + 1;
+            named = 0;
+            i++;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            i++;
+        } else if (c == '{') {
+            at = -1;
+            depth++;
+            i++;
+        } else if (c == '}') {
+            if (depth > 0) depth--;
+            i++;
+        } else if (is_ident_char(c)) {
+            int start = i;
+            while (i < length && is_ident_char(s[i])) i++;
+            if (depth == 0 && i - start == 2 && s[start] == 'f' && s[start + 1] == 'n') {
+                if (count == capacity) {
+                    capacity *= 2;
+                    points = realloc(points, sizeof(SplitPoint) * capacity);
+                    if (!points) {
+                        perror("Failed to allocate split points");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                points[count].start = at >= 0 ? at : start;
+                points[count].line = at >= 0 ? at_line : line;
+                points[count].column = at >= 0 ? at_column : start - line_start + 1;
+                count++;
+                at = -1;
+            } else if (at >= 0 && !named && i - start == 4 && memcmp(s + start, "memo", 4) == 0) {
+                named = 1;
+            } else {
+                at = -1;
+            }
+        } else {
+            at = -1;
+            i++;
+        }
+    }
+    *out = points;
+    return count;
+}
+
+typedef struct {
+    int start;
+    int end;
+    int line;
+    int column;
+    ASTNode* head;
+    ASTNode* tail;
+    SymbolTable* symbols;   // ids locais do pedaço, traduzidos no fim
+} Chunk;
+
+typedef struct {
+    const char* source;
+    Chunk* chunks;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} WorkQueue;
+
+// O nó de programa de cada pedaço fica órfão na arena; só a lista importa.
+static void parse_chunk(const char* source, Chunk* c, Arena* arena) {
+    Lexer* lexer = lexer_init_range(source, c->start, c->end, c->line, c->column);
+    TokenBuffer* tokens = token_buffer_build(lexer);
+    Parser* parser = parser_init_tokens(lexer, tokens, arena);
+    ASTProgram* program = parse_program_v2(parser);
+
+    c->head = program->declarations;
+    c->tail = c->head;
+    while (c->tail && c->tail->next) c->tail = c->tail->next;
+    c->symbols = lexer->symbols;
+    lexer->owns_symbols = 0;
+
+    parser_free(parser);
+    token_buffer_free(tokens);
+    lexer_free(lexer);
+}
+
+// Cada thread tem a sua arena, então alocar nós não exige lock.
+typedef struct {
+    WorkQueue* queue;
+    Arena* arena;
+} Worker;
+
+static void* worker(void* arg) {
+    Worker* w = arg;
+    WorkQueue* q = w->queue;
+    while (1) {
+        pthread_mutex_lock(&q->lock);
+        int index = q->next++;
+        pthread_mutex_unlock(&q->lock);
+        if (index >= q->count) break;
+        parse_chunk(q->source, &q->chunks[index], w->arena);
+    }
+    return NULL;
+}
+
+// Troca os ids locais de um pedaço pelos ids da tabela global.
+static void remap(ASTNode* node, void* state) {
+    const int* map = *(const int**)state;
+    switch (node->type) {
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = (ASTVarDecl*)node;
+            n->name = map[n->name];
+            break;
+        }
+        case AST_FN_DECL: {
+            ASTFnDecl* n = (ASTFnDecl*)node;
+            n->name = map[n->name];
+            for (int i = 0; i < n->param_count; i++) n->params[i] = map[n->params[i]];
+            break;
+        }
+        case AST_ASSIGN_STMT: ((ASTAssignStmt*)node)->name = map[((ASTAssignStmt*)node)->name]; break;
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR: ((ASTCallStmt*)node)->name = map[((ASTCallStmt*)node)->name]; break;
+        case AST_IDENTIFIER: ((ASTIdentifier*)node)->name = map[((ASTIdentifier*)node)->name]; break;
+        default: break;
+    }
+}
+
+// Interna os nomes de cada pedaço na tabela global, na ordem do arquivo: os
+// ids resultantes são os mesmos que o parser serial atribuiria.
+static void merge_symbols(SymbolTable* global, Chunk* chunks, int count) {
+    int* map = NULL;
+    int map_capacity = 0;
+    PassManager* pm = pass_manager_new();
+    Pass pass = { "remap", &map, NULL, remap, NULL, NULL };
+    pass_manager_add(pm, &pass);
+    for (int i = 0; i < count; i++) {
+        SymbolTable* local = chunks[i].symbols;
+        int n = symtab_count(local);
+        if (n > map_capacity) {
+            map_capacity = n;
+            map = realloc(map, sizeof(int) * map_capacity);
+            if (!map) {
+                perror("Failed to allocate symbol map");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int id = 0; id < n; id++) {
+            map[id] = symtab_intern(global, symtab_name(local, id), symtab_length(local, id));
+        }
+        pass_manager_run_list(pm, &chunks[i].head);
+        symtab_free(local);
+    }
+    pass_manager_free(pm);
+    free(map);
+}
+
+ASTProgram* parse_program_parallel(CompileContext* ctx, const char* source, int length, int threads) {
+    SplitPoint* points;
+    int npoints = split_top_level_fns(source, length, &points);
+
+    // Agrupa fronteiras consecutivas em pedaços de tamanho parecido. O
+    // primeiro pedaço sempre começa no início do arquivo.
+    int target = threads * CHUNKS_PER_THREAD;
+    int chunk_bytes = length / (target > 0 ? target : 1);
+    if (chunk_bytes < MIN_CHUNK_BYTES) chunk_bytes = MIN_CHUNK_BYTES;
+
+    Chunk* chunks = malloc(sizeof(Chunk) * (npoints + 1));
+    if (!chunks) {
+        perror("Failed to allocate chunks");
+        exit(EXIT_FAILURE);
+    }
+    int count = 0;
+    chunks[0].start = 0;
+    chunks[0].line = 1;
+    chunks[0].column = 1;
+    count = 1;
+    for (int i = 0; i < npoints; i++) {
+        if (points[i].start - chunks[count - 1].start >= chunk_bytes) {
+            chunks[count - 1].end = points[i].start;
+            chunks[count].start = points[i].start;
+            chunks[count].line = points[i].line;
+            chunks[count].column = points[i].column;
+            count++;
+        }
+    }
+    chunks[count - 1].end = length;
+    free(points);
+
+    WorkQueue q;
+    q.source = source;
+    q.chunks = chunks;
+    q.count = count;
+    q.next = 0;
+    pthread_mutex_init(&q.lock, NULL);
+
+    if (threads > count) threads = count;
+    if (threads < 1) threads = 1;
+    // As arenas são criadas aqui, antes das threads, porque o contexto não
+    // é protegido por lock.
+    Worker* workers = malloc(sizeof(Worker) * threads);
+    if (!workers) {
+        perror("Failed to allocate threads");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i].queue = &q;
+        workers[i].arena = context_new_arena(ctx, "ast/thread");
+    }
+    if (threads == 1) {
+        worker(&workers[0]);
+    } else {
+        pthread_t* ids = malloc(sizeof(pthread_t) * threads);
+        if (!ids) {
+            perror("Failed to allocate threads");
+            exit(EXIT_FAILURE);
+        }
+        int started = 0;
+        for (; started < threads; started++) {
+            if (pthread_create(&ids[started], NULL, worker, &workers[started]) != 0) break;
+        }
+        // Se nenhuma thread subiu, a própria chamadora faz o trabalho.
+        if (started == 0) worker(&workers[0]);
+        for (int i = 0; i < started; i++) pthread_join(ids[i], NULL);
+        free(ids);
+    }
+    pthread_mutex_destroy(&q.lock);
+
+    merge_symbols(ctx->symbols, chunks, count);
+
+    // Costura na ordem do source.
+    ASTProgram* program = ast_new_program(workers[0].arena);
+    free(workers);
+    ASTNode* tail = NULL;
+    for (int i = 0; i < count; i++) {
+        if (!chunks[i].head) continue;
+        if (tail) {
+            tail->next = chunks[i].head;
+        } else {
+            program->declarations = chunks[i].head;
+        }
+        tail = chunks[i].tail;
+    }
+    free(chunks);
+    return program;
+}
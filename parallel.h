@@ -0,0 +1,22 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "ast.h"
+#include "context.h"
+
+// Front-end paralelo: o source é dividido nas fronteiras de 'fn' de nível
+// superior, cada pedaço é lexado e parseado por uma thread e as listas de
+// declarações são costuradas de volta na ordem do arquivo, então o resultado
+// é o mesmo do parser serial. Cada thread aloca numa arena própria do
+// contexto; a AST resultante vive até context_free. Os pedaços internam
+// nomes em tabelas locais, traduzidas para ctx->symbols depois do join.
+typedef struct {
+    int start;
+    int line;
+    int column;
+} SplitPoint;
+
+int split_top_level_fns(const char* source, int length, SplitPoint** out);
+ASTProgram* parse_program_parallel(CompileContext* ctx, const char* source, int length, int threads);
+
+#endif
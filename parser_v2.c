@@ -1,42 +1,109 @@
-#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "lexer_v2.h"
 #include "ast.h"
+#include "parser_v2.h"
 
-typedef struct {
+// O parser lê tokens sob demanda do lexer ou, quando tokens != NULL, de um
+// TokenBuffer já pronto, onde o lookahead é só um índice.
+struct Parser {
     Lexer* lexer;
+    Arena* arena;       // destino de todos os nós criados
+
     Token current;
-} Parser;
+    const TokenBuffer* tokens;
+    int index;
+    // Pilhas do parser de expressões (ver parse_expression).
+    ASTNode** operands;
+    int operand_count;
+    int operand_capacity;
+    struct PendingOp* ops;
+    int op_count;
+    int op_capacity;
+    // Nomes de parâmetros lidos antes de saber quantos são.
+    int* names;
+    int name_capacity;
+};
 
-Parser* parser_init(Lexer* lexer) {
-    Parser* p = malloc(sizeof(Parser));
+Parser* parser_init(Lexer* lexer, Arena* arena) {
+    Parser* p = calloc(1, sizeof(Parser));
     if (!p) {
         perror("Failed to allocate Parser");
         exit(EXIT_FAILURE);
     }
     p->lexer = lexer;
+    p->arena = arena;
+    p->tokens = NULL;
+    p->index = 0;
     p->current = lexer_next_token(lexer);
     return p;
 }
 
+// O lexer continua necessário para o texto dos tokens e os símbolos.
+Parser* parser_init_tokens(Lexer* lexer, const TokenBuffer* tokens, Arena* arena) {
+    Parser* p = calloc(1, sizeof(Parser));
+    if (!p) {
+        perror("Failed to allocate Parser");
+        exit(EXIT_FAILURE);
+    }
+    p->lexer = lexer;
+    p->arena = arena;
+    p->tokens = tokens;
+    p->index = 0;
+    p->current = token_buffer_get(tokens, 0);
+    return p;
+}
+
 void parser_free(Parser* p) {
     if (!p) return;
-    token_free(p->current);
+    free(p->operands);
+    free(p->ops);
+    free(p->names);
     free(p);
 }
 
+Arena* parser_arena(const Parser* p) {
+    return p->arena;
+}
+
+// Tabela onde vivem os ids de nome dos nós que este parser cria.
+SymbolTable* parser_symbols(const Parser* p) {
+    return p->lexer->symbols;
+}
+
 static void advance_p(Parser* p) {
-    token_free(p->current);
-    p->current = lexer_next_token(p->lexer);
+    if (p->tokens) {
+        p->current = token_buffer_get(p->tokens, ++p->index);
+    } else {
+        p->current = lexer_next_token(p->lexer);
+    }
+}
+
+// Token k posições à frente do atual (k = 0 é o próprio atual).
+Token parser_peek(Parser* p, int k) {
+    if (k == 0) return p->current;
+    if (p->tokens) return token_buffer_get(p->tokens, p->index + k);
+
+    int pos = p->lexer->pos;
+    int line = p->lexer->line;
+    int col = p->lexer->column;
+    Token t = p->current;
+    for (int i = 0; i < k && t.type != TOKEN_EOF; i++) {
+        t = lexer_next_token(p->lexer);
+    }
+    p->lexer->pos = pos;
+    p->lexer->line = line;
+    p->lexer->column = col;
+    return t;
 }
 
 static void error(Parser* p, const char* msg) {
     fprintf(stderr, "\n[Erro] Linha %d, Coluna %d: %s\n", 
             p->current.line, p->current.column, msg);
-    fprintf(stderr, "       Token atual: '%s' (%s)\n", 
-            p->current.value, token_type_name(p->current.type));
+    fprintf(stderr, "       Token atual: '%.*s' (%s)\n", 
+            p->current.length, token_text(p->lexer, p->current),
+            token_type_name(p->current.type));
     exit(1);
 }
 
@@ -45,33 +112,66 @@ static void eat_p(Parser* p, TokenType type) {
         advance_p(p);
     } else {
         char buf[128];
-        snprintf(buf, sizeof(buf), "Esperado '%s', encontrado '%s'", 
-                 token_type_name(type), p->current.value);
+        snprintf(buf, sizeof(buf), "Esperado '%s', encontrado '%.*s'", 
+                 token_type_name(type), p->current.length,
+                 token_text(p->lexer, p->current));
         error(p, buf);
     }
 }
 
+static int current_int(Parser* p) {
+    const char* s = token_text(p->lexer, p->current);
+    unsigned int val = 0;
+    for (int i = 0; i < p->current.length; i++) {
+        val = val * 10 + (unsigned int)(s[i] - '0');
+    }
+    return (int)val;
+}
+
 ASTNode* parse_expression(Parser* p);
+static void push_operand(Parser* p, ASTNode* node);
+
+// Os argumentos ficam na pilha de operandos até a ')' e só então são
+// copiados para a arena, já com o tamanho final.
+static ASTNode** parse_call_args(Parser* p, int* count) {
+    eat_p(p, TOKEN_LPAREN);
+    int base = p->operand_count;
+    while (p->current.type != TOKEN_RPAREN && p->current.type != TOKEN_EOF) {
+        ASTNode* arg = parse_expression(p);
+        push_operand(p, arg);
+        if (p->current.type == TOKEN_COMMA) advance_p(p);
+    }
+    eat_p(p, TOKEN_RPAREN);
+    *count = p->operand_count - base;
+    ASTNode** args = NULL;
+    if (*count > 0) {
+        args = arena_alloc(p->arena, sizeof(ASTNode*) * *count);
+        memcpy(args, p->operands + base, sizeof(ASTNode*) * *count);
+    }
+    p->operand_count = base;
+    return args;
+}
 
 static ASTNode* parse_primary(Parser* p) {
     if (p->current.type == TOKEN_INT) {
-        int val = atoi(p->current.value);
-        ASTNode* node = (ASTNode*)ast_new_int_literal(val, p->current.line, p->current.column);
+        int val = current_int(p);
+        ASTNode* node = (ASTNode*)ast_new_int_literal(p->arena, val, p->current.line, p->current.column);
         advance_p(p);
         return node;
     } 
     else if (p->current.type == TOKEN_STRING) {
-        ASTNode* node = (ASTNode*)ast_new_string_literal(p->current.value, p->current.line, p->current.column);
+        ASTNode* node = (ASTNode*)ast_new_string_literal(p->arena, token_text(p->lexer, p->current),
+                                                         p->current.length, p->current.line, p->current.column);
         advance_p(p);
         return node;
     }
     else if (p->current.type == TOKEN_TRUE) {
-        ASTNode* node = (ASTNode*)ast_new_bool_literal(1, p->current.line, p->current.column);
+        ASTNode* node = (ASTNode*)ast_new_bool_literal(p->arena, 1, p->current.line, p->current.column);
         advance_p(p);
         return node;
     }
     else if (p->current.type == TOKEN_FALSE) {
-        ASTNode* node = (ASTNode*)ast_new_bool_literal(0, p->current.line, p->current.column);
+        ASTNode* node = (ASTNode*)ast_new_bool_literal(p->arena, 0, p->current.line, p->current.column);
         advance_p(p);
         return node;
     }
@@ -85,7 +185,7 @@ static ASTNode* parse_primary(Parser* p) {
             prompt = parse_expression(p);
         }
         eat_p(p, TOKEN_RPAREN);
-        return ast_new_input_expr(prompt, line, col);
+        return ast_new_input_expr(p->arena, prompt, line, col);
     }
     else if (p->current.type == TOKEN_ISNUMBER) {
         int line = p->current.line;
@@ -94,7 +194,7 @@ static ASTNode* parse_primary(Parser* p) {
         eat_p(p, TOKEN_LPAREN);
         ASTNode* expr = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
-        return ast_new_isnumber_expr(expr, line, col);
+        return ast_new_isnumber_expr(p->arena, expr, line, col);
     }
     else if (p->current.type == TOKEN_ISSTRING) {
         int line = p->current.line;
@@ -103,7 +203,7 @@ static ASTNode* parse_primary(Parser* p) {
         eat_p(p, TOKEN_LPAREN);
         ASTNode* expr = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
-        return ast_new_isstring_expr(expr, line, col);
+        return ast_new_isstring_expr(p->arena, expr, line, col);
     }
     else if (p->current.type == TOKEN_EXIT) {
         int line = p->current.line;
@@ -112,7 +212,7 @@ static ASTNode* parse_primary(Parser* p) {
         eat_p(p, TOKEN_LPAREN);
         ASTNode* code = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
-        return ast_new_exit_stmt(code, line, col);
+        return ast_new_exit_stmt(p->arena, code, line, col);
     }
     else if (p->current.type == TOKEN_ABS) {
         int line = p->current.line;
@@ -121,136 +221,148 @@ static ASTNode* parse_primary(Parser* p) {
         eat_p(p, TOKEN_LPAREN);
         ASTNode* expr = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
-        return ast_new_abs_expr(expr, line, col);
+        return ast_new_abs_expr(p->arena, expr, line, col);
     }
     else if (p->current.type == TOKEN_IDENTIFIER) {
-        char* name = strdup(p->current.value);
+        int name = p->current.symbol;
         int line = p->current.line;
         int column = p->current.column;
         advance_p(p);
         
         if (p->current.type == TOKEN_LPAREN) {
-            eat_p(p, TOKEN_LPAREN);
-            ASTNode** args = NULL;
-            int arg_count = 0;
-            while (p->current.type != TOKEN_RPAREN && p->current.type != TOKEN_EOF) {
-                args = realloc(args, sizeof(ASTNode*) * (arg_count + 1));
-                args[arg_count++] = parse_expression(p);
-                if (p->current.type == TOKEN_COMMA) advance_p(p);
-            }
-            eat_p(p, TOKEN_RPAREN);
-            ASTNode* node = (ASTNode*)ast_new_call_expr(name, args, arg_count, line, column);
-            free(name);
+            int arg_count;
+            ASTNode** args = parse_call_args(p, &arg_count);
+            ASTNode* node = (ASTNode*)ast_new_call_expr(p->arena, name, args, arg_count, line, column);
             return node;
         } else {
-            ASTNode* node = (ASTNode*)ast_new_identifier(name, line, column);
-            free(name);
+            ASTNode* node = (ASTNode*)ast_new_identifier(p->arena, name, line, column);
             return node;
         }
     }
-    else if (p->current.type == TOKEN_LPAREN) {
-        eat_p(p, TOKEN_LPAREN);
-        ASTNode* expr = parse_expression(p);
-        eat_p(p, TOKEN_RPAREN);
-        return (ASTNode*)ast_new_grouping_expr(expr, p->current.line, p->current.column);
-    }
     else {
         error(p, "Expressão inválida");
         return NULL;
     }
 }
 
-static ASTNode* parse_unary(Parser* p) {
-    if (p->current.type == TOKEN_BANG || p->current.type == TOKEN_MINUS) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_unary(p);
-        return (ASTNode*)ast_new_unary_expr(op_type, right, line, column);
-    } else {
-        return parse_primary(p);
-    }
-}
+// Poder de ligação dos operadores binários, indexado por TokenType; 0 indica
+// que o token não é um operador binário. Todos são associativos à esquerda.
+static const unsigned char binary_power[TOKEN_UNKNOWN + 1] = {
+    [TOKEN_OR_OR] = 1,
+    [TOKEN_AND_AND] = 2,
+    [TOKEN_EQ_EQ] = 3, [TOKEN_BANG_EQ] = 3,
+    [TOKEN_LT] = 4, [TOKEN_GT] = 4, [TOKEN_LT_EQ] = 4, [TOKEN_GT_EQ] = 4,
+    [TOKEN_PLUS] = 5, [TOKEN_MINUS] = 5,
+    [TOKEN_STAR] = 6, [TOKEN_SLASH] = 6, [TOKEN_PERCENT] = 6,
+};
 
-static ASTNode* parse_factor(Parser* p) {
-    ASTNode* left = parse_unary(p);
-    while (p->current.type == TOKEN_STAR || p->current.type == TOKEN_SLASH || 
-           p->current.type == TOKEN_PERCENT) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_unary(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
-    }
-    return left;
-}
+// Operadores prefixos ligam mais forte que qualquer binário.
+static const unsigned char prefix_power[TOKEN_UNKNOWN + 1] = {
+    [TOKEN_BANG] = 7, [TOKEN_MINUS] = 7,
+};
 
-static ASTNode* parse_term(Parser* p) {
-    ASTNode* left = parse_factor(p);
-    while (p->current.type == TOKEN_PLUS || p->current.type == TOKEN_MINUS) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_factor(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
-    }
-    return left;
-}
+typedef enum { OP_BINARY, OP_UNARY, OP_PAREN } OpKind;
 
-static ASTNode* parse_comparison(Parser* p) {
-    ASTNode* left = parse_term(p);
-    while (p->current.type == TOKEN_LT || p->current.type == TOKEN_GT ||
-           p->current.type == TOKEN_LT_EQ || p->current.type == TOKEN_GT_EQ) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_term(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
+typedef struct PendingOp {
+    OpKind kind;
+    TokenType type;
+    int power;
+    int line;
+    int column;
+} PendingOp;
+
+static void push_operand(Parser* p, ASTNode* node) {
+    if (p->operand_count == p->operand_capacity) {
+        p->operand_capacity = p->operand_capacity ? p->operand_capacity * 2 : 64;
+        p->operands = realloc(p->operands, sizeof(ASTNode*) * p->operand_capacity);
+        if (!p->operands) {
+            perror("Failed to grow Parser stack");
+            exit(EXIT_FAILURE);
+        }
     }
-    return left;
+    p->operands[p->operand_count++] = node;
 }
 
-static ASTNode* parse_equality(Parser* p) {
-    ASTNode* left = parse_comparison(p);
-    while (p->current.type == TOKEN_EQ_EQ || p->current.type == TOKEN_BANG_EQ) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_comparison(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
+static void push_op(Parser* p, OpKind kind, int power) {
+    if (p->op_count == p->op_capacity) {
+        p->op_capacity = p->op_capacity ? p->op_capacity * 2 : 64;
+        p->ops = realloc(p->ops, sizeof(PendingOp) * p->op_capacity);
+        if (!p->ops) {
+            perror("Failed to grow Parser stack");
+            exit(EXIT_FAILURE);
+        }
     }
-    return left;
+    PendingOp* op = &p->ops[p->op_count++];
+    op->kind = kind;
+    op->type = p->current.type;
+    op->power = power;
+    op->line = p->current.line;
+    op->column = p->current.column;
 }
 
-static ASTNode* parse_and(Parser* p) {
-    ASTNode* left = parse_equality(p);
-    while (p->current.type == TOKEN_AND_AND) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
-        advance_p(p);
-        ASTNode* right = parse_equality(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
+static void reduce(Parser* p) {
+    PendingOp op = p->ops[--p->op_count];
+    ASTNode* right = p->operands[--p->operand_count];
+    if (op.kind == OP_UNARY) {
+        push_operand(p, (ASTNode*)ast_new_unary_expr(p->arena, op.type, right, op.line, op.column));
+    } else {
+        ASTNode* left = p->operands[--p->operand_count];
+        push_operand(p, (ASTNode*)ast_new_binary_expr(p->arena, left, op.type, right, op.line, op.column));
     }
-    return left;
 }
 
+// Parser de precedência (Pratt) com pilhas explícitas: operadores, prefixos
+// e parênteses não consomem pilha do C, então expressões patologicamente
+// profundas não estouram a pilha. Só argumentos de chamada recorrem.
+// As pilhas vivem no Parser e são compartilhadas pelas chamadas aninhadas;
+// cada chamada só mexe acima das alturas que encontrou ao entrar.
 ASTNode* parse_expression(Parser* p) {
-    ASTNode* left = parse_and(p);
-    while (p->current.type == TOKEN_OR_OR) {
-        TokenType op_type = p->current.type;
-        int line = p->current.line;
-        int column = p->current.column;
+    int op_base = p->op_count;
+    int open_parens = 0;
+
+    while (1) {
+        // Posição de operando: prefixos e '(' empilham, o resto é primário.
+        TokenType type = p->current.type;
+        if (prefix_power[type]) {
+            push_op(p, OP_UNARY, prefix_power[type]);
+            advance_p(p);
+            continue;
+        }
+        if (type == TOKEN_LPAREN) {
+            push_op(p, OP_PAREN, 0);
+            open_parens++;
+            advance_p(p);
+            continue;
+        }
+        push_operand(p, parse_primary(p));
+
+        // Posição de operador: fecha parênteses e reduz pelo poder de ligação.
+        while (open_parens > 0 && p->current.type == TOKEN_RPAREN) {
+            while (p->ops[p->op_count - 1].kind != OP_PAREN) reduce(p);
+            p->op_count--;
+            open_parens--;
+            advance_p(p);
+            ASTNode* inner = p->operands[--p->operand_count];
+            push_operand(p, (ASTNode*)ast_new_grouping_expr(p->arena, inner, p->current.line, p->current.column));
+        }
+
+        int power = binary_power[p->current.type];
+        if (!power) break;
+        while (p->op_count > op_base && p->ops[p->op_count - 1].kind != OP_PAREN &&
+               p->ops[p->op_count - 1].power >= power) {
+            reduce(p);
+        }
+        push_op(p, OP_BINARY, power);
         advance_p(p);
-        ASTNode* right = parse_and(p);
-        left = (ASTNode*)ast_new_binary_expr(left, op_type, right, line, column);
     }
-    return left;
+
+    while (p->op_count > op_base) {
+        if (p->ops[p->op_count - 1].kind == OP_PAREN) {
+            eat_p(p, TOKEN_RPAREN);
+        }
+        reduce(p);
+    }
+    return p->operands[--p->operand_count];
 }
 
 ASTNode* parse_statement(Parser* p);
@@ -272,67 +384,83 @@ static ASTNode* parse_block(Parser* p) {
         }
     }
     eat_p(p, TOKEN_RBRACE);
-    return (ASTNode*)ast_new_block(head, p->current.line, p->current.column);
+    return (ASTNode*)ast_new_block(p->arena, head, p->current.line, p->current.column);
 }
 
 ASTNode* parse_statement(Parser* p) {
     if (p->current.type == TOKEN_LET) {
         eat_p(p, TOKEN_LET);
-        char* name = strdup(p->current.value);
+        int name = p->current.symbol;
         int line = p->current.line;
         int column = p->current.column;
         eat_p(p, TOKEN_IDENTIFIER);
         eat_p(p, TOKEN_EQUALS);
         ASTNode* initializer = parse_expression(p);
         eat_p(p, TOKEN_SEMICOLON);
-        ASTNode* node = (ASTNode*)ast_new_var_decl(name, initializer, line, column);
-        free(name);
+        ASTNode* node = (ASTNode*)ast_new_var_decl(p->arena, name, initializer, line, column);
         return node;
     }
+    else if (p->current.type == TOKEN_AT) {
+        // Anotação de função; só existe @memo (memo.h).
+        eat_p(p, TOKEN_AT);
+        if (p->current.type != TOKEN_IDENTIFIER || p->current.length != 4 ||
+            memcmp(token_text(p->lexer, p->current), "memo", 4) != 0) {
+            char buf[128];
+            snprintf(buf, sizeof(buf), "Anotação desconhecida '@%.*s'",
+                     p->current.length, token_text(p->lexer, p->current));
+            error(p, buf);
+        }
+        advance_p(p);
+        if (p->current.type != TOKEN_FN) error(p, "Esperado 'fn' depois de @memo");
+        ASTFnDecl* fn = (ASTFnDecl*)parse_statement(p);
+        fn->memo = 1;
+        return (ASTNode*)fn;
+    }
     else if (p->current.type == TOKEN_FN) {
         eat_p(p, TOKEN_FN);
-        char* name = strdup(p->current.value);
+        int name = p->current.symbol;
         int line = p->current.line;
         int column = p->current.column;
         eat_p(p, TOKEN_IDENTIFIER);
         eat_p(p, TOKEN_LPAREN);
         
-        char** params = NULL;
         int param_count = 0;
-        
         while (p->current.type != TOKEN_RPAREN && p->current.type != TOKEN_EOF) {
-            params = realloc(params, sizeof(char*) * (param_count + 1));
-            params[param_count] = strdup(p->current.value);
-            param_count++;
+            if (param_count == p->name_capacity) {
+                p->name_capacity = p->name_capacity ? p->name_capacity * 2 : 16;
+                p->names = realloc(p->names, sizeof(int) * p->name_capacity);
+                if (!p->names) {
+                    perror("Failed to grow Parser stack");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            p->names[param_count++] = p->current.symbol;
             eat_p(p, TOKEN_IDENTIFIER);
             if (p->current.type == TOKEN_COMMA) advance_p(p);
         }
         eat_p(p, TOKEN_RPAREN);
+
+        int* params = NULL;
+        if (param_count > 0) {
+            params = arena_alloc(p->arena, sizeof(int) * param_count);
+            memcpy(params, p->names, sizeof(int) * param_count);
+        }
         
         ASTNode* body = parse_block(p);
-        ASTNode* node = (ASTNode*)ast_new_fn_decl(name, params, param_count, body, line, column);
-        free(name);
+        ASTNode* node = (ASTNode*)ast_new_fn_decl(p->arena, name, params, param_count, body, line, column);
         return node;
     }
     else if (p->current.type == TOKEN_IDENTIFIER) {
-        char* name = strdup(p->current.value);
+        int name = p->current.symbol;
         int line = p->current.line;
         int column = p->current.column;
         advance_p(p);
         
         if (p->current.type == TOKEN_LPAREN) {
-            eat_p(p, TOKEN_LPAREN);
-            ASTNode** args = NULL;
-            int arg_count = 0;
-            while (p->current.type != TOKEN_RPAREN && p->current.type != TOKEN_EOF) {
-                args = realloc(args, sizeof(ASTNode*) * (arg_count + 1));
-                args[arg_count++] = parse_expression(p);
-                if (p->current.type == TOKEN_COMMA) advance_p(p);
-            }
-            eat_p(p, TOKEN_RPAREN);
+            int arg_count;
+            ASTNode** args = parse_call_args(p, &arg_count);
             eat_p(p, TOKEN_SEMICOLON);
-            ASTNode* node = (ASTNode*)ast_new_call_stmt(name, args, arg_count, line, column);
-            free(name);
+            ASTNode* node = (ASTNode*)ast_new_call_stmt(p->arena, name, args, arg_count, line, column);
             return node;
         }
         else if (p->current.type == TOKEN_EQUALS || p->current.type == TOKEN_PLUS_EQ ||
@@ -341,32 +469,28 @@ ASTNode* parse_statement(Parser* p) {
             advance_p(p);
             ASTNode* value = parse_expression(p);
             eat_p(p, TOKEN_SEMICOLON);
-            ASTNode* node = (ASTNode*)ast_new_assign_stmt(name, value, op_type, line, column);
-            free(name);
+            ASTNode* node = (ASTNode*)ast_new_assign_stmt(p->arena, name, value, op_type, line, column);
             return node;
         } else if (p->current.type == TOKEN_PLUS_PLUS) {
             advance_p(p);
             eat_p(p, TOKEN_SEMICOLON);
-            ASTNode* one = (ASTNode*)ast_new_int_literal(1, line, column);
-            ASTNode* ident = (ASTNode*)ast_new_identifier(name, line, column);
-            ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_PLUS, one, line, column);
-            ASTNode* node = (ASTNode*)ast_new_assign_stmt(name, expr, TOKEN_EQUALS, line, column);
-            free(name);
+            ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, line, column);
+            ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, name, line, column);
+            ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_PLUS, one, line, column);
+            ASTNode* node = (ASTNode*)ast_new_assign_stmt(p->arena, name, expr, TOKEN_EQUALS, line, column);
             return node;
         }
         else if (p->current.type == TOKEN_MINUS_MINUS) {
             advance_p(p);
             eat_p(p, TOKEN_SEMICOLON);
-            ASTNode* one = (ASTNode*)ast_new_int_literal(1, line, column);
-            ASTNode* ident = (ASTNode*)ast_new_identifier(name, line, column);
-            ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_MINUS, one, line, column);
-            ASTNode* node = (ASTNode*)ast_new_assign_stmt(name, expr, TOKEN_EQUALS, line, column);
-            free(name);
+            ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, line, column);
+            ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, name, line, column);
+            ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_MINUS, one, line, column);
+            ASTNode* node = (ASTNode*)ast_new_assign_stmt(p->arena, name, expr, TOKEN_EQUALS, line, column);
             return node;
         }
         else {
             error(p, "Esperado operador de atribuição ou chamada de função");
-            free(name);
             return NULL;
         }
     }
@@ -376,7 +500,7 @@ ASTNode* parse_statement(Parser* p) {
         ASTNode* expr = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
         eat_p(p, TOKEN_SEMICOLON);
-        return (ASTNode*)ast_new_print_stmt(expr, p->current.line, p->current.column);
+        return (ASTNode*)ast_new_print_stmt(p->arena, expr, p->current.line, p->current.column);
     }
     else if (p->current.type == TOKEN_IF) {
         eat_p(p, TOKEN_IF);
@@ -396,7 +520,7 @@ ASTNode* parse_statement(Parser* p) {
                 else_branch = parse_block(p);
             }
         }
-        return (ASTNode*)ast_new_if_stmt(condition, then_branch, else_branch, line, column);
+        return (ASTNode*)ast_new_if_stmt(p->arena, condition, then_branch, else_branch, line, column);
     }
     else if (p->current.type == TOKEN_WHILE) {
         eat_p(p, TOKEN_WHILE);
@@ -406,7 +530,7 @@ ASTNode* parse_statement(Parser* p) {
         ASTNode* condition = parse_expression(p);
         eat_p(p, TOKEN_RPAREN);
         ASTNode* body = parse_block(p);
-        return (ASTNode*)ast_new_while_stmt(condition, body, line, column);
+        return (ASTNode*)ast_new_while_stmt(p->arena, condition, body, line, column);
     }
     else if (p->current.type == TOKEN_FOR) {
         eat_p(p, TOKEN_FOR);
@@ -417,16 +541,15 @@ ASTNode* parse_statement(Parser* p) {
         ASTNode* initializer = NULL;
         if (p->current.type == TOKEN_LET) {
             eat_p(p, TOKEN_LET);
-            char* v_name = strdup(p->current.value);
+            int v_name = p->current.symbol;
             int v_line = p->current.line;
             int v_column = p->current.column;
             eat_p(p, TOKEN_IDENTIFIER);
             eat_p(p, TOKEN_EQUALS);
             ASTNode* init_expr = parse_expression(p);
-            initializer = (ASTNode*)ast_new_var_decl(v_name, init_expr, v_line, v_column);
-            free(v_name);
+            initializer = (ASTNode*)ast_new_var_decl(p->arena, v_name, init_expr, v_line, v_column);
         } else if (p->current.type == TOKEN_IDENTIFIER) {
-            char* v_name = strdup(p->current.value);
+            int v_name = p->current.symbol;
             int assign_line = p->current.line;
             int assign_column = p->current.column;
             advance_p(p);
@@ -434,21 +557,20 @@ ASTNode* parse_statement(Parser* p) {
                 TokenType op_type = p->current.type;
                 advance_p(p);
                 ASTNode* value = parse_expression(p);
-                initializer = (ASTNode*)ast_new_assign_stmt(v_name, value, op_type, assign_line, assign_column);
+                initializer = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, value, op_type, assign_line, assign_column);
             } else if (p->current.type == TOKEN_PLUS_PLUS) {
                 advance_p(p);
-                ASTNode* one = (ASTNode*)ast_new_int_literal(1, assign_line, assign_column);
-                ASTNode* ident = (ASTNode*)ast_new_identifier(v_name, assign_line, assign_column);
-                ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_PLUS, one, assign_line, assign_column);
-                initializer = (ASTNode*)ast_new_assign_stmt(v_name, expr, TOKEN_EQUALS, assign_line, assign_column);
+                ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, assign_line, assign_column);
+                ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, v_name, assign_line, assign_column);
+                ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_PLUS, one, assign_line, assign_column);
+                initializer = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, expr, TOKEN_EQUALS, assign_line, assign_column);
             } else if (p->current.type == TOKEN_MINUS_MINUS) {
                 advance_p(p);
-                ASTNode* one = (ASTNode*)ast_new_int_literal(1, assign_line, assign_column);
-                ASTNode* ident = (ASTNode*)ast_new_identifier(v_name, assign_line, assign_column);
-                ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_MINUS, one, assign_line, assign_column);
-                initializer = (ASTNode*)ast_new_assign_stmt(v_name, expr, TOKEN_EQUALS, assign_line, assign_column);
+                ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, assign_line, assign_column);
+                ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, v_name, assign_line, assign_column);
+                ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_MINUS, one, assign_line, assign_column);
+                initializer = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, expr, TOKEN_EQUALS, assign_line, assign_column);
             }
-            free(v_name);
         }
         eat_p(p, TOKEN_SEMICOLON);
         
@@ -457,40 +579,39 @@ ASTNode* parse_statement(Parser* p) {
         
         ASTNode* increment = NULL;
         if (p->current.type == TOKEN_IDENTIFIER) {
-            char* v_name = strdup(p->current.value);
+            int v_name = p->current.symbol;
             int inc_line = p->current.line;
             int inc_column = p->current.column;
             advance_p(p);
             if (p->current.type == TOKEN_PLUS_PLUS) {
                 advance_p(p);
-                ASTNode* one = (ASTNode*)ast_new_int_literal(1, inc_line, inc_column);
-                ASTNode* ident = (ASTNode*)ast_new_identifier(v_name, inc_line, inc_column);
-                ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_PLUS, one, inc_line, inc_column);
-                increment = (ASTNode*)ast_new_assign_stmt(v_name, expr, TOKEN_EQUALS, inc_line, inc_column);
+                ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, inc_line, inc_column);
+                ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, v_name, inc_line, inc_column);
+                ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_PLUS, one, inc_line, inc_column);
+                increment = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, expr, TOKEN_EQUALS, inc_line, inc_column);
             } else if (p->current.type == TOKEN_MINUS_MINUS) {
                 advance_p(p);
-                ASTNode* one = (ASTNode*)ast_new_int_literal(1, inc_line, inc_column);
-                ASTNode* ident = (ASTNode*)ast_new_identifier(v_name, inc_line, inc_column);
-                ASTNode* expr = (ASTNode*)ast_new_binary_expr(ident, TOKEN_MINUS, one, inc_line, inc_column);
-                increment = (ASTNode*)ast_new_assign_stmt(v_name, expr, TOKEN_EQUALS, inc_line, inc_column);
+                ASTNode* one = (ASTNode*)ast_new_int_literal(p->arena, 1, inc_line, inc_column);
+                ASTNode* ident = (ASTNode*)ast_new_identifier(p->arena, v_name, inc_line, inc_column);
+                ASTNode* expr = (ASTNode*)ast_new_binary_expr(p->arena, ident, TOKEN_MINUS, one, inc_line, inc_column);
+                increment = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, expr, TOKEN_EQUALS, inc_line, inc_column);
             } else if (p->current.type == TOKEN_PLUS_EQ || p->current.type == TOKEN_MINUS_EQ || p->current.type == TOKEN_EQUALS) {
                 TokenType op_type = p->current.type;
                 advance_p(p);
                 ASTNode* value = parse_expression(p);
-                increment = (ASTNode*)ast_new_assign_stmt(v_name, value, op_type, inc_line, inc_column);
+                increment = (ASTNode*)ast_new_assign_stmt(p->arena, v_name, value, op_type, inc_line, inc_column);
             }
-            free(v_name);
         }
         
         eat_p(p, TOKEN_RPAREN);
         ASTNode* body = parse_block(p);
-        return (ASTNode*)ast_new_for_stmt(initializer, condition, increment, body, line, column);
+        return (ASTNode*)ast_new_for_stmt(p->arena, initializer, condition, increment, body, line, column);
     }
     else if (p->current.type == TOKEN_RETURN) {
         eat_p(p, TOKEN_RETURN);
         ASTNode* expression = parse_expression(p);
         eat_p(p, TOKEN_SEMICOLON);
-        return (ASTNode*)ast_new_return_stmt(expression, p->current.line, p->current.column);
+        return (ASTNode*)ast_new_return_stmt(p->arena, expression, p->current.line, p->current.column);
     }
     else if (p->current.type != TOKEN_EOF) {
         advance_p(p);
@@ -499,7 +620,7 @@ ASTNode* parse_statement(Parser* p) {
 }
 
 ASTProgram* parse_program_v2(Parser* p) {
-    ASTProgram* program = ast_new_program();
+    ASTProgram* program = ast_new_program(p->arena);
     ASTNode* head = NULL;
     ASTNode* current = NULL;
 
@@ -6,8 +6,12 @@
 
 typedef struct Parser Parser;
 
-Parser* parser_init(Lexer* lexer);
+Parser* parser_init(Lexer* lexer, Arena* arena);
+Parser* parser_init_tokens(Lexer* lexer, const TokenBuffer* tokens, Arena* arena);
 void parser_free(Parser* p);
+Arena* parser_arena(const Parser* p);
+SymbolTable* parser_symbols(const Parser* p);
+Token parser_peek(Parser* p, int k);
 ASTNode* parse_expression(Parser* p);
 ASTNode* parse_statement(Parser* p);
 ASTProgram* parse_program_v2(Parser* p);
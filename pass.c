@@ -0,0 +1,296 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pass.h"
+
+// Cronometrar cada callback custaria mais que os próprios passes. A
+// travessia inteira é medida exatamente, e só um passo (enter ou leave de
+// um nó) a cada PASS_SAMPLE_RATE tem cada callback cronometrado; o tempo
+// da travessia é repartido entre os passes na proporção das amostras. Uma
+// amostra inflada (a thread perdeu a CPU no meio, por exemplo) distorce as
+// proporções, mas nunca o total. begin/end são medidos exatamente.
+#define PASS_SAMPLE_RATE 64
+
+typedef struct {
+    Pass pass;
+    double seconds;     // begin/end
+    double sampled;     // enter/leave nos passos amostrados
+} PassEntry;
+
+// slot é o ponteiro que referencia o nó no pai, para que leave possa
+// substituí-lo. Em listas, o irmão seguinte só é empilhado quando o atual
+// termina, então a pilha não cresce com o comprimento da lista.
+typedef struct {
+    ASTNode** slot;
+    int in_list;
+    int entered;
+} Frame;
+
+struct PassManager {
+    PassEntry* passes;
+    int count;
+    int capacity;
+    Frame* stack;
+    int depth;
+    int stack_capacity;
+    double walk_seconds;
+    double total_seconds;
+    double sampled_steps;
+    double clock_cost;
+    long visits;
+    long steps;
+    int runs;
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+PassManager* pass_manager_new(void) {
+    PassManager* pm = calloc(1, sizeof(PassManager));
+    if (!pm) {
+        perror("Failed to allocate PassManager");
+        exit(EXIT_FAILURE);
+    }
+    double start = now(), end = start;
+    for (int i = 0; i < 256; i++) end = now();
+    pm->clock_cost = (end - start) / 256;
+    return pm;
+}
+
+void pass_manager_free(PassManager* pm) {
+    if (!pm) return;
+    free(pm->passes);
+    free(pm->stack);
+    free(pm);
+}
+
+void pass_manager_add(PassManager* pm, const Pass* pass) {
+    if (pm->count == pm->capacity) {
+        pm->capacity = pm->capacity ? pm->capacity * 2 : 8;
+        pm->passes = realloc(pm->passes, sizeof(PassEntry) * pm->capacity);
+        if (!pm->passes) {
+            perror("Failed to grow PassManager");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pm->passes[pm->count].pass = *pass;
+    pm->passes[pm->count].seconds = 0;
+    pm->passes[pm->count].sampled = 0;
+    pm->count++;
+}
+
+int pass_manager_count(const PassManager* pm) {
+    return pm->count;
+}
+
+static void push(PassManager* pm, ASTNode** slot, int in_list) {
+    if (!*slot) return;
+    if (pm->depth == pm->stack_capacity) {
+        pm->stack_capacity = pm->stack_capacity ? pm->stack_capacity * 2 : 256;
+        pm->stack = realloc(pm->stack, sizeof(Frame) * pm->stack_capacity);
+        if (!pm->stack) {
+            perror("Failed to grow PassManager stack");
+            exit(EXIT_FAILURE);
+        }
+    }
+    Frame* f = &pm->stack[pm->depth++];
+    f->slot = slot;
+    f->in_list = in_list;
+    f->entered = 0;
+}
+
+// Empilha os filhos em ordem inversa, para que saiam na ordem do source.
+static void push_children(PassManager* pm, ASTNode* node) {
+    switch (node->type) {
+        case AST_PROGRAM:
+            push(pm, &((ASTProgram*)node)->declarations, 1);
+            break;
+        case AST_VAR_DECL:
+            push(pm, &((ASTVarDecl*)node)->initializer, 0);
+            break;
+        case AST_FN_DECL:
+            push(pm, &((ASTFnDecl*)node)->body, 0);
+            break;
+        case AST_BLOCK:
+            push(pm, &((ASTBlock*)node)->statements, 1);
+            break;
+        case AST_IF_STMT:
+            push(pm, &((ASTIfStmt*)node)->else_branch, 0);
+            push(pm, &((ASTIfStmt*)node)->then_branch, 0);
+            push(pm, &((ASTIfStmt*)node)->condition, 0);
+            break;
+        case AST_WHILE_STMT:
+            push(pm, &((ASTWhileStmt*)node)->body, 0);
+            push(pm, &((ASTWhileStmt*)node)->condition, 0);
+            break;
+        case AST_FOR_STMT:
+            push(pm, &((ASTForStmt*)node)->body, 0);
+            push(pm, &((ASTForStmt*)node)->increment, 0);
+            push(pm, &((ASTForStmt*)node)->condition, 0);
+            push(pm, &((ASTForStmt*)node)->initializer, 0);
+            break;
+        case AST_RETURN_STMT:
+        case AST_PRINT_STMT:
+        case AST_INPUT_EXPR:
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+        case AST_EXIT_STMT:
+        case AST_ABS_EXPR:
+            push(pm, &((ASTReturnStmt*)node)->expression, 0);
+            break;
+        case AST_ASSIGN_STMT:
+            push(pm, &((ASTAssignStmt*)node)->value, 0);
+            break;
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR: {
+            ASTCallStmt* call = (ASTCallStmt*)node;
+            for (int i = call->arg_count - 1; i >= 0; i--) push(pm, &call->args[i], 0);
+            break;
+        }
+        case AST_BINARY_EXPR:
+            push(pm, &((ASTBinaryExpr*)node)->right, 0);
+            push(pm, &((ASTBinaryExpr*)node)->left, 0);
+            break;
+        case AST_UNARY_EXPR:
+            push(pm, &((ASTUnaryExpr*)node)->right, 0);
+            break;
+        case AST_GROUPING_EXPR:
+            push(pm, &((ASTGroupingExpr*)node)->expression, 0);
+            break;
+        case AST_INLINE_EXPR:
+            push(pm, &((ASTInlineExpr*)node)->result, 0);
+            push(pm, &((ASTInlineExpr*)node)->statements, 1);
+            break;
+        case AST_INT_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOL_LITERAL:
+        case AST_IDENTIFIER:
+            break;
+    }
+}
+
+// Desconta a leitura do relógio, que custa tanto quanto um callback leve.
+static double since(const PassManager* pm, double start, int reads) {
+    double elapsed = now() - start - reads * pm->clock_cost;
+    return elapsed > 0 ? elapsed : 0;
+}
+
+static void walk(PassManager* pm, ASTNode** root, int in_list) {
+    int base = pm->depth;
+    push(pm, root, in_list);
+    while (pm->depth > base) {
+        Frame* f = &pm->stack[pm->depth - 1];
+        ASTNode* node = *f->slot;
+        int sampled = (pm->steps++ % PASS_SAMPLE_RATE) == 0;
+        double step = sampled ? now() : 0;
+        int reads = 1;
+
+        if (!f->entered) {
+            f->entered = 1;
+            for (int i = 0; i < pm->count; i++) {
+                Pass* p = &pm->passes[i].pass;
+                if (!p->enter) continue;
+                if (sampled) {
+                    double t = now();
+                    p->enter(node, p->state);
+                    pm->passes[i].sampled += since(pm, t, 1);
+                    reads += 2;
+                } else {
+                    p->enter(node, p->state);
+                }
+            }
+            push_children(pm, node);
+        } else {
+            // Filhos concluídos: leave em ordem, cada passe vendo o
+            // resultado do anterior.
+            pm->visits++;
+            ASTNode** slot = f->slot;
+            int list = f->in_list;
+            pm->depth--;
+            ASTNode* result = node;
+            for (int i = 0; i < pm->count && result; i++) {
+                Pass* p = &pm->passes[i].pass;
+                if (!p->leave) continue;
+                if (sampled) {
+                    double t = now();
+                    result = p->leave(result, p->state);
+                    pm->passes[i].sampled += since(pm, t, 1);
+                    reads += 2;
+                } else {
+                    result = p->leave(result, p->state);
+                }
+            }
+            if (result != node) {
+                if (list) {
+                    if (result) result->next = node->next;
+                    *slot = result ? result : node->next;
+                } else {
+                    *slot = result;
+                }
+            }
+            if (list) {
+                // Removido: o irmão seguinte passou a ocupar o mesmo slot.
+                push(pm, result ? &(*slot)->next : slot, 1);
+            }
+        }
+        if (sampled) pm->sampled_steps += since(pm, step, reads);
+    }
+}
+
+static void run(PassManager* pm, ASTNode** root, int in_list) {
+    double start = now();
+    for (int i = 0; i < pm->count; i++) {
+        Pass* p = &pm->passes[i].pass;
+        if (!p->begin) continue;
+        double t = now();
+        p->begin(p->state);
+        pm->passes[i].seconds += now() - t;
+    }
+
+    double walk_start = now();
+    walk(pm, root, in_list);
+    pm->walk_seconds += now() - walk_start;
+
+    for (int i = 0; i < pm->count; i++) {
+        Pass* p = &pm->passes[i].pass;
+        if (!p->end) continue;
+        double t = now();
+        p->end(p->state);
+        pm->passes[i].seconds += now() - t;
+    }
+    pm->total_seconds += now() - start;
+    pm->runs++;
+}
+
+void pass_manager_run(PassManager* pm, ASTProgram* program) {
+    ASTNode* root = (ASTNode*)program;
+    run(pm, &root, 0);
+}
+
+void pass_manager_run_list(PassManager* pm, ASTNode** head) {
+    run(pm, head, 1);
+}
+
+void pass_manager_run_node(PassManager* pm, ASTNode** node) {
+    run(pm, node, 0);
+}
+
+void pass_manager_report(const PassManager* pm, FILE* out) {
+    double in_passes = 0;
+    fprintf(out, "%-20s %12s\n", "passe", "segundos");
+    for (int i = 0; i < pm->count; i++) {
+        double share = pm->sampled_steps > 0 ? pm->passes[i].sampled / pm->sampled_steps : 0;
+        if (share > 1) share = 1;
+        double seconds = pm->passes[i].seconds + share * pm->walk_seconds;
+        fprintf(out, "%-20s %12.6f\n", pm->passes[i].pass.name, seconds);
+        in_passes += seconds;
+    }
+    double overhead = pm->total_seconds - in_passes;
+    fprintf(out, "%-20s %12.6f\n", "(travessia)", overhead > 0 ? overhead : 0);
+    fprintf(out, "%-20s %12.6f  (%d execuções, %ld nós)\n", "total",
+            pm->total_seconds, pm->runs, pm->visits);
+}
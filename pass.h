@@ -0,0 +1,46 @@
+#ifndef PASS_H
+#define PASS_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// Gerenciador de passes sobre a AST de ponteiros. Todos os passes
+// registrados rodam fundidos numa única travessia com pilha explícita (sem
+// recursão do C, nem ao longo de next): em cada nó, enter de cada passe é
+// chamado na ordem de registro antes dos filhos, e leave de cada passe
+// depois deles.
+//
+// leave pode devolver outro nó para ocupar o lugar do atual (o next do
+// original é preservado em listas) ou NULL para removê-lo; passes
+// seguintes veem já o resultado. Como os passes são fundidos, um passe só
+// enxerga o efeito de outro nos nós já visitados por completo.
+typedef struct {
+    const char* name;
+    void* state;
+    void (*begin)(void* state);
+    void (*enter)(ASTNode* node, void* state);
+    ASTNode* (*leave)(ASTNode* node, void* state);
+    void (*end)(void* state);
+} Pass;
+
+typedef struct PassManager PassManager;
+
+PassManager* pass_manager_new(void);
+void pass_manager_free(PassManager* pm);
+void pass_manager_add(PassManager* pm, const Pass* pass);
+int pass_manager_count(const PassManager* pm);
+
+// Roda todos os passes registrados numa travessia de program.
+void pass_manager_run(PassManager* pm, ASTProgram* program);
+
+// Igual, mas sobre uma lista ligada de nós (declarações de um pedaço, por
+// exemplo); *head é atualizado se o primeiro nó for trocado ou removido.
+void pass_manager_run_list(PassManager* pm, ASTNode** head);
+
+// Igual, sobre um único nó e seus descendentes (sem seguir next).
+void pass_manager_run_node(PassManager* pm, ASTNode** node);
+
+// Tempo por passe (acumulado entre execuções) e da travessia em si.
+void pass_manager_report(const PassManager* pm, FILE* out);
+
+#endif
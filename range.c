@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "range.h"
+
+static const Range FULL = { INT_MIN, INT_MAX };
+
+typedef struct {
+    const IRFunction* f;
+    Range* ranges;
+    unsigned char* known;   // já calculado ao menos uma vez
+    unsigned char* safe;
+    int* changes;           // mudanças de cada phi, para o alargamento
+    int* guard;             // por bloco: ele ou o dominador mais próximo cujo
+                            // único predecessor termina num branch, ou -1
+} Analysis;
+
+static void* xcalloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Failed to allocate RangeInfo");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+int range_is_arithmetic(const IRValue* v) {
+    if (v->op == IR_NEG || v->op == IR_ABS) return 1;
+    if (v->op != IR_BINARY || v->operand_type == TYPE_STRING) return 0;
+    switch (v->binop) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_STAR:
+        case TOKEN_SLASH:
+        case TOKEN_PERCENT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int64_t min64(int64_t a, int64_t b) {
+    return a < b ? a : b;
+}
+
+static int64_t max64(int64_t a, int64_t b) {
+    return a > b ? a : b;
+}
+
+// O intervalo, se couber num int; senão qualquer int e *safe = 0.
+static Range fit(int64_t lo, int64_t hi, int* safe) {
+    if (lo < INT_MIN || hi > INT_MAX) {
+        *safe = 0;
+        return FULL;
+    }
+    Range r = { (int)lo, (int)hi };
+    return r;
+}
+
+static Range span(int64_t lo, int64_t hi) {
+    Range r = { (int)max64(lo, INT_MIN), (int)min64(hi, INT_MAX) };
+    return r;
+}
+
+static Range binary(TokenType op, Range a, Range b, int* safe) {
+    *safe = 1;
+    switch (op) {
+        case TOKEN_PLUS:
+            return fit((int64_t)a.lo + b.lo, (int64_t)a.hi + b.hi, safe);
+        case TOKEN_MINUS:
+            return fit((int64_t)a.lo - b.hi, (int64_t)a.hi - b.lo, safe);
+        case TOKEN_STAR: {
+            int64_t p[4] = {
+                (int64_t)a.lo * b.lo, (int64_t)a.lo * b.hi,
+                (int64_t)a.hi * b.lo, (int64_t)a.hi * b.hi
+            };
+            int64_t lo = p[0], hi = p[0];
+            for (int i = 1; i < 4; i++) {
+                lo = min64(lo, p[i]);
+                hi = max64(hi, p[i]);
+            }
+            return fit(lo, hi, safe);
+        }
+        case TOKEN_SLASH:
+        case TOKEN_PERCENT: {
+            // Falha se o divisor pode ser zero; estoura com INT_MIN / -1.
+            if ((b.lo <= 0 && b.hi >= 0) || (a.lo == INT_MIN && b.lo <= -1 && b.hi >= -1)) *safe = 0;
+            int64_t ma = max64(-(int64_t)a.lo, a.hi);
+            int64_t mb = max64(-(int64_t)b.lo, b.hi) - 1;
+            if (op == TOKEN_SLASH) {
+                if (a.lo >= 0 && b.lo > 0) return span(a.lo / b.hi, a.hi / b.lo);
+                return span(-ma, ma);
+            }
+            // O resto tem o sinal do dividendo e é menor que o divisor.
+            if (mb < 0) mb = 0;
+            return span(a.lo >= 0 ? 0 : max64(a.lo, -mb), a.hi <= 0 ? 0 : min64(a.hi, mb));
+        }
+        default: {
+            // Comparação.
+            Range r = { 0, 1 };
+            return r;
+        }
+    }
+}
+
+static TokenType flip(TokenType op) {
+    switch (op) {
+        case TOKEN_LT: return TOKEN_GT;
+        case TOKEN_GT: return TOKEN_LT;
+        case TOKEN_LT_EQ: return TOKEN_GT_EQ;
+        case TOKEN_GT_EQ: return TOKEN_LT_EQ;
+        default: return op;
+    }
+}
+
+static TokenType negate(TokenType op) {
+    switch (op) {
+        case TOKEN_LT: return TOKEN_GT_EQ;
+        case TOKEN_GT: return TOKEN_LT_EQ;
+        case TOKEN_LT_EQ: return TOKEN_GT;
+        case TOKEN_GT_EQ: return TOKEN_LT;
+        case TOKEN_EQ_EQ: return TOKEN_BANG_EQ;
+        case TOKEN_BANG_EQ: return TOKEN_EQ_EQ;
+        default: return op;
+    }
+}
+
+// r restrito ao que satisfaz a comparação cond (ou a negação dela, se não
+// holds) em que x aparece de um lado.
+static Range constrain(const Analysis* a, Range r, int x, int cond, int holds) {
+    const IRValue* c = &a->f->values[cond];
+    if (c->op != IR_BINARY || c->operand_type == TYPE_STRING) return r;
+    TokenType op = c->binop;
+    int y;
+    if (c->args[0] == x) {
+        y = c->args[1];
+    } else if (c->args[1] == x) {
+        y = c->args[0];
+        op = flip(op);
+    } else {
+        return r;
+    }
+    if (y == x) return r;
+    if (!holds) op = negate(op);
+    Range o = a->known[y] ? a->ranges[y] : FULL;
+    int64_t lo = r.lo, hi = r.hi;
+    switch (op) {
+        case TOKEN_LT: hi = min64(hi, (int64_t)o.hi - 1); break;
+        case TOKEN_LT_EQ: hi = min64(hi, o.hi); break;
+        case TOKEN_GT: lo = max64(lo, (int64_t)o.lo + 1); break;
+        case TOKEN_GT_EQ: lo = max64(lo, o.lo); break;
+        case TOKEN_EQ_EQ:
+            lo = max64(lo, o.lo);
+            hi = min64(hi, o.hi);
+            break;
+        case TOKEN_BANG_EQ:
+            if (o.lo == o.hi) {
+                if (lo == o.lo) lo++;
+                if (hi == o.hi) hi--;
+            }
+            break;
+        default:
+            return r;
+    }
+    // Vazio: o caminho não acontece; fica o intervalo de antes.
+    if (lo > hi) return r;
+    Range refined = { (int)lo, (int)hi };
+    return refined;
+}
+
+static int guarded(const IRFunction* f, int b) {
+    const IRBlock* block = &f->blocks[b];
+    if (block->pred_count != 1) return 0;
+    const IRBlock* pred = &f->blocks[block->preds[0]];
+    return pred->term == IR_BRANCH && pred->succs[0] != pred->succs[1];
+}
+
+// guard de cada bloco alcançável, de cima para baixo na árvore de
+// dominadores (a pós-ordem reversa visita o dominador antes).
+static void find_guards(Analysis* a) {
+    const IRFunction* f = a->f;
+    for (int b = 0; b < f->block_count; b++) a->guard[b] = -1;
+    for (int i = 0; i < f->order_count; i++) {
+        int b = f->order[i];
+        if (guarded(f, b)) a->guard[b] = b;
+        else if (b != 0) a->guard[b] = a->guard[f->blocks[b].idom];
+    }
+}
+
+// Intervalo de x lido no bloco b: o do valor, restrito pelos branches cujo
+// lado leva necessariamente a b (os RANGE_GUARDS mais próximos).
+static Range operand(const Analysis* a, int x, int b) {
+    if (!a->known[x]) return FULL;
+    const IRFunction* f = a->f;
+    Range r = a->ranges[x];
+    b = a->guard[b];
+    for (int n = 0; b > 0 && n < RANGE_GUARDS; n++) {
+        const IRBlock* pred = &f->blocks[f->blocks[b].preds[0]];
+        r = constrain(a, r, x, pred->term_value, b == pred->succs[0]);
+        b = a->guard[f->blocks[b].idom];
+    }
+    return r;
+}
+
+static Range join(Range a, Range b) {
+    Range r = { a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi };
+    return r;
+}
+
+// Intervalo do valor a partir dos operandos; *known = 0 num phi cujos
+// operandos ainda não foram calculados.
+static Range transfer(Analysis* a, int id, int* known) {
+    const IRFunction* f = a->f;
+    const IRValue* v = &f->values[id];
+    *known = 1;
+    int safe = 0;
+    Range r = FULL;
+    switch (v->op) {
+        case IR_CONST:
+            r.lo = r.hi = v->imm;
+            break;
+        case IR_PHI: {
+            const IRBlock* block = &f->blocks[v->block];
+            *known = 0;
+            for (int i = 0; i < v->arg_count; i++) {
+                int x = v->args[i];
+                if (!a->known[x]) continue;
+                Range o = operand(a, x, block->preds[i]);
+                r = *known ? join(r, o) : o;
+                *known = 1;
+            }
+            break;
+        }
+        case IR_BINARY:
+            r = binary(v->binop, operand(a, v->args[0], v->block), operand(a, v->args[1], v->block), &safe);
+            if (v->operand_type == TYPE_STRING) safe = 0;
+            break;
+        case IR_NEG: {
+            Range o = operand(a, v->args[0], v->block);
+            safe = 1;
+            r = fit(-(int64_t)o.hi, -(int64_t)o.lo, &safe);
+            break;
+        }
+        case IR_ABS: {
+            Range o = operand(a, v->args[0], v->block);
+            safe = o.lo != INT_MIN;
+            if (!safe) break;
+            if (o.lo >= 0) r = o;
+            else if (o.hi <= 0) r = span(-(int64_t)o.hi, -(int64_t)o.lo);
+            else r = span(0, max64(-(int64_t)o.lo, o.hi));
+            break;
+        }
+        case IR_NOT:
+            r.lo = 0;
+            r.hi = 1;
+            break;
+        default:
+            break;
+    }
+    a->safe[id] = (unsigned char)(safe && range_is_arithmetic(v));
+    return r;
+}
+
+// Uma passada pelos valores alcançáveis; com accumulate, os phis só
+// crescem (e alargam). Devolve se algo mudou.
+static int sweep(Analysis* a, int accumulate) {
+    const IRFunction* f = a->f;
+    int changed = 0;
+    for (int i = 0; i < f->order_count; i++) {
+        const IRBlock* block = &f->blocks[f->order[i]];
+        for (int k = 0; k < block->phi_count + block->count; k++) {
+            int id = k < block->phi_count ? block->phis[k] : block->values[k - block->phi_count];
+            int known;
+            Range r = transfer(a, id, &known);
+            if (!known) continue;
+            Range old = a->ranges[id];
+            if (accumulate && a->known[id] && f->values[id].op == IR_PHI) {
+                r = join(old, r);
+                if (r.lo == old.lo && r.hi == old.hi) continue;
+                if (++a->changes[id] > RANGE_WIDEN_AFTER) {
+                    if (r.lo < old.lo) r.lo = INT_MIN;
+                    if (r.hi > old.hi) r.hi = INT_MAX;
+                }
+            }
+            if (!a->known[id] || r.lo != old.lo || r.hi != old.hi) changed = 1;
+            a->ranges[id] = r;
+            a->known[id] = 1;
+        }
+    }
+    return changed;
+}
+
+RangeInfo* range_analyze(const IRFunction* f) {
+    int n = f->value_count;
+    Analysis a;
+    a.f = f;
+    a.ranges = xcalloc(n, sizeof(Range));
+    a.known = xcalloc(n, 1);
+    a.safe = xcalloc(n, 1);
+    a.changes = xcalloc(n, sizeof(int));
+    a.guard = xcalloc(f->block_count, sizeof(int));
+    find_guards(&a);
+
+    while (sweep(&a, 1)) {
+    }
+    for (int i = 0; i < RANGE_NARROW_ROUNDS; i++) sweep(&a, 0);
+
+    RangeInfo* info = xcalloc(1, sizeof(RangeInfo));
+    info->ranges = a.ranges;
+    info->safe = a.safe;
+    info->count = n;
+    for (int id = 0; id < n; id++) {
+        if (!a.known[id]) info->ranges[id] = FULL;
+    }
+    free(a.known);
+    free(a.changes);
+    free(a.guard);
+    return info;
+}
+
+void range_free(RangeInfo* r) {
+    if (!r) return;
+    free(r->ranges);
+    free(r->safe);
+    free(r);
+}
@@ -0,0 +1,57 @@
+#ifndef RANGE_H
+#define RANGE_H
+
+#include "ir.h"
+
+// Análise de intervalos sobre a IR (ir.h): para cada valor, um intervalo
+// [lo, hi] que contém tudo o que ele pode valer em tempo de execução.
+//
+// Constantes dão o próprio valor, comparações e ! dão [0, 1]; parâmetros,
+// loads, chamadas e input valem qualquer int. A aritmética é calculada em
+// 64 bits: se o resultado cabe num int, a operação é marcada como segura
+// (não estoura nem falha); senão vale qualquer int, como o wrap do C
+// gerado. Divisão e resto são seguros quando o divisor não pode ser zero
+// nem -1 com o dividendo INT_MIN.
+//
+// Um valor lido num bloco que só é alcançado por um lado de um branch (o
+// bloco ou um dominador dele tem esse branch como único predecessor) é
+// restringido pela comparação do branch: dentro de while (i < n), i é no
+// máximo o maior n menos 1, e i + 1 não estoura. É isso que dá intervalos
+// às variáveis de indução dos laços. Cada bloco guarda o dominador mais
+// próximo com um branch assim, e só os RANGE_GUARDS mais próximos contam:
+// sem o limite, uma sequência de milhares de laços faria cada leitura
+// percorrer todos eles.
+//
+// Os phis começam vazios e crescem até um ponto fixo, percorrendo os
+// blocos em pós-ordem reversa; um phi que muda mais de RANGE_WIDEN_AFTER
+// vezes tem o limite que ainda cresce levado direto a INT_MIN ou INT_MAX.
+// Depois, RANGE_NARROW_ROUNDS passadas recalculam tudo sem acumular, o que
+// devolve aos phis o limite dado pela condição do laço.
+#define RANGE_WIDEN_AFTER 3
+#define RANGE_NARROW_ROUNDS 2
+#define RANGE_GUARDS 32
+
+typedef struct {
+    int lo;
+    int hi;
+} Range;
+
+typedef struct {
+    Range* ranges;          // por valor; qualquer int nos inalcançáveis
+    unsigned char* safe;    // 1 nas operações aritméticas que não estouram
+    int count;
+} RangeInfo;
+
+typedef struct {
+    int arithmetic;         // + - * / %, negação e abs gerados
+    int safe;               // dessas, as provadas seguras
+    int narrowed;           // variáveis guardadas em signed char ou short
+} RangeStats;
+
+RangeInfo* range_analyze(const IRFunction* f);
+void range_free(RangeInfo* r);
+
+// + - * / % sobre inteiros, negação e abs: as operações que podem estourar.
+int range_is_arithmetic(const IRValue* v);
+
+#endif
@@ -0,0 +1,360 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "resolve.h"
+
+// Ligação de um nome a um slot. shadowed é a ligação do mesmo nome que
+// esta esconde, restaurada quando o escopo fecha.
+typedef struct {
+    int name;
+    int slot;
+    int shadowed;
+} Binding;
+
+// owner é o nó que abriu o escopo. Escopos de função guardam também o
+// estado do frame de fora, restaurado no leave.
+typedef struct {
+    ASTNode* owner;
+    int bindings;
+    int next_slot;
+    int frame_size;
+    int frame_base;
+    int function;
+} Scope;
+
+typedef struct {
+    int name;
+    int arg_count;
+    int line;
+    int column;
+} PendingCall;
+
+struct Resolver {
+    const SymbolTable* names;
+
+    // Por id de nome: ligação visível e índice da função (-1 se nenhum).
+    int* visible;
+    int* function_of;
+    int name_capacity;
+
+    Binding* bindings;
+    int binding_count;
+    int binding_capacity;
+
+    Scope* scopes;
+    int scope_count;
+    int scope_capacity;
+
+    // Frame atual: ligações abaixo de frame_base são de outra função.
+    int frame_base;
+    int next_slot;
+    int frame_size;
+    int function;
+    int body_pending;
+
+    ResolvedFn* functions;
+    int function_count;
+    int function_capacity;
+
+    PendingCall* pending;
+    int pending_count;
+    int pending_capacity;
+
+    // Todas as funções do programa já foram declaradas (passe rodando
+    // sobre o AST_PROGRAM): chamadas desconhecidas são erro imediato.
+    int complete;
+    int errors;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size, const char* what) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror(what);
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static void error_at(Resolver* r, ASTNode* node, const char* fmt, const char* name, int a, int b) {
+    fprintf(stderr, "\n[Erro] Linha %d, Coluna %d: ", node->line, node->column);
+    fprintf(stderr, fmt, name, a, b);
+    fprintf(stderr, "\n");
+    r->errors++;
+}
+
+static const char* text(const Resolver* r, int name) {
+    return symtab_name(r->names, name);
+}
+
+// A tabela de nomes cresce durante o parse no modo streaming.
+static void reserve_name(Resolver* r, int name) {
+    int old = r->name_capacity;
+    if (name < old) return;
+    int capacity = old;
+    r->visible = grow(r->visible, &capacity, name + 1, sizeof(int), "Failed to grow Resolver");
+    capacity = old;
+    r->function_of = grow(r->function_of, &capacity, name + 1, sizeof(int), "Failed to grow Resolver");
+    for (int i = old; i < capacity; i++) {
+        r->visible[i] = -1;
+        r->function_of[i] = -1;
+    }
+    r->name_capacity = capacity;
+}
+
+Resolver* resolver_new(const SymbolTable* names) {
+    Resolver* r = calloc(1, sizeof(Resolver));
+    if (!r) {
+        perror("Failed to allocate Resolver");
+        exit(EXIT_FAILURE);
+    }
+    r->names = names;
+    r->function = -1;
+    reserve_name(r, symtab_count(names));
+    return r;
+}
+
+void resolver_free(Resolver* r) {
+    if (!r) return;
+    free(r->visible);
+    free(r->function_of);
+    free(r->bindings);
+    free(r->scopes);
+    free(r->functions);
+    free(r->pending);
+    free(r);
+}
+
+static void push_scope(Resolver* r, ASTNode* owner) {
+    r->scopes = grow(r->scopes, &r->scope_capacity, r->scope_count + 1, sizeof(Scope),
+                     "Failed to grow Resolver scopes");
+    Scope* s = &r->scopes[r->scope_count++];
+    s->owner = owner;
+    s->bindings = r->binding_count;
+    s->next_slot = r->next_slot;
+    s->frame_size = r->frame_size;
+    s->frame_base = r->frame_base;
+    s->function = r->function;
+}
+
+// Fecha o escopo do topo. Os slots dele voltam a ficar livres; o frame só
+// é restaurado quando o escopo é o de uma função.
+static void pop_scope(Resolver* r) {
+    Scope* s = &r->scopes[--r->scope_count];
+    while (r->binding_count > s->bindings) {
+        Binding* b = &r->bindings[--r->binding_count];
+        r->visible[b->name] = b->shadowed;
+    }
+    if (s->owner && s->owner->type == AST_FN_DECL) {
+        r->frame_size = s->frame_size;
+        r->frame_base = s->frame_base;
+        r->function = s->function;
+    }
+    r->next_slot = s->next_slot;
+}
+
+static int lookup(Resolver* r, int name) {
+    reserve_name(r, name);
+    int b = r->visible[name];
+    return b >= r->frame_base ? r->bindings[b].slot : -1;
+}
+
+static int bind(Resolver* r, ASTNode* node, int name, const char* duplicate) {
+    reserve_name(r, name);
+    int scope_start = r->scope_count ? r->scopes[r->scope_count - 1].bindings : 0;
+    if (r->visible[name] >= scope_start && r->visible[name] >= r->frame_base) {
+        error_at(r, node, duplicate, text(r, name), 0, 0);
+    }
+    r->bindings = grow(r->bindings, &r->binding_capacity, r->binding_count + 1, sizeof(Binding),
+                       "Failed to grow Resolver bindings");
+    Binding* b = &r->bindings[r->binding_count];
+    b->name = name;
+    b->slot = r->next_slot++;
+    b->shadowed = r->visible[name];
+    r->visible[name] = r->binding_count++;
+    if (r->next_slot > r->frame_size) r->frame_size = r->next_slot;
+    return b->slot;
+}
+
+// A mesma declaração pode chegar duas vezes: na pré-declaração do programa
+// e ao ser visitada. A posição distingue isso de uma redeclaração, mesmo
+// com a arena reaproveitada entre declarações; a redeclaração só é
+// reportada na primeira vez.
+static int declare_function(Resolver* r, ASTFnDecl* fn) {
+    ASTNode* node = (ASTNode*)fn;
+    reserve_name(r, fn->name);
+    int index = r->function_of[fn->name];
+    if (index >= 0) {
+        ResolvedFn* prev = &r->functions[index];
+        if (!r->complete && (prev->line != node->line || prev->column != node->column)) {
+            error_at(r, node, "Função '%s' já declarada na linha %d", text(r, fn->name), prev->line, 0);
+        }
+        return index;
+    }
+    r->functions = grow(r->functions, &r->function_capacity, r->function_count + 1, sizeof(ResolvedFn),
+                        "Failed to grow Resolver functions");
+    index = r->function_count++;
+    ResolvedFn* f = &r->functions[index];
+    f->name = fn->name;
+    f->arity = fn->param_count;
+    f->frame_size = 0;
+    f->line = node->line;
+    f->column = node->column;
+    r->function_of[fn->name] = index;
+    return index;
+}
+
+static int resolve_call(Resolver* r, ASTNode* node, int name, int arg_count) {
+    reserve_name(r, name);
+    int index = r->function_of[name];
+    if (index < 0) {
+        if (r->complete) {
+            error_at(r, node, "Função '%s' não declarada", text(r, name), 0, 0);
+        } else {
+            r->pending = grow(r->pending, &r->pending_capacity, r->pending_count + 1, sizeof(PendingCall),
+                              "Failed to grow Resolver calls");
+            PendingCall* c = &r->pending[r->pending_count++];
+            c->name = name;
+            c->arg_count = arg_count;
+            c->line = node->line;
+            c->column = node->column;
+        }
+        return -1;
+    }
+    if (r->functions[index].arity != arg_count) {
+        error_at(r, node, "Função '%s' espera %d argumento(s), recebeu %d", text(r, name),
+                 r->functions[index].arity, arg_count);
+    }
+    return index;
+}
+
+static void enter(ASTNode* node, void* state) {
+    Resolver* r = state;
+    switch (node->type) {
+        case AST_PROGRAM:
+            for (ASTNode* d = ((ASTProgram*)node)->declarations; d; d = d->next) {
+                if (d->type == AST_FN_DECL) declare_function(r, (ASTFnDecl*)d);
+            }
+            r->complete = 1;
+            break;
+        case AST_FN_DECL: {
+            ASTFnDecl* fn = (ASTFnDecl*)node;
+            fn->index = declare_function(r, fn);
+            push_scope(r, node);
+            r->function = fn->index;
+            r->frame_base = r->binding_count;
+            r->next_slot = 0;
+            r->frame_size = 0;
+            for (int i = 0; i < fn->param_count; i++) {
+                bind(r, node, fn->params[i], "Parâmetro '%s' repetido");
+            }
+            r->body_pending = 1;
+            break;
+        }
+        case AST_BLOCK:
+            // O corpo da função fica no escopo dos parâmetros, como em C.
+            if (r->body_pending) {
+                r->body_pending = 0;
+            } else {
+                push_scope(r, node);
+            }
+            break;
+        case AST_FOR_STMT:
+        case AST_INLINE_EXPR:
+            push_scope(r, node);
+            break;
+        case AST_IDENTIFIER: {
+            ASTIdentifier* id = (ASTIdentifier*)node;
+            id->slot = lookup(r, id->name);
+            if (id->slot < 0) error_at(r, node, "Variável '%s' não declarada", text(r, id->name), 0, 0);
+            break;
+        }
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* as = (ASTAssignStmt*)node;
+            as->slot = lookup(r, as->name);
+            if (as->slot < 0) error_at(r, node, "Variável '%s' não declarada", text(r, as->name), 0, 0);
+            break;
+        }
+        case AST_CALL_STMT:
+        case AST_CALL_EXPR: {
+            ASTCallStmt* call = (ASTCallStmt*)node;
+            call->fn_index = resolve_call(r, node, call->name, call->arg_count);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    Resolver* r = state;
+    switch (node->type) {
+        case AST_PROGRAM:
+            ((ASTProgram*)node)->frame_size = r->frame_size;
+            break;
+        case AST_VAR_DECL: {
+            // Ligado só agora: o inicializador ainda vê o nome de fora.
+            ASTVarDecl* var = (ASTVarDecl*)node;
+            var->slot = bind(r, node, var->name, "Variável '%s' já declarada neste escopo");
+            break;
+        }
+        case AST_FN_DECL: {
+            ASTFnDecl* fn = (ASTFnDecl*)node;
+            fn->frame_size = r->frame_size;
+            r->functions[fn->index].frame_size = r->frame_size;
+            r->body_pending = 0;
+            pop_scope(r);
+            break;
+        }
+        case AST_BLOCK:
+        case AST_FOR_STMT:
+        case AST_INLINE_EXPR:
+            if (r->scope_count && r->scopes[r->scope_count - 1].owner == node) pop_scope(r);
+            break;
+        default:
+            break;
+    }
+    return node;
+}
+
+Pass resolver_pass(Resolver* r) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "resolve";
+    pass.state = r;
+    pass.enter = enter;
+    pass.leave = leave;
+    return pass;
+}
+
+int resolver_finish(Resolver* r) {
+    for (int i = 0; i < r->pending_count; i++) {
+        PendingCall* c = &r->pending[i];
+        ASTNode at = { AST_CALL_EXPR, c->line, c->column, NULL };
+        int index = r->function_of[c->name];
+        if (index < 0) {
+            error_at(r, &at, "Função '%s' não declarada", text(r, c->name), 0, 0);
+        } else if (r->functions[index].arity != c->arg_count) {
+            error_at(r, &at, "Função '%s' espera %d argumento(s), recebeu %d", text(r, c->name),
+                     r->functions[index].arity, c->arg_count);
+        }
+    }
+    r->pending_count = 0;
+    return r->errors;
+}
+
+int resolver_function_count(const Resolver* r) {
+    return r->function_count;
+}
+
+const ResolvedFn* resolver_function(const Resolver* r, int index) {
+    return index >= 0 && index < r->function_count ? &r->functions[index] : NULL;
+}
+
+// Fora de qualquer função o frame atual é o do main.
+int resolver_main_frame_size(const Resolver* r) {
+    return r->frame_size;
+}
@@ -0,0 +1,52 @@
+#ifndef RESOLVE_H
+#define RESOLVE_H
+
+#include "ast.h"
+#include "pass.h"
+#include "symbol.h"
+
+// Análise semântica: liga cada identificador, atribuição e chamada à sua
+// declaração e anota a AST com o resultado.
+//
+// Escopos seguem o C gerado: cada bloco (e cada for ou corpo expandido por
+// inline.h) abre um escopo, o corpo de uma função divide o escopo com os
+// parâmetros e funções não enxergam as variáveis do nível superior, que são
+// locais do main. Um let só fica visível depois do seu inicializador.
+// Funções são globais e podem ser chamadas antes de declaradas.
+//
+// Anotações:
+//   ASTVarDecl, ASTIdentifier, ASTAssignStmt  slot no frame da função (ou
+//                                             do main); parâmetros ocupam
+//                                             os slots 0..n-1
+//   ASTCallStmt, ASTCallExpr                  fn_index
+//   ASTFnDecl                                 index, frame_size
+//   ASTProgram                                frame_size do main
+// Slots são densos e reaproveitados por escopos irmãos: frame_size é o
+// máximo de variáveis vivas ao mesmo tempo.
+typedef struct {
+    int name;
+    int arity;
+    int frame_size;
+    int line;
+    int column;
+} ResolvedFn;
+
+typedef struct Resolver Resolver;
+
+Resolver* resolver_new(const SymbolTable* names);
+void resolver_free(Resolver* r);
+
+// O resolvedor roda como passe (pass.h), sobre o programa inteiro ou uma
+// declaração de nível superior por vez (modos streaming e compacto). No
+// segundo caso, chamadas a funções ainda não vistas são conferidas só em
+// resolver_finish, e essas chamadas ficam sem fn_index.
+Pass resolver_pass(Resolver* r);
+
+// Confere as chamadas pendentes e devolve o total de erros reportados.
+int resolver_finish(Resolver* r);
+
+int resolver_function_count(const Resolver* r);
+const ResolvedFn* resolver_function(const Resolver* r, int index);
+int resolver_main_frame_size(const Resolver* r);
+
+#endif
@@ -0,0 +1,150 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include "source.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SOURCE_CHUNK 65536
+
+static SourceFile* new_source(const char* path) {
+    SourceFile* src = calloc(1, sizeof(SourceFile));
+    if (!src) {
+        perror("Failed to allocate SourceFile");
+        exit(EXIT_FAILURE);
+    }
+    src->name = strcmp(path, "-") == 0 ? "<stdin>" : path;
+    return src;
+}
+
+// Leitura em blocos até EOF; serve para pipes, stdin e qualquer arquivo
+// que não possa ser mapeado.
+static int read_stream(FILE* f, SourceFile* src) {
+    size_t capacity = SOURCE_CHUNK;
+    size_t length = 0;
+    char* buf = malloc(capacity);
+    if (!buf) return -1;
+
+    while (1) {
+        if (capacity - length < SOURCE_CHUNK / 2) {
+            capacity *= 2;
+            char* grown = realloc(buf, capacity);
+            if (!grown) {
+                free(buf);
+                return -1;
+            }
+            buf = grown;
+        }
+        size_t n = fread(buf + length, 1, capacity - length - 1, f);
+        length += n;
+        if (n == 0) break;
+    }
+    if (ferror(f)) {
+        free(buf);
+        return -1;
+    }
+    buf[length] = '\0';
+    src->data = buf;
+    src->length = length;
+    src->mapped = 0;
+    return 0;
+}
+
+#ifndef _WIN32
+// mmap só é usado quando o arquivo não termina exatamente numa fronteira de
+// página: o restante da última página vem zerado, o que garante o '\0'
+// depois do último byte sem copiar nada.
+static int map_file(int fd, const struct stat* st, SourceFile* src) {
+    long page = sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)st->st_size;
+    if (!S_ISREG(st->st_mode) || size == 0 || page <= 0 || size % (size_t)page == 0) {
+        return -1;
+    }
+    void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return -1;
+    posix_madvise(p, size, POSIX_MADV_SEQUENTIAL);
+    src->data = p;
+    src->length = size;
+    src->mapped = 1;
+    src->map_size = size;
+    return 0;
+}
+#endif
+
+SourceFile* source_open(const char* path) {
+    SourceFile* src = new_source(path);
+
+    if (strcmp(path, "-") == 0) {
+        if (read_stream(stdin, src) != 0) {
+            free(src);
+            return NULL;
+        }
+    } else {
+#ifndef _WIN32
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            free(src);
+            return NULL;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && map_file(fd, &st, src) == 0) {
+            close(fd);
+        } else {
+            FILE* f = fdopen(fd, "rb");
+            if (!f) {
+                close(fd);
+                free(src);
+                return NULL;
+            }
+            int rc = read_stream(f, src);
+            fclose(f);
+            if (rc != 0) {
+                free(src);
+                return NULL;
+            }
+        }
+#else
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            free(src);
+            return NULL;
+        }
+        int rc = read_stream(f, src);
+        fclose(f);
+        if (rc != 0) {
+            free(src);
+            return NULL;
+        }
+#endif
+    }
+
+    // O lexer indexa com int.
+    if (src->length >= INT_MAX) {
+        source_close(src);
+        errno = EFBIG;
+        return NULL;
+    }
+    return src;
+}
+
+void source_close(SourceFile* src) {
+    if (!src) return;
+#ifndef _WIN32
+    if (src->mapped) {
+        munmap((void*)src->data, src->map_size);
+    } else {
+        free((void*)src->data);
+    }
+#else
+    free((void*)src->data);
+#endif
+    free(src);
+}
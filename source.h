@@ -0,0 +1,22 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+
+// Código-fonte carregado para o lexer. data é sempre terminado em '\0' e
+// somente leitura: arquivos regulares são mapeados com mmap (sem cópia);
+// pipes e stdin ("-") são lidos em blocos para um buffer que cresce.
+typedef struct {
+    const char* data;
+    size_t length;
+    const char* name;
+    int mapped;
+    size_t map_size;
+} SourceFile;
+
+// NULL em caso de erro, com errno definido (EFBIG se o arquivo tem 2 GB ou
+// mais, o limite do lexer).
+SourceFile* source_open(const char* path);
+void source_close(SourceFile* src);
+
+#endif
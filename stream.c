@@ -0,0 +1,56 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include "stream.h"
+#include "codegen.h"
+
+static int append_section(FILE* section, FILE* out) {
+    char buf[65536];
+    size_t n;
+    rewind(section);
+    while ((n = fread(buf, 1, sizeof(buf), section)) > 0) {
+        if (fwrite(buf, 1, n, out) != n) return -1;
+    }
+    return ferror(section) ? -1 : 0;
+}
+
+// Os protótipos vêm primeiro no arquivo final e vão direto para out; as
+// definições de funções e o corpo do main vão para arquivos temporários que
+// são concatenados no fim.
+int compile_streaming(Parser* p, PassManager* passes, FILE* out) {
+    FILE* functions = tmpfile();
+    FILE* main_body = tmpfile();
+    if (!functions || !main_body) {
+        perror("tmpfile");
+        if (functions) fclose(functions);
+        if (main_body) fclose(main_body);
+        return -1;
+    }
+
+    const SymbolTable* names = parser_symbols(p);
+    codegen_emit_header(out);
+    while (parser_peek(p, 0).type != TOKEN_EOF) {
+        ASTNode* stmt = parse_statement(p);
+        if (stmt && passes) pass_manager_run_list(passes, &stmt);
+        if (!stmt) continue;
+        if (stmt->type == AST_FN_DECL) {
+            codegen_emit_prototype(stmt, names, out);
+            codegen_emit_function(stmt, names, functions);
+        } else {
+            codegen_emit_main_statement(stmt, names, main_body);
+        }
+        // Nada da declaração sobrevive à geração: a arena volta ao início.
+        arena_reset(parser_arena(p));
+    }
+    fprintf(out, "\n");
+
+    int rc = append_section(functions, out);
+    if (rc == 0) {
+        codegen_emit_main_begin(out);
+        rc = append_section(main_body, out);
+        codegen_emit_main_end(out);
+    }
+    fclose(functions);
+    fclose(main_body);
+    return rc;
+}
@@ -0,0 +1,15 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include "parser_v2.h"
+#include "pass.h"
+
+// Compilação em passada única: cada declaração de nível superior é gerada
+// assim que é parseada e a arena do parser é reiniciada em seguida, então a
+// memória de pico não cresce com o tamanho do programa. passes (opcional)
+// roda sobre cada declaração antes da geração; os nós que eles criam devem
+// vir da mesma arena. Devolve 0 em sucesso.
+int compile_streaming(Parser* p, PassManager* passes, FILE* out);
+
+#endif
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "symbol.h"
+
+#define SYMTAB_POOL_CHUNK 65536
+#define SYMTAB_INITIAL_SLOTS 256
+
+typedef struct PoolChunk {
+    struct PoolChunk* next;
+    size_t used;
+    size_t size;
+    char data[];
+} PoolChunk;
+
+typedef struct {
+    const char* name;
+    int length;
+    uint32_t hash;
+} SymbolEntry;
+
+// O hash fica também no slot para que colisões não toquem em entries.
+typedef struct {
+    uint32_t hash;
+    int id;              // id + 1, 0 = vazio
+} SymbolSlot;
+
+struct SymbolTable {
+    SymbolEntry* entries;
+    int count;
+    int capacity;
+    SymbolSlot* slots;   // endereçamento aberto com sondagem linear
+    int slot_count;      // sempre potência de 2
+    PoolChunk* pool;
+};
+
+static void* xmalloc(size_t size) {
+    void* p = malloc(size);
+    if (!p) {
+        perror("Failed to allocate SymbolTable");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Mistura 8 bytes por vez; nomes curtos custam uma ou duas multiplicações.
+static uint32_t hash_bytes(const char* s, int n) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (uint64_t)n;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, s + i, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    if (i < n) {
+        uint64_t w = 0;
+        memcpy(&w, s + i, n - i);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    h *= 0xC4CEB9FE1A85EC53ull;
+    return (uint32_t)(h >> 32);
+}
+
+static const char* pool_copy(SymbolTable* st, const char* s, int n) {
+    size_t need = (size_t)n + 1;
+    if (!st->pool || st->pool->size - st->pool->used < need) {
+        size_t size = need > SYMTAB_POOL_CHUNK ? need : SYMTAB_POOL_CHUNK;
+        PoolChunk* c = xmalloc(sizeof(PoolChunk) + size);
+        c->next = st->pool;
+        c->used = 0;
+        c->size = size;
+        st->pool = c;
+    }
+    char* dst = st->pool->data + st->pool->used;
+    memcpy(dst, s, n);
+    dst[n] = '\0';
+    st->pool->used += need;
+    return dst;
+}
+
+static void rehash(SymbolTable* st, int slot_count) {
+    free(st->slots);
+    st->slots = xmalloc(sizeof(SymbolSlot) * slot_count);
+    memset(st->slots, 0, sizeof(SymbolSlot) * slot_count);
+    st->slot_count = slot_count;
+    for (int id = 0; id < st->count; id++) {
+        uint32_t h = st->entries[id].hash;
+        uint32_t i = h & (slot_count - 1);
+        while (st->slots[i].id) i = (i + 1) & (slot_count - 1);
+        st->slots[i].hash = h;
+        st->slots[i].id = id + 1;
+    }
+}
+
+SymbolTable* symtab_new(void) {
+    SymbolTable* st = xmalloc(sizeof(SymbolTable));
+    st->count = 0;
+    st->capacity = 64;
+    st->entries = xmalloc(sizeof(SymbolEntry) * st->capacity);
+    st->slots = NULL;
+    st->pool = NULL;
+    rehash(st, SYMTAB_INITIAL_SLOTS);
+    return st;
+}
+
+void symtab_free(SymbolTable* st) {
+    if (!st) return;
+    PoolChunk* c = st->pool;
+    while (c) {
+        PoolChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    free(st->entries);
+    free(st->slots);
+    free(st);
+}
+
+int symtab_intern(SymbolTable* st, const char* text, int length) {
+    uint32_t h = hash_bytes(text, length);
+    uint32_t mask = st->slot_count - 1;
+    uint32_t i = h & mask;
+    while (st->slots[i].id) {
+        if (st->slots[i].hash == h) {
+            SymbolEntry* e = &st->entries[st->slots[i].id - 1];
+            if (e->length == length && memcmp(e->name, text, length) == 0) {
+                return st->slots[i].id - 1;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    if (st->count == st->capacity) {
+        st->capacity *= 2;
+        st->entries = realloc(st->entries, sizeof(SymbolEntry) * st->capacity);
+        if (!st->entries) {
+            perror("Failed to grow SymbolTable");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int id = st->count++;
+    st->entries[id].name = pool_copy(st, text, length);
+    st->entries[id].length = length;
+    st->entries[id].hash = h;
+
+    // Fator de carga máximo de 1/2
+    if (st->count * 2 > st->slot_count) {
+        rehash(st, st->slot_count * 2);
+    } else {
+        st->slots[i].hash = h;
+        st->slots[i].id = id + 1;
+    }
+    return id;
+}
+
+// O nome base vai truncado: o que importa é o sufixo ser novo.
+int symtab_fresh(SymbolTable* st, int base, int* counter) {
+    char text[256];
+    for (;;) {
+        int length = snprintf(text, sizeof(text), "%.200s__%d", st->entries[base].name, ++*counter);
+        int before = st->count;
+        int id = symtab_intern(st, text, length);
+        if (st->count > before) return id;
+    }
+}
+
+const char* symtab_name(const SymbolTable* st, int id) {
+    if (id < 0 || id >= st->count) return NULL;
+    return st->entries[id].name;
+}
+
+int symtab_length(const SymbolTable* st, int id) {
+    if (id < 0 || id >= st->count) return 0;
+    return st->entries[id].length;
+}
+
+int symtab_count(const SymbolTable* st) {
+    return st->count;
+}
+
+// Memória total da tabela: entries, slots e o pool de nomes.
+size_t symtab_bytes(const SymbolTable* st) {
+    size_t bytes = sizeof(SymbolTable) + sizeof(SymbolEntry) * st->capacity +
+                   sizeof(SymbolSlot) * st->slot_count;
+    for (const PoolChunk* c = st->pool; c; c = c->next) {
+        bytes += sizeof(PoolChunk) + c->size;
+    }
+    return bytes;
+}
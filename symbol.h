@@ -0,0 +1,23 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <stddef.h>
+
+// Tabela de símbolos internados: cada nome distinto recebe um id estável.
+// Os nomes são copiados uma única vez para um pool interno (um por nome
+// distinto, nunca por token), então symtab_name() é válido enquanto a
+// tabela existir.
+typedef struct SymbolTable SymbolTable;
+
+SymbolTable* symtab_new(void);
+void symtab_free(SymbolTable* st);
+int symtab_intern(SymbolTable* st, const char* text, int length);
+// Interna um nome que ainda não existe na tabela, base__N, com N a partir
+// de *counter + 1. Para variáveis criadas pelos passes de otimização.
+int symtab_fresh(SymbolTable* st, int base, int* counter);
+const char* symtab_name(const SymbolTable* st, int id);
+int symtab_length(const SymbolTable* st, int id);
+int symtab_count(const SymbolTable* st);
+size_t symtab_bytes(const SymbolTable* st);
+
+#endif
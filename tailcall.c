@@ -0,0 +1,456 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tailcall.h"
+
+// Forma de um return em relação à função que o contém.
+typedef enum {
+    RETURN_PLAIN,       // não é chamada de cauda
+    RETURN_TAIL,        // return f(args)
+    RETURN_ACC          // return x * f(args) ou x + f(args)
+} ReturnKind;
+
+typedef struct {
+    ReturnKind kind;
+    ASTCallExpr* call;
+    ASTNode* operand;   // x, em RETURN_ACC
+    TokenType op;
+} Shape;
+
+// Função candidata e seus returns, em returns[first .. first + count).
+typedef struct {
+    ASTFnDecl* fn;
+    int first;
+    int count;
+} Pending;
+
+struct TailCalls {
+    SymbolTable* names;
+    Arena* arena;
+
+    // Função sendo percorrida (ou transformada, no end) e os returns do
+    // corpo dela.
+    ASTFnDecl* fn;
+    ASTReturnStmt** returns;
+    int return_count;
+    int first_return;
+    int return_capacity;
+    // Um let no corpo usa o nome de um parâmetro: a reatribuição iria
+    // para a variável errada.
+    int shadowed;
+
+    // Funções vistas nesta execução, transformadas no end.
+    Pending* pending;
+    int pending_count;
+    int pending_capacity;
+
+    // Modo acumulador da função atual: operador e nome do acumulador.
+    TokenType acc_op;
+    int acc_name;
+    int acc_slot;
+
+    // Percorre expressões atrás de chamadas à função atual, efeitos e
+    // leituras de parâmetros (used[i]).
+    PassManager* scanner;
+    int self_calls;
+    int impure;
+    unsigned char* used;
+    unsigned char* assigned;
+    ASTNode** values;
+    int param_capacity;
+
+    int next_suffix;
+    TailCallStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow TailCalls");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+static int param_index(const ASTFnDecl* fn, int name) {
+    for (int i = 0; i < fn->param_count; i++) {
+        if (fn->params[i] == name) return i;
+    }
+    return -1;
+}
+
+static void scan_enter(ASTNode* node, void* state) {
+    TailCalls* t = state;
+    switch (node->type) {
+        case AST_CALL_EXPR:
+        case AST_CALL_STMT:
+            t->impure = 1;
+            if (((ASTCallExpr*)node)->name == t->fn->name) t->self_calls = 1;
+            break;
+        case AST_INPUT_EXPR:
+        case AST_EXIT_STMT:
+            t->impure = 1;
+            break;
+        case AST_BINARY_EXPR: {
+            TokenType op = ((ASTBinaryExpr*)node)->operator;
+            if (op == TOKEN_SLASH || op == TOKEN_PERCENT) t->impure = 1;
+            break;
+        }
+        case AST_IDENTIFIER: {
+            int i = param_index(t->fn, ((ASTIdentifier*)node)->name);
+            if (i >= 0) t->used[i] = 1;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void scan(TailCalls* t, ASTNode* node) {
+    t->self_calls = 0;
+    t->impure = 0;
+    memset(t->used, 0, (size_t)t->fn->param_count);
+    pass_manager_run_node(t->scanner, &node);
+}
+
+TailCalls* tail_calls_new(SymbolTable* names, Arena* arena) {
+    TailCalls* t = calloc(1, sizeof(TailCalls));
+    if (!t) {
+        perror("Failed to allocate TailCalls");
+        exit(EXIT_FAILURE);
+    }
+    t->names = names;
+    t->arena = arena;
+    t->scanner = pass_manager_new();
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "tailcall/scan";
+    pass.state = t;
+    pass.enter = scan_enter;
+    pass_manager_add(t->scanner, &pass);
+    return t;
+}
+
+void tail_calls_free(TailCalls* t) {
+    if (!t) return;
+    free(t->returns);
+    free(t->pending);
+    free(t->used);
+    free(t->assigned);
+    free(t->values);
+    pass_manager_free(t->scanner);
+    free(t);
+}
+
+const TailCallStats* tail_calls_stats(const TailCalls* t) {
+    return &t->stats;
+}
+
+static ASTNode* strip(ASTNode* node) {
+    while (node && node->type == AST_GROUPING_EXPR) node = ((ASTGroupingExpr*)node)->expression;
+    return node;
+}
+
+static ASTCallExpr* self_call(const TailCalls* t, ASTNode* node) {
+    node = strip(node);
+    if (!node || node->type != AST_CALL_EXPR) return NULL;
+    ASTCallExpr* call = (ASTCallExpr*)node;
+    if (call->name != t->fn->name || call->arg_count != t->fn->param_count) return NULL;
+    return call;
+}
+
+static Shape classify(TailCalls* t, const ASTReturnStmt* ret) {
+    Shape s = { RETURN_PLAIN, NULL, NULL, TOKEN_EOF };
+    ASTNode* e = strip(ret->expression);
+    if (!e) return s;
+    if ((s.call = self_call(t, e))) {
+        s.kind = RETURN_TAIL;
+        return s;
+    }
+    if (e->type != AST_BINARY_EXPR) return s;
+    ASTBinaryExpr* bin = (ASTBinaryExpr*)e;
+    if (bin->operator != TOKEN_STAR && bin->operator != TOKEN_PLUS) return s;
+    ASTCallExpr* call = self_call(t, bin->right);
+    ASTNode* operand = bin->left;
+    if (!call) {
+        call = self_call(t, bin->left);
+        operand = bin->right;
+    }
+    if (!call) return s;
+    scan(t, operand);
+    if (t->self_calls || t->impure) return s;
+    s.kind = RETURN_ACC;
+    s.call = call;
+    s.operand = operand;
+    s.op = bin->operator;
+    return s;
+}
+
+// Nenhum caminho pelo comando chega ao fim dele.
+static int terminates(const ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case AST_RETURN_STMT:
+            return 1;
+        case AST_BLOCK:
+            for (const ASTNode* stmt = ((const ASTBlock*)node)->statements; stmt; stmt = stmt->next) {
+                if (terminates(stmt)) return 1;
+            }
+            return 0;
+        case AST_IF_STMT: {
+            const ASTIfStmt* n = (const ASTIfStmt*)node;
+            return terminates(n->then_branch) && terminates(n->else_branch);
+        }
+        case AST_WHILE_STMT: {
+            const ASTNode* cond = ((const ASTWhileStmt*)node)->condition;
+            return cond->type == AST_BOOL_LITERAL && ((const ASTBoolLiteral*)cond)->value;
+        }
+        case AST_FOR_STMT: {
+            const ASTNode* cond = ((const ASTForStmt*)node)->condition;
+            return cond && cond->type == AST_BOOL_LITERAL && ((const ASTBoolLiteral*)cond)->value;
+        }
+        default:
+            return 0;
+    }
+}
+
+static ASTNode* identifier(TailCalls* t, int name, int slot, const ASTNode* at) {
+    ASTIdentifier* id = ast_new_identifier(t->arena, name, at->line, at->column);
+    id->slot = slot;
+    return (ASTNode*)id;
+}
+
+static ASTNode* assign(TailCalls* t, int name, int slot, ASTNode* value, const ASTNode* at) {
+    ASTAssignStmt* as = ast_new_assign_stmt(t->arena, name, value, TOKEN_EQUALS, at->line, at->column);
+    as->slot = slot;
+    return (ASTNode*)as;
+}
+
+static void append(ASTNode** head, ASTNode** tail, ASTNode* node) {
+    if (*tail) (*tail)->next = node; else *head = node;
+    *tail = node;
+}
+
+// acc op (e)
+static ASTNode* accumulate(TailCalls* t, ASTNode* e, const ASTNode* at) {
+    ASTNode* group = (ASTNode*)ast_new_grouping_expr(t->arena, e, at->line, at->column);
+    ASTNode* acc = identifier(t, t->acc_name, t->acc_slot, at);
+    return (ASTNode*)ast_new_binary_expr(t->arena, acc, t->acc_op, group, at->line, at->column);
+}
+
+// O return vira, no lugar, um bloco que atualiza o acumulador e os
+// parâmetros; o laço em volta do corpo faz o resto. Um argumento que lê um
+// parâmetro já reatribuído é calculado antes, num let; se algum argumento
+// tem efeitos, todos passam por lets, para rodarem da esquerda para a
+// direita como na expansão de funções (inline.h).
+static void convert(TailCalls* t, ASTNode* node, const Shape* s) {
+    ASTFnDecl* fn = t->fn;
+    ASTCallExpr* call = s->call;
+    ASTNode* head = NULL;
+    ASTNode* tail = NULL;
+    if (s->kind == RETURN_ACC) {
+        append(&head, &tail, assign(t, t->acc_name, t->acc_slot, accumulate(t, s->operand, node), node));
+    }
+    int ordered = 0;
+    for (int i = 0; i < fn->param_count; i++) {
+        ASTNode* arg = strip(call->args[i]);
+        t->assigned[i] = !(arg->type == AST_IDENTIFIER && ((ASTIdentifier*)arg)->name == fn->params[i]);
+        if (!t->assigned[i]) continue;
+        scan(t, arg);
+        ordered |= t->impure;
+    }
+    ASTNode** values = t->values;
+    for (int i = 0; i < fn->param_count; i++) {
+        values[i] = call->args[i];
+        if (!t->assigned[i]) continue;
+        scan(t, call->args[i]);
+        int stale = ordered;
+        for (int j = 0; j < i && !stale; j++) stale = t->assigned[j] && t->used[j];
+        if (!stale) continue;
+        int name = symtab_fresh(t->names, fn->params[i], &t->next_suffix);
+        ASTVarDecl* let = ast_new_var_decl(t->arena, name, call->args[i], node->line, node->column);
+        let->slot = fn->frame_size++;
+        let->value_type = fn->param_types ? fn->param_types[i] : TYPE_INT;
+        append(&head, &tail, (ASTNode*)let);
+        values[i] = identifier(t, name, let->slot, node);
+    }
+    for (int i = 0; i < fn->param_count; i++) {
+        if (t->assigned[i]) append(&head, &tail, assign(t, fn->params[i], i, values[i], node));
+    }
+    node->type = AST_BLOCK;
+    ((ASTBlock*)node)->statements = head;
+    t->stats.sites++;
+}
+
+static int lower_list(TailCalls* t, ASTNode** head);
+
+// Desce pela última posição do comando: blocos e ramos de if.
+static int lower_last(TailCalls* t, ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case AST_RETURN_STMT: {
+            Shape s = classify(t, (ASTReturnStmt*)node);
+            if (s.kind == RETURN_PLAIN || (s.kind == RETURN_ACC && s.op != t->acc_op)) return 0;
+            convert(t, node, &s);
+            return 1;
+        }
+        case AST_BLOCK:
+            return lower_list(t, &((ASTBlock*)node)->statements);
+        case AST_IF_STMT: {
+            ASTIfStmt* n = (ASTIfStmt*)node;
+            int sites = lower_last(t, n->then_branch);
+            return sites + lower_last(t, n->else_branch);
+        }
+        default:
+            return 0;
+    }
+}
+
+static int lower_list(TailCalls* t, ASTNode** head) {
+    for (ASTNode* stmt = *head; stmt; stmt = stmt->next) {
+        // O que vem depois de um comando que não termina é código morto, e
+        // deixaria de ser quando o return virar reatribuição.
+        if (terminates(stmt)) stmt->next = NULL;
+        if (!stmt->next) return lower_last(t, stmt);
+        if (stmt->type != AST_IF_STMT) continue;
+
+        // if com um só ramo que termina: o resto da lista só roda depois do
+        // outro ramo, então vai para dentro dele e o if passa a ser o último.
+        ASTIfStmt* n = (ASTIfStmt*)stmt;
+        int then_ends = terminates(n->then_branch);
+        if (then_ends == terminates(n->else_branch)) continue;
+        ASTNode** other = then_ends ? &n->else_branch : &n->then_branch;
+        ASTNode* rest = stmt->next;
+        stmt->next = NULL;
+        if (*other) (*other)->next = rest;
+        *other = (ASTNode*)ast_new_block(t->arena, *other ? *other : rest, rest->line, rest->column);
+        return lower_last(t, stmt);
+    }
+    return 0;
+}
+
+static void lower(TailCalls* t, ASTFnDecl* fn) {
+    ASTBlock* body = (ASTBlock*)fn->body;
+    if (t->shadowed || !body || body->base.type != AST_BLOCK || !terminates((ASTNode*)body)) return;
+
+    // Acumulador só quando todos os x * f(args) e x + f(args) usam o mesmo
+    // operador; os returns fora da posição de cauda continuam valendo.
+    int tails = 0, products = 0, sums = 0;
+    ASTReturnStmt** returns = t->returns + t->first_return;
+    for (int i = 0; i < t->return_count; i++) {
+        Shape s = classify(t, returns[i]);
+        if (s.kind == RETURN_TAIL) tails++;
+        else if (s.kind == RETURN_ACC && s.op == TOKEN_STAR) products++;
+        else if (s.kind == RETURN_ACC) sums++;
+    }
+    if (tails + products + sums == 0) return;
+    t->acc_op = products && !sums ? TOKEN_STAR : sums && !products ? TOKEN_PLUS : TOKEN_EOF;
+    if (t->acc_op != TOKEN_EOF) {
+        t->acc_name = symtab_fresh(t->names, symtab_intern(t->names, "acc", 3), &t->next_suffix);
+        t->acc_slot = fn->frame_size++;
+    }
+
+    if (lower_list(t, &body->statements) == 0) {
+        if (t->acc_op != TOKEN_EOF) fn->frame_size--;
+        return;
+    }
+
+    const ASTNode* at = (const ASTNode*)body;
+    ASTNode* loop_body = (ASTNode*)ast_new_block(t->arena, body->statements, at->line, at->column);
+    ASTNode* truth = (ASTNode*)ast_new_bool_literal(t->arena, 1, at->line, at->column);
+    ASTNode* loop = (ASTNode*)ast_new_while_stmt(t->arena, truth, loop_body, at->line, at->column);
+    body->statements = loop;
+    if (t->acc_op != TOKEN_EOF) {
+        // Os returns que sobraram entregam o que já foi acumulado.
+        for (int i = 0; i < t->return_count; i++) {
+            ASTReturnStmt* ret = returns[i];
+            if (ret->base.type == AST_RETURN_STMT) ret->expression = accumulate(t, ret->expression, (ASTNode*)ret);
+        }
+        ASTNode* identity = (ASTNode*)ast_new_int_literal(t->arena, t->acc_op == TOKEN_STAR ? 1 : 0,
+                                                          at->line, at->column);
+        ASTVarDecl* acc = ast_new_var_decl(t->arena, t->acc_name, identity, at->line, at->column);
+        acc->slot = t->acc_slot;
+        acc->base.next = loop;
+        body->statements = (ASTNode*)acc;
+        t->stats.accumulators++;
+    }
+    t->stats.functions++;
+}
+
+static void reserve_params(TailCalls* t, int count) {
+    int capacity = t->param_capacity;
+    t->used = grow(t->used, &capacity, count, 1);
+    capacity = t->param_capacity;
+    t->assigned = grow(t->assigned, &capacity, count, 1);
+    capacity = t->param_capacity;
+    t->values = grow(t->values, &capacity, count, sizeof(ASTNode*));
+    t->param_capacity = capacity;
+}
+
+static void enter(ASTNode* node, void* state) {
+    TailCalls* t = state;
+    if (node->type != AST_FN_DECL) return;
+    t->fn = (ASTFnDecl*)node;
+    t->first_return = t->return_count;
+    t->shadowed = 0;
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    TailCalls* t = state;
+    if (!t->fn) return node;
+    switch (node->type) {
+        case AST_RETURN_STMT:
+            t->returns = grow(t->returns, &t->return_capacity, t->return_count + 1, sizeof(ASTReturnStmt*));
+            t->returns[t->return_count++] = (ASTReturnStmt*)node;
+            break;
+        case AST_VAR_DECL:
+            if (param_index(t->fn, ((ASTVarDecl*)node)->name) >= 0) t->shadowed = 1;
+            break;
+        case AST_FN_DECL:
+            if (!t->shadowed) {
+                t->pending = grow(t->pending, &t->pending_capacity, t->pending_count + 1, sizeof(Pending));
+                Pending* p = &t->pending[t->pending_count++];
+                p->fn = t->fn;
+                p->first = t->first_return;
+                p->count = t->return_count - t->first_return;
+            }
+            t->fn = NULL;
+            break;
+        default:
+            break;
+    }
+    return node;
+}
+
+// A transformação espera o end para que os lets novos saiam com os tipos
+// dos parâmetros (types.h), fixados no end do typer, registrado antes.
+static void end(void* state) {
+    TailCalls* t = state;
+    for (int i = 0; i < t->pending_count; i++) {
+        Pending* p = &t->pending[i];
+        if (p->fn->base.type != AST_FN_DECL) continue;
+        t->fn = p->fn;
+        t->first_return = p->first;
+        t->return_count = p->count;
+        reserve_params(t, p->fn->param_count);
+        lower(t, p->fn);
+    }
+    t->fn = NULL;
+    t->pending_count = 0;
+    t->return_count = 0;
+}
+
+Pass tail_calls_pass(TailCalls* t) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "tailcall";
+    pass.state = t;
+    pass.enter = enter;
+    pass.leave = leave;
+    pass.end = end;
+    return pass;
+}
@@ -0,0 +1,43 @@
+#ifndef TAILCALL_H
+#define TAILCALL_H
+
+#include "ast.h"
+#include "arena.h"
+#include "pass.h"
+#include "symbol.h"
+
+// Eliminação de chamadas de cauda em funções recursivas.
+//
+// Um `return f(args);` dentro da própria f, em posição de cauda, vira a
+// reatribuição dos parâmetros, e o corpo passa a rodar dentro de um
+// while (true): a recursão usa pilha constante em qualquer nível de
+// otimização do gcc. Posição de cauda é o fim do corpo, seguindo blocos e
+// ramos de if (não laços); o que vem depois de um if cujo outro ramo
+// termina é movido para dentro do ramo que continua. Só se aplica quando
+// nenhum caminho do corpo chega ao fim sem return, nem um let esconde um
+// parâmetro.
+//
+// Com `return x * f(args);` ou `return x + f(args);` (x sem efeitos e sem
+// chamar f) a função ganha um acumulador: cada chamada dessas vira
+// acc = acc * (x) seguida da reatribuição, e todo outro return devolve
+// acc * (e). Isso vale para a aritmética com volta do int de 32 bits, em
+// que * e + são associativos e comutativos.
+//
+// Os returns são coletados no percurso e as funções transformadas no end,
+// depois da dobra, da eliminação de código morto e da inferência de
+// tipos; funciona em todos os modos. Nós novos saem anotados com slots e
+// tipos, como os do resolvedor e de types.h.
+typedef struct {
+    int functions;      // funções transformadas em laço
+    int sites;          // chamadas de cauda eliminadas
+    int accumulators;   // funções que ganharam acumulador
+} TailCallStats;
+
+typedef struct TailCalls TailCalls;
+
+TailCalls* tail_calls_new(SymbolTable* names, Arena* arena);
+void tail_calls_free(TailCalls* t);
+Pass tail_calls_pass(TailCalls* t);
+const TailCallStats* tail_calls_stats(const TailCalls* t);
+
+#endif
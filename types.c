@@ -0,0 +1,560 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+
+// Termos: abaixo de TERM_VAR são um ValueType fixo; a partir dele, a
+// variável de tipo term - TERM_VAR da execução atual. TERM_OPEN é o
+// retorno de uma função que ainda ninguém usou; TERM_DEFAULT, um parâmetro
+// ou retorno que nada restringiu e foi fixado como int no end.
+#define TERM_OPEN (-1)
+#define TERM_DEFAULT (-2)
+#define TERM_VAR 3
+
+// Nó a anotar no end e o termo do tipo dele (em ASTFnDecl, o índice da
+// assinatura).
+typedef struct {
+    ASTNode* node;
+    int term;
+} Site;
+
+// Tipos dos parâmetros ficam em terms[params .. params + param_count).
+typedef struct {
+    int params;
+    int param_count;
+    int result;
+    int stamp;          // última execução que mexeu na assinatura
+} Signature;
+
+struct Typer {
+    Arena* arena;
+
+    // Variáveis de tipo da execução atual (union-find). bound é 0 se a
+    // variável está livre, senão o ValueType + 1 da classe (na raiz).
+    int* parent;
+    unsigned char* bound;
+    int var_count;
+    int var_capacity;
+
+    // Tipos das expressões já visitadas e ainda não consumidas pelo pai.
+    int* stack;
+    int stack_count;
+    int stack_capacity;
+
+    // Termo de cada slot do frame atual. O do main sobrevive entre
+    // execuções, com os tipos já fixados.
+    int* main_slots;
+    int main_capacity;
+    int* fn_slots;
+    int fn_capacity;
+    int function;       // assinatura da função atual, -1 no main
+
+    // Assinaturas por id de nome (-1 se nenhuma).
+    int* signature_of;
+    int name_capacity;
+    Signature* signatures;
+    int signature_count;
+    int signature_capacity;
+    int* terms;
+    int term_count;
+    int term_capacity;
+
+    // O que a execução atual tocou e precisa ser fixado no end.
+    Site* sites;
+    int site_count;
+    int site_capacity;
+    int* touched;
+    int touched_count;
+    int touched_capacity;
+    int* main_touched;
+    int main_touched_count;
+    int main_touched_capacity;
+    int run;
+
+    TypeStats stats;
+};
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int n = *capacity ? *capacity : 16;
+    while (n < needed) n *= 2;
+    data = realloc(data, size * n);
+    if (!data) {
+        perror("Failed to grow Typer");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = n;
+    return data;
+}
+
+Typer* typer_new(Arena* arena) {
+    Typer* t = calloc(1, sizeof(Typer));
+    if (!t) {
+        perror("Failed to allocate Typer");
+        exit(EXIT_FAILURE);
+    }
+    t->arena = arena;
+    t->function = -1;
+    t->run = 1;
+    return t;
+}
+
+void typer_free(Typer* t) {
+    if (!t) return;
+    free(t->parent);
+    free(t->bound);
+    free(t->stack);
+    free(t->main_slots);
+    free(t->fn_slots);
+    free(t->signature_of);
+    free(t->signatures);
+    free(t->terms);
+    free(t->sites);
+    free(t->touched);
+    free(t->main_touched);
+    free(t);
+}
+
+const TypeStats* typer_stats(const Typer* t) {
+    return &t->stats;
+}
+
+static const char* type_name(ValueType type) {
+    switch (type) {
+        case TYPE_BOOL: return "bool";
+        case TYPE_STRING: return "string";
+        default: return "int";
+    }
+}
+
+static void error_at(Typer* t, const ASTNode* node, const char* fmt, const char* a, const char* b) {
+    fprintf(stderr, "\n[Erro] Linha %d, Coluna %d: ", node->line, node->column);
+    fprintf(stderr, fmt, a, b);
+    fprintf(stderr, "\n");
+    t->stats.errors++;
+}
+
+static int new_var(Typer* t) {
+    int capacity = t->var_capacity;
+    t->parent = grow(t->parent, &capacity, t->var_count + 1, sizeof(int));
+    capacity = t->var_capacity;
+    t->bound = grow(t->bound, &capacity, t->var_count + 1, 1);
+    t->var_capacity = capacity;
+    t->parent[t->var_count] = t->var_count;
+    t->bound[t->var_count] = 0;
+    return TERM_VAR + t->var_count++;
+}
+
+static int find(Typer* t, int v) {
+    while (t->parent[v] != v) {
+        t->parent[v] = t->parent[t->parent[v]];
+        v = t->parent[v];
+    }
+    return v;
+}
+
+// ValueType + 1 do termo, 0 se é uma variável livre.
+static int bound_of(Typer* t, int term) {
+    if (term == TERM_DEFAULT) return TYPE_INT + 1;
+    if (term < TERM_VAR) return term + 1;
+    return t->bound[find(t, term - TERM_VAR)];
+}
+
+// Junção de dois bounds: -1 se string encontra número.
+static int join(int a, int b) {
+    if (!a || a == b) return b;
+    if (!b) return a;
+    if (a == TYPE_STRING + 1 || b == TYPE_STRING + 1) return -1;
+    return TYPE_INT + 1;
+}
+
+static void unify(Typer* t, int a, int b, const ASTNode* node) {
+    int ba = bound_of(t, a), bb = bound_of(t, b);
+    int joined = join(ba, bb);
+    if (joined < 0) {
+        if (a == TERM_DEFAULT || b == TERM_DEFAULT) {
+            // Só acontece entre execuções: modos streaming e compacto.
+            error_at(t, node, "Tipos incompatíveis: %s e %s (nada na declaração da função restringe "
+                     "o tipo, que ficou int; nos modos --stream e --compact ele não vem de "
+                     "chamadas posteriores)", type_name(ba - 1), type_name(bb - 1));
+        } else {
+            error_at(t, node, "Tipos incompatíveis: %s e %s", type_name(ba - 1), type_name(bb - 1));
+        }
+        return;
+    }
+    int ra = a >= TERM_VAR ? find(t, a - TERM_VAR) : -1;
+    int rb = b >= TERM_VAR ? find(t, b - TERM_VAR) : -1;
+    if (ra >= 0 && rb >= 0 && ra != rb) t->parent[rb] = ra;
+    if (ra >= 0) t->bound[ra] = (unsigned char)joined;
+    else if (rb >= 0) t->bound[rb] = (unsigned char)joined;
+}
+
+// O termo precisa ser um número; livre, vira int.
+static void require_number(Typer* t, int term, const ASTNode* node, const char* fmt, const char* what) {
+    int b = bound_of(t, term);
+    if (b == TYPE_STRING + 1) {
+        error_at(t, node, fmt, what, NULL);
+    } else if (!b) {
+        t->bound[find(t, term - TERM_VAR)] = TYPE_INT + 1;
+    }
+}
+
+// Fixa o tipo do termo: uma variável livre vira int.
+static ValueType resolve(Typer* t, int term) {
+    if (term == TERM_OPEN || term == TERM_DEFAULT) return TYPE_INT;
+    if (term < TERM_VAR) return (ValueType)term;
+    int root = find(t, term - TERM_VAR);
+    if (!t->bound[root]) t->bound[root] = TYPE_INT + 1;
+    return (ValueType)(t->bound[root] - 1);
+}
+
+static void push(Typer* t, int term) {
+    t->stack = grow(t->stack, &t->stack_capacity, t->stack_count + 1, sizeof(int));
+    t->stack[t->stack_count++] = term;
+}
+
+// Um nó filho sem valor na pilha (erro de parse, por exemplo) vale int.
+static int pop(Typer* t) {
+    return t->stack_count > 0 ? t->stack[--t->stack_count] : TYPE_INT;
+}
+
+static void add_site(Typer* t, ASTNode* node, int term) {
+    t->sites = grow(t->sites, &t->site_capacity, t->site_count + 1, sizeof(Site));
+    t->sites[t->site_count].node = node;
+    t->sites[t->site_count++].term = term;
+}
+
+static int* slot_ref(Typer* t, int slot) {
+    if (t->function >= 0) {
+        int old = t->fn_capacity;
+        t->fn_slots = grow(t->fn_slots, &t->fn_capacity, slot + 1, sizeof(int));
+        for (int i = old; i < t->fn_capacity; i++) t->fn_slots[i] = TERM_OPEN;
+        return &t->fn_slots[slot];
+    }
+    int old = t->main_capacity;
+    t->main_slots = grow(t->main_slots, &t->main_capacity, slot + 1, sizeof(int));
+    for (int i = old; i < t->main_capacity; i++) t->main_slots[i] = TERM_OPEN;
+    return &t->main_slots[slot];
+}
+
+// Termo de uma variável já declarada; sem slot (erro do resolvedor), um
+// termo livre qualquer.
+static int slot_term(Typer* t, int slot) {
+    if (slot < 0) return new_var(t);
+    int* ref = slot_ref(t, slot);
+    if (*ref == TERM_OPEN) *ref = new_var(t);
+    return *ref;
+}
+
+static void touch(Typer* t, int index) {
+    Signature* s = &t->signatures[index];
+    if (s->stamp == t->run) return;
+    s->stamp = t->run;
+    t->touched = grow(t->touched, &t->touched_capacity, t->touched_count + 1, sizeof(int));
+    t->touched[t->touched_count++] = index;
+}
+
+static int new_signature(Typer* t, int name, int param_count) {
+    if (name >= t->name_capacity) {
+        int old = t->name_capacity;
+        t->signature_of = grow(t->signature_of, &t->name_capacity, name + 1, sizeof(int));
+        for (int i = old; i < t->name_capacity; i++) t->signature_of[i] = -1;
+    }
+    t->signatures = grow(t->signatures, &t->signature_capacity, t->signature_count + 1, sizeof(Signature));
+    t->terms = grow(t->terms, &t->term_capacity, t->term_count + param_count, sizeof(int));
+    int index = t->signature_count++;
+    Signature* s = &t->signatures[index];
+    s->params = t->term_count;
+    s->param_count = param_count;
+    s->result = TERM_OPEN;
+    s->stamp = 0;
+    for (int i = 0; i < param_count; i++) t->terms[t->term_count++] = new_var(t);
+    t->signature_of[name] = index;
+    touch(t, index);
+    return index;
+}
+
+static int signature_of(Typer* t, int name) {
+    return name >= 0 && name < t->name_capacity ? t->signature_of[name] : -1;
+}
+
+static int result_term(Typer* t, int index) {
+    Signature* s = &t->signatures[index];
+    touch(t, index);
+    if (s->result == TERM_OPEN) s->result = new_var(t);
+    return s->result;
+}
+
+static void call(Typer* t, ASTNode* node) {
+    ASTCallExpr* c = (ASTCallExpr*)node;
+    int n = c->arg_count < t->stack_count ? c->arg_count : t->stack_count;
+    int* args = t->stack + t->stack_count - n;
+    int index = signature_of(t, c->name);
+    if (index < 0) index = new_signature(t, c->name, n);
+    touch(t, index);
+    Signature* s = &t->signatures[index];
+    for (int i = 0; i < n && i < s->param_count; i++) {
+        unify(t, t->terms[s->params + i], args[i], c->args[i]);
+    }
+    t->stack_count -= n;
+    if (node->type == AST_CALL_EXPR) {
+        int result = result_term(t, index);
+        add_site(t, node, result);
+        push(t, result);
+    }
+}
+
+static void declare(Typer* t, ASTFnDecl* fn) {
+    int index = signature_of(t, fn->name);
+    if (index < 0 || t->signatures[index].param_count != fn->param_count) {
+        index = new_signature(t, fn->name, fn->param_count);
+    }
+    touch(t, index);
+    t->function = index;
+    for (int i = 0; i < fn->param_count; i++) {
+        *slot_ref(t, i) = t->terms[t->signatures[index].params + i];
+    }
+    add_site(t, (ASTNode*)fn, index);
+}
+
+static const char* op_text(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "+";
+        case TOKEN_MINUS: return "-";
+        case TOKEN_STAR: return "*";
+        case TOKEN_SLASH: return "/";
+        case TOKEN_PERCENT: return "%";
+        case TOKEN_AND_AND: return "&&";
+        case TOKEN_OR_OR: return "||";
+        case TOKEN_BANG: return "!";
+        case TOKEN_PLUS_EQ: return "+=";
+        case TOKEN_MINUS_EQ: return "-=";
+        default: return "?";
+    }
+}
+
+static void binary(Typer* t, ASTBinaryExpr* node) {
+    int right = pop(t);
+    int left = pop(t);
+    const char* fmt = "Operador '%s' não se aplica a string";
+    switch (node->operator) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_STAR:
+        case TOKEN_SLASH:
+        case TOKEN_PERCENT:
+            require_number(t, left, (ASTNode*)node, fmt, op_text(node->operator));
+            require_number(t, right, (ASTNode*)node, fmt, op_text(node->operator));
+            push(t, TYPE_INT);
+            break;
+        case TOKEN_AND_AND:
+        case TOKEN_OR_OR:
+            require_number(t, left, (ASTNode*)node, fmt, op_text(node->operator));
+            require_number(t, right, (ASTNode*)node, fmt, op_text(node->operator));
+            push(t, TYPE_BOOL);
+            break;
+        default:
+            // Comparações: os dois lados têm o mesmo tipo, que decide como
+            // comparar no C.
+            unify(t, left, right, (ASTNode*)node);
+            add_site(t, (ASTNode*)node, left);
+            push(t, TYPE_BOOL);
+            break;
+    }
+}
+
+static void enter(ASTNode* node, void* state) {
+    if (node->type == AST_FN_DECL) declare(state, (ASTFnDecl*)node);
+}
+
+static ASTNode* leave(ASTNode* node, void* state) {
+    Typer* t = state;
+    const char* condition = "Condição do tipo string";
+    switch (node->type) {
+        case AST_INT_LITERAL:
+            push(t, TYPE_INT);
+            break;
+        case AST_BOOL_LITERAL:
+            push(t, TYPE_BOOL);
+            break;
+        case AST_STRING_LITERAL:
+            push(t, TYPE_STRING);
+            break;
+        case AST_IDENTIFIER:
+            push(t, slot_term(t, ((ASTIdentifier*)node)->slot));
+            break;
+        case AST_UNARY_EXPR: {
+            ASTUnaryExpr* n = (ASTUnaryExpr*)node;
+            require_number(t, pop(t), node, "Operador '%s' não se aplica a string", op_text(n->operator));
+            push(t, n->operator == TOKEN_BANG ? TYPE_BOOL : TYPE_INT);
+            break;
+        }
+        case AST_BINARY_EXPR:
+            binary(t, (ASTBinaryExpr*)node);
+            break;
+        case AST_CALL_EXPR:
+        case AST_CALL_STMT:
+            call(t, node);
+            break;
+        case AST_INPUT_EXPR:
+            if (((ASTPrintStmt*)node)->expression) add_site(t, node, pop(t));
+            push(t, TYPE_INT);
+            break;
+        case AST_ISNUMBER_EXPR:
+        case AST_ISSTRING_EXPR:
+            add_site(t, node, pop(t));
+            push(t, TYPE_BOOL);
+            break;
+        case AST_ABS_EXPR:
+            require_number(t, pop(t), node, "%s espera um número, não string", "abs");
+            push(t, TYPE_INT);
+            break;
+        case AST_EXIT_STMT:
+            require_number(t, pop(t), node, "%s espera um número, não string", "exit");
+            push(t, TYPE_INT);
+            break;
+        case AST_PRINT_STMT:
+            add_site(t, node, pop(t));
+            break;
+        case AST_VAR_DECL: {
+            ASTVarDecl* n = (ASTVarDecl*)node;
+            int var = new_var(t);
+            if (n->initializer) unify(t, var, pop(t), node);
+            if (n->slot >= 0) {
+                *slot_ref(t, n->slot) = var;
+                if (t->function < 0) {
+                    t->main_touched = grow(t->main_touched, &t->main_touched_capacity,
+                                           t->main_touched_count + 1, sizeof(int));
+                    t->main_touched[t->main_touched_count++] = n->slot;
+                }
+            }
+            add_site(t, node, var);
+            break;
+        }
+        case AST_ASSIGN_STMT: {
+            ASTAssignStmt* n = (ASTAssignStmt*)node;
+            int value = pop(t);
+            int var = slot_term(t, n->slot);
+            if (n->op_type == TOKEN_EQUALS) {
+                unify(t, var, value, node);
+            } else {
+                require_number(t, var, node, "Operador '%s' não se aplica a string", op_text(n->op_type));
+                require_number(t, value, node, "Operador '%s' não se aplica a string", op_text(n->op_type));
+            }
+            break;
+        }
+        case AST_RETURN_STMT:
+            if (!((ASTReturnStmt*)node)->expression) break;
+            if (t->function >= 0) unify(t, result_term(t, t->function), pop(t), node);
+            else pop(t);
+            break;
+        case AST_IF_STMT:
+            require_number(t, pop(t), ((ASTIfStmt*)node)->condition, condition, NULL);
+            break;
+        case AST_WHILE_STMT:
+            require_number(t, pop(t), ((ASTWhileStmt*)node)->condition, condition, NULL);
+            break;
+        case AST_FOR_STMT:
+            if (((ASTForStmt*)node)->condition) {
+                require_number(t, pop(t), ((ASTForStmt*)node)->condition, condition, NULL);
+            }
+            break;
+        case AST_FN_DECL:
+            t->function = -1;
+            break;
+        default:
+            break;
+    }
+    return node;
+}
+
+// Termo que sobrevive à execução: o tipo fixo, ou TERM_DEFAULT se nada o
+// restringiu.
+static int settle(Typer* t, int term) {
+    if (term >= TERM_VAR && !bound_of(t, term)) {
+        resolve(t, term);
+        return TERM_DEFAULT;
+    }
+    return resolve(t, term);
+}
+
+static void count(Typer* t, ValueType type) {
+    if (type == TYPE_STRING) t->stats.strings++;
+    else if (type == TYPE_BOOL) t->stats.bools++;
+    else t->stats.ints++;
+}
+
+// Fixa os tipos da execução: anota os nós, troca os termos que sobrevivem
+// a ela (slots do main, assinaturas) pelos tipos e descarta as variáveis.
+static void end(void* state) {
+    Typer* t = state;
+    // Assinaturas primeiro: settle precisa ver o que ficou livre.
+    for (int i = 0; i < t->touched_count; i++) {
+        Signature* s = &t->signatures[t->touched[i]];
+        for (int p = 0; p < s->param_count; p++) {
+            t->terms[s->params + p] = settle(t, t->terms[s->params + p]);
+        }
+        if (s->result != TERM_OPEN) s->result = settle(t, s->result);
+    }
+    for (int i = 0; i < t->site_count; i++) {
+        ASTNode* node = t->sites[i].node;
+        int term = t->sites[i].term;
+        switch (node->type) {
+            case AST_VAR_DECL:
+                ((ASTVarDecl*)node)->value_type = resolve(t, term);
+                count(t, ((ASTVarDecl*)node)->value_type);
+                break;
+            case AST_FN_DECL: {
+                ASTFnDecl* fn = (ASTFnDecl*)node;
+                Signature* s = &t->signatures[term];
+                if (fn->param_count > 0 && s->param_count == fn->param_count) {
+                    fn->param_types = arena_alloc(t->arena, sizeof(ValueType) * fn->param_count);
+                    for (int p = 0; p < fn->param_count; p++) {
+                        fn->param_types[p] = resolve(t, t->terms[s->params + p]);
+                        count(t, fn->param_types[p]);
+                    }
+                }
+                fn->return_type = resolve(t, s->result);
+                break;
+            }
+            case AST_PRINT_STMT:
+            case AST_INPUT_EXPR:
+            case AST_ISNUMBER_EXPR:
+            case AST_ISSTRING_EXPR:
+                ((ASTPrintStmt*)node)->value_type = resolve(t, term);
+                break;
+            case AST_BINARY_EXPR:
+                ((ASTBinaryExpr*)node)->operand_type = resolve(t, term);
+                break;
+            case AST_CALL_EXPR:
+                ((ASTCallExpr*)node)->value_type = resolve(t, term);
+                break;
+            default:
+                // Reescrito no lugar por um passe seguinte (dobrado, por
+                // exemplo): não há o que anotar.
+                break;
+        }
+    }
+    for (int i = 0; i < t->main_touched_count; i++) {
+        int* ref = &t->main_slots[t->main_touched[i]];
+        if (*ref != TERM_OPEN) *ref = resolve(t, *ref);
+    }
+    t->var_count = 0;
+    t->stack_count = 0;
+    t->site_count = 0;
+    t->touched_count = 0;
+    t->main_touched_count = 0;
+    t->function = -1;
+    t->run++;
+}
+
+Pass typer_pass(Typer* t) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.name = "types";
+    pass.state = t;
+    pass.enter = enter;
+    pass.leave = leave;
+    pass.end = end;
+    return pass;
+}
@@ -0,0 +1,51 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include "ast.h"
+#include "arena.h"
+#include "pass.h"
+
+// Inferência de tipos: int, bool e string, mais a assinatura de cada
+// função.
+//
+// Cada variável, parâmetro e retorno de função tem uma variável de tipo;
+// as operações geram restrições resolvidas por unificação (union-find):
+// let e = igualam a variável ao valor, argumentos aos parâmetros, return ao
+// retorno da função, comparações igualam os dois lados. Aritmética, abs,
+// exit, condições e operadores lógicos pedem um número; bool conta como
+// número e, unido a int, vira int (os dois são int no C gerado). String
+// onde se pede número, ou unida a int/bool, é erro. O que nada restringe
+// fica int.
+//
+// Os tipos são fixados no fim de cada execução do passe (end): no programa
+// inteiro, parâmetros podem ser inferidos das chamadas em qualquer ponto
+// do arquivo; nos modos streaming e compacto, que rodam uma declaração por
+// vez, uma declaração só enxerga o que veio antes dela, e um uso posterior
+// que contradiga um tipo já fixado é erro. Um parâmetro que a declaração
+// da função não restringe fica int no fim dela; a mensagem de uma chamada
+// posterior com string explica que o tipo não vem dela nesses modos.
+//
+// Depende dos slots do resolvedor (resolve.h), então o passe deve ser
+// registrado depois dele; passes registrados depois deste que precisem dos
+// tipos devem lê-los no end. Anotações (ast.h):
+//   ASTVarDecl                 value_type
+//   ASTFnDecl                  param_types (alocado em arena), return_type
+//   print, input, isnumber,    value_type do operando
+//   isstring
+//   ASTBinaryExpr              operand_type, nas comparações
+//   ASTCallExpr                value_type, o tipo do resultado
+typedef struct {
+    int ints;           // lets e parâmetros de cada tipo
+    int bools;
+    int strings;
+    int errors;
+} TypeStats;
+
+typedef struct Typer Typer;
+
+Typer* typer_new(Arena* arena);
+void typer_free(Typer* t);
+Pass typer_pass(Typer* t);
+const TypeStats* typer_stats(const Typer* t);
+
+#endif